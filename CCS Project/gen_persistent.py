@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+gen_persistent.py - Generate everything that knows the persistent_data_t layout from persistent_schema.json
+
+    python3 gen_persistent.py           # Rewrite the generated files
+    python3 gen_persistent.py --check   # Just check that they are up to date (exit 1 if not)
+
+Generates...
+
+  CCS Project/persistent.h              The structs for the C code, with static_asserts that the compiler agrees with the offsets
+  CCS Project/persistent_offsets.h      Just #defines, so the ASM can .cdecls it and address the fields directly
+  programming/persistent_layout.py      ctypes structures to overlay on a dump, for the Python tools
+  programming/persistent_layout.hpp     The same as packed structs for host C++ tools
+
+Everything is packed and little endian, like the MSP430 sees it.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.dirname(HERE)
+SCHEMA_PATH = os.path.join(HERE, "persistent_schema.json")
+
+GENERATED = "GENERATED FROM persistent_schema.json BY gen_persistent.py. DO NOT EDIT."
+
+# type: (size, firmware C type, host C++ type, ctypes type)
+SCALARS = {
+    "u8":  (1, "unsigned char", "uint8_t",  "ctypes.c_uint8"),
+    "u16": (2, "unsigned",      "uint16_t", "ctypes.c_uint16"),
+    "u32": (4, "unsigned long", "uint32_t", "ctypes.c_uint32"),
+}
+
+
+class Layout:
+    """The schema with every offset worked out."""
+
+    def __init__(self, schema):
+        self.schema = schema
+        self.base_address = int(schema["base_address"], 0)
+        self.size_limit = int(schema["size_limit"], 0)
+        self.structs = {}
+        for s in schema["structs"]:
+            offset = 0
+            for f in s["fields"]:
+                f["offset"] = offset
+                f["element_size"] = self.size_of(f["type"])
+                f["size"] = f["element_size"] * f.get("count", 1)
+                offset += f["size"]
+            s["size"] = offset
+            self.structs[s["name"]] = s
+        self.top = schema["structs"][-1]
+        if self.top["size"] > self.size_limit:
+            raise ValueError("%s is %d bytes, more than the %d in the info FRAM" % (self.top["name"], self.top["size"], self.size_limit))
+        # The _TOGGLE defines XOR offsets, which is only the same as XORing addresses if the base never carries
+        if self.base_address % (1 << self.top["size"].bit_length()):
+            raise ValueError("base_address is not aligned past the size of %s" % self.top["name"])
+
+    def size_of(self, type_name):
+        if type_name in SCALARS:
+            return SCALARS[type_name][0]
+        return self.structs[type_name]["size"]
+
+    def defines(self):
+        """[(name, value, comment)] for persistent_offsets.h and the Python module. None is a blank line or a heading."""
+        out = [("PERSISTENT_BASE_ADDRESS", "0x%04X" % self.base_address, "Where the linker puts persistent_data (PERSISTANT in lnk_msp430fr4133.cmd)"), None]
+        for s in self.schema["structs"]:
+            if "prefix" not in s:
+                continue
+            p = s["prefix"]
+            out.append(("#", s["name"], None))
+            out.append(("%s_SIZE" % (p if p != "PERSISTENT" else "PERSISTENT_DATA"), str(s["size"]), None))
+            for f in s["fields"]:
+                name = "%s_%s" % (p, f["name"].upper())
+                out.append((name + "_OFFSET", str(f["offset"]), None))
+                if "count" in f:
+                    out.append((name + "_COUNT", str(f["count"]), None))
+                    if f["count"] == 2:
+                        out.append((name + "_TOGGLE", str(f["offset"] ^ (f["offset"] + f["element_size"])),
+                                    "XOR into the address of one of the %s to get the other" % f["name"]))
+            out.append(None)
+        for name, c in self.schema["constants"].items():
+            out.append((name, c["value"], c.get("doc")))
+        return out
+
+    def flat_fields(self, struct=None, prefix="", offset=0):
+        """[(dotted name, offset, size)] for every scalar and time block in the top struct."""
+        s = struct or self.top
+        out = []
+        for f in s["fields"]:
+            for i in range(f.get("count", 1)):
+                name = prefix + f["name"] + ("[%d]" % i if "count" in f else "")
+                off = offset + f["offset"] + i * f["element_size"]
+                sub = self.structs.get(f["type"])
+                if sub is not None and "header" not in sub:
+                    out += self.flat_fields(sub, name + ".", off)
+                else:
+                    out.append((name, off, f["element_size"]))
+        return out
+
+
+# ** persistent.h
+
+def _comment_block(lines, indent=""):
+    return "".join("%s// %s\n" % (indent, l) for l in lines)
+
+
+def gen_persistent_h(layout):
+    out = ["/*\n * persistent.h\n *\n * %s\n *\n" % GENERATED]
+    out += [" * %s\n" % l for l in layout.schema["doc"]]
+    out.append(" */\n\n#ifndef PERSISTENT_H_\n#define PERSISTENT_H_\n\n#include <stddef.h>\n\n")
+    for s in layout.schema["structs"]:
+        if "header" in s:
+            out.append('#include "%s"\n' % s["header"])
+    out.append('#include "persistent_offsets.h"\n\n')
+
+    for s in layout.schema["structs"]:
+        if "header" in s:
+            continue
+        out.append(_comment_block(s["doc"]))
+        out.append("\nstruct __attribute__((__packed__)) %s {\n" % s["name"])
+        for f in s["fields"]:
+            if "group" in f:
+                out.append("\n" + _comment_block(f["group"], "    "))
+            ctype = SCALARS[f["type"]][1] if f["type"] in SCALARS else f["type"]
+            decl = "    %s%s %s%s;" % ("volatile " if f.get("volatile") else "", ctype, f["name"], "[%d]" % f["count"] if "count" in f else "")
+            out.append(("%-44s// %s\n" % (decl, f["doc"])) if "doc" in f else decl + "\n")
+        out.append("};\n\n")
+
+    out.append("// Check that the compiler laid things out where persistent_offsets.h (and so the ASM) thinks they are.\n\n")
+    for s in layout.schema["structs"]:
+        if "header" in s:
+            out.append('static_assert( sizeof( %s ) == %d , "%s in %s does not match persistent_schema.json" );\n' % (s["name"], s["size"], s["name"], s["header"]))
+            continue
+        p = s["prefix"]
+        out.append('static_assert( sizeof( %s ) == %s_SIZE , "persistent.h does not match persistent_offsets.h" );\n' % (s["name"], p if p != "PERSISTENT" else "PERSISTENT_DATA"))
+        for f in s["fields"]:
+            out.append('static_assert( offsetof( %s , %s ) == %s_%s_OFFSET , "persistent.h does not match persistent_offsets.h" );\n' % (s["name"], f["name"], p, f["name"].upper()))
+    out.append("\n// Tell compiler/linker to put this in \"info memory\" that we set up in the linker file to live at 0x%04X\n" % layout.base_address)
+    out.append("// This area of memory never gets overwritten, not by power cycle and not by downloading a new binary image into program FRAM.\n\n")
+    out.append("extern %s persistent_data;\n\n\n#endif /* PERSISTENT_H_ */\n" % layout.top["name"])
+    return "".join(out)
+
+
+def gen_offsets_h(layout):
+    out = ["/*\n * persistent_offsets.h\n *\n * %s\n *\n" % GENERATED,
+           " * Byte offsets of the persistent_data_t fields. The ASM .cdecls this to get at the fields as `persistent_data+OFFSET`, since\n"
+           " * the assembler can not see into structs. Only #defines in here so that the assembler can take it.\n */\n\n"
+           "#ifndef PERSISTENT_OFFSETS_H_\n#define PERSISTENT_OFFSETS_H_\n\n"]
+    for d in layout.defines():
+        if d is None:
+            out.append("\n")
+        elif d[0] == "#":
+            out.append("// %s\n" % d[1])
+        else:
+            line = "#define %-40s %s" % (d[0], d[1])
+            out.append(("%-56s// %s\n" % (line, d[2])) if d[2] else line + "\n")
+    out.append("\n#endif /* PERSISTENT_OFFSETS_H_ */\n")
+    return "".join(out)
+
+
+# ** Host decoders
+
+def _class_name(struct_name):
+    return "".join(w.capitalize() for w in struct_name[:-2].split("_"))
+
+
+def gen_python(layout):
+    out = ['"""\npersistent_layout.py - persistent_data_t as ctypes structures\n\n%s\n\n' % GENERATED,
+           "Overlay these on a raw image of the info FRAM (starting at BASE_ADDRESS) to get at the fields in place, with no unpacking...\n\n"
+           "    data = PersistentData.from_buffer(image)            # bytearray or mmap. Reads and writes go straight to the image.\n"
+           "    data = PersistentData.from_buffer_copy(raw)         # Read only bytes\n"
+           "    data.counter_slots[1].days\n\n"
+           "For a whole file of back to back images, `(PersistentData * n).from_buffer(image)` maps them all at once.\n"
+           "`FIELDS` has the offset and size of every field by its C name, like FIELDS[\"counter_slots[1].days\"].\n"
+           '"""\n\nimport ctypes\n\n']
+    for d in layout.defines():
+        if d is None:
+            out.append("\n")
+        elif d[0] == "#":
+            out.append("# %s\n" % d[1])
+        else:
+            out.append(("%-56s# %s\n" % ("%s = %s" % (d[0], d[1]), d[2])) if d[2] else "%s = %s\n" % (d[0], d[1]))
+    out.append("BASE_ADDRESS = PERSISTENT_BASE_ADDRESS\nSIZE = PERSISTENT_DATA_SIZE\n\n")
+    for s in layout.schema["structs"]:
+        out.append("\nclass %s(ctypes.LittleEndianStructure):\n    \"\"\"%s\"\"\"\n    _pack_ = 1\n    _fields_ = [\n" % (_class_name(s["name"]), s["name"]))
+        for f in s["fields"]:
+            t = SCALARS[f["type"]][3] if f["type"] in SCALARS else _class_name(f["type"])
+            if "count" in f:
+                t = "%s * %d" % (t, f["count"])
+            out.append("        (%r, %s),\n" % (f["name"], t))
+        out.append("    ]\n\n")
+    out.append("\nassert ctypes.sizeof(%s) == SIZE\n\n" % _class_name(layout.top["name"]))
+    out.append("FIELDS = {\n")
+    for name, off, size in layout.flat_fields():
+        out.append("    %-28s (%d, %d),\n" % ("%r:" % name, off, size))
+    out.append("}\n")
+    return "".join(out)
+
+
+def gen_hpp(layout):
+    out = ["// persistent_layout.hpp - persistent_data_t for host C++ tools\n//\n// %s\n//\n" % GENERATED,
+           "// The structs are packed and the MSP430 is little endian, so on a little endian host a dump of the info FRAM *is* a\n"
+           "// persistent_data_t. `view()` just points at it, so decoding a dump does not copy or unpack anything.\n\n"
+           "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n"
+           "#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__\n#error \"persistent_layout.hpp overlays little endian dumps\"\n#endif\n\n"
+           "namespace persistent_layout {\n\n"]
+    for d in layout.defines():
+        if d is None:
+            out.append("\n")
+        elif d[0] == "#":
+            out.append("// %s\n" % d[1])
+        else:
+            out.append("constexpr uint32_t %s = %s;\n" % (d[0], d[1]))
+    out.append("\n#pragma pack(push, 1)\n\n")
+    for s in layout.schema["structs"]:
+        out.append("struct %s {\n" % s["name"])
+        for f in s["fields"]:
+            t = SCALARS[f["type"]][2] if f["type"] in SCALARS else f["type"]
+            out.append("    %s %s%s;\n" % (t, f["name"], "[%d]" % f["count"] if "count" in f else ""))
+        out.append("};\n\n")
+    out.append("#pragma pack(pop)\n\n")
+    for s in layout.schema["structs"]:
+        out.append("static_assert( sizeof( %s ) == %d , \"layout\" );\n" % (s["name"], s["size"]))
+        for f in s["fields"]:
+            out.append("static_assert( offsetof( %s , %s ) == %d , \"layout\" );\n" % (s["name"], f["name"], f["offset"]))
+    out.append("\ninline const %s *view( const void *image ) {\n    return static_cast<const %s *>( image );\n}\n\n" % (layout.top["name"], layout.top["name"]))
+    out.append("}  // namespace persistent_layout\n")
+    return "".join(out)
+
+
+OUTPUTS = (
+    (os.path.join(HERE, "persistent.h"), gen_persistent_h),
+    (os.path.join(HERE, "persistent_offsets.h"), gen_offsets_h),
+    (os.path.join(REPO, "programming", "persistent_layout.py"), gen_python),
+    (os.path.join(REPO, "programming", "persistent_layout.hpp"), gen_hpp),
+)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--check", action="store_true", help="do not write anything, exit 1 if a generated file is out of date")
+    args = ap.parse_args()
+
+    with open(SCHEMA_PATH) as f:
+        layout = Layout(json.load(f))
+
+    stale = []
+    for path, gen in OUTPUTS:
+        text = gen(layout)
+        try:
+            with open(path, newline="") as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current == text:
+            continue
+        stale.append(os.path.relpath(path, REPO))
+        if not args.check:
+            with open(path, "w", newline="") as f:
+                f.write(text)
+
+    if args.check and stale:
+        print("out of date (run gen_persistent.py): %s" % ", ".join(stale), file=sys.stderr)
+        sys.exit(1)
+    for path in stale:
+        print("wrote %s" % path)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,403 @@
+;
+; i2c_asm.asm
+;
+; The bit-banged I2C master we use to talk to the RV3032. Replaces the C version in i2c_master.cpp, which did a
+; read-modify-write on P1DIR and P1OUT for every edge and then waited BIT_TIME_US after each one whether the bus needed it or not.
+;
+; Every byte is unrolled and hand scheduled, so each edge happens a known number of cycles after the one before it.
+; The few places where the RV3032 needs more time than the instructions take get NOPs, and the number of NOPs is worked
+; out below from the minimums in i2c_asm.h and I2C_MCLK_HZ. At ~1MHz there are none.
+;
+; SCL and SDA are both on P1, so we keep an image of P1OUT with SCL and SDA low in R10 and make every SCL edge and
+; every SDA bit a single MOV.B of a precomputed image (R10 plus whichever of SCL and SDA should be high) into P1OUT.
+; That is one write per edge with no read first, and it leaves the other P1 pins alone. It does assume that nothing else
+; changes P1OUT while a transfer is running, which is true since no ISR that can run during a transfer touches P1OUT.
+;
+; SCL is always driven (the RV3032 never stretches the clock). SDA is driven while we are sending, and otherwise left as
+; an input with the pull-up on (DIR=0, REN=1, OUT=1) so the RV3032 can pull it low. That is the same wiring i2c_init() sets up.
+;
+; sim/i2c_bus.py runs this against a model of the RV3032 and checks every edge against the timing in i2c_asm.h.
+;
+
+			.cdecls C,LIST,"msp430.h"		; Include device header file
+			.cdecls C,LIST,"pins.h"			; Where SCL and SDA are
+			.cdecls C,LIST,"i2c_asm.h"		; The bus timing we have to meet
+
+			.text
+
+I2C_SCL		.set	(1<<I2C_CLK_B)
+I2C_SDA		.set	(1<<I2C_DTA_B)
+
+; *** Timing
+;
+; Each time is turned into whole cycles at I2C_MCLK_HZ, rounded up. Then each pad is however many cycles the minimum
+; needs beyond what the instructions in that spot already take. The "base" counts below are from the edge that starts
+; the time (the end of the MOV or BIS that made it) to the edge that ends it, and are the smallest they can be, so
+; the real times are never shorter.
+
+I2C_CYC_NS		.set	1000000000/I2C_MCLK_HZ					; Rounded down, so everything worked out from it comes out long
+
+I2C_C_LOW		.set	(I2C_T_LOW_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_HIGH		.set	(I2C_T_HIGH_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_SU_STA	.set	(I2C_T_SU_STA_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_HD_STA	.set	(I2C_T_HD_STA_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_SU_STO	.set	(I2C_T_SU_STO_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_BUF		.set	(I2C_T_BUF_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_SU_DAT	.set	(I2C_T_SU_DAT_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_VD		.set	(I2C_T_VD_DAT_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_RISE		.set	(I2C_T_RISE_NS+I2C_CYC_NS-1)/I2C_CYC_NS
+I2C_C_VD_RISE	.set	(I2C_T_VD_DAT_NS+I2C_T_RISE_NS+I2C_CYC_NS-1)/I2C_CYC_NS					; Until a bit the RV3032 let go of has risen
+I2C_C_NACK		.set	(I2C_T_VD_DAT_NS+I2C_T_RISE_NS+I2C_T_SU_DAT_NS+I2C_CYC_NS-1)/I2C_CYC_NS	; ...and then been there long enough for it to see
+I2C_C_PERIOD	.set	(I2C_MCLK_HZ+I2C_BUS_HZ-1)/I2C_BUS_HZ	; Shortest SCL rise to rise
+
+; Pads are max(0, need-base). Where there is more than one need, each gets worked out and we take the biggest.
+
+; Write bit. Low is 12 cycles from SCL low to SCL high (SDA changes 8 cycles in), high is 3.
+I2C_PAD_W_HIGH	.set	(I2C_C_HIGH>3)*(I2C_C_HIGH-3)
+I2C_W_LOW_A		.set	(I2C_C_LOW>12)*(I2C_C_LOW-12)
+I2C_W_LOW_B		.set	(I2C_C_SU_DAT>4)*(I2C_C_SU_DAT-4)			; SDA change to SCL high
+I2C_W_LOW_C		.set	(I2C_W_LOW_A>I2C_W_LOW_B)*I2C_W_LOW_A+(I2C_W_LOW_A<=I2C_W_LOW_B)*I2C_W_LOW_B
+I2C_PAD_W_LOW	.set	I2C_W_LOW_C+(I2C_C_PERIOD>15+I2C_W_LOW_C+I2C_PAD_W_HIGH)*(I2C_C_PERIOD-15-I2C_W_LOW_C-I2C_PAD_W_HIGH)
+
+; Before we start driving SDA again after the RV3032 had it. It lets go within tVD;DAT of SCL going low and we are
+; at least 4 cycles past that.
+I2C_PAD_TURN	.set	(I2C_C_VD>4)*(I2C_C_VD-4)
+
+; The last bit of a write byte also lets go of SDA after SCL goes high, so it is 7 high.
+I2C_PAD_W_HIGH_LAST	.set	(I2C_C_HIGH>7)*(I2C_C_HIGH-7)
+
+; Slave ACK after a write byte. 9 cycles low with the pull-up on for the last 4, 7 high.
+I2C_A_A			.set	(I2C_C_RISE>4)*(I2C_C_RISE-4)				; A NACK has to rise through the pull-up
+I2C_A_B			.set	(I2C_C_LOW>9)*(I2C_C_LOW-9)
+I2C_A_C			.set	(I2C_C_VD>9)*(I2C_C_VD-9)					; An ACK has to be there
+I2C_A_D			.set	(I2C_C_PERIOD>16)*(I2C_C_PERIOD-16)
+I2C_A_AB		.set	(I2C_A_A>I2C_A_B)*I2C_A_A+(I2C_A_A<=I2C_A_B)*I2C_A_B
+I2C_A_CD		.set	(I2C_A_C>I2C_A_D)*I2C_A_C+(I2C_A_C<=I2C_A_D)*I2C_A_D
+I2C_PAD_A_LOW	.set	(I2C_A_AB>I2C_A_CD)*I2C_A_AB+(I2C_A_AB<=I2C_A_CD)*I2C_A_CD
+I2C_PAD_A_HIGH	.set	(I2C_C_HIGH>7)*(I2C_C_HIGH-7)
+
+; Read bit. Low is 4 cycles, high is 7 and we sample at the start of it.
+I2C_PAD_R_HIGH	.set	(I2C_C_HIGH>7)*(I2C_C_HIGH-7)
+I2C_R_LOW_A		.set	(I2C_C_LOW>4)*(I2C_C_LOW-4)
+I2C_R_LOW_B		.set	(I2C_C_VD_RISE>4)*(I2C_C_VD_RISE-4)
+I2C_R_LOW_C		.set	(I2C_R_LOW_A>I2C_R_LOW_B)*I2C_R_LOW_A+(I2C_R_LOW_A<=I2C_R_LOW_B)*I2C_R_LOW_B
+I2C_PAD_R_LOW	.set	I2C_R_LOW_C+(I2C_C_PERIOD>11+I2C_R_LOW_C+I2C_PAD_R_HIGH)*(I2C_C_PERIOD-11-I2C_R_LOW_C-I2C_PAD_R_HIGH)
+
+; Our ACK after a read byte. 11 cycles low, SDA driven low 4 cycles before SCL goes high. After it we let go of SDA and give
+; the pull-up time to bring it up in case the RV3032 is sending a 1.
+I2C_M_A			.set	(I2C_C_LOW>11)*(I2C_C_LOW-11)
+I2C_M_B			.set	(I2C_C_SU_DAT>4)*(I2C_C_SU_DAT-4)
+I2C_M_C			.set	(I2C_C_PERIOD>18)*(I2C_C_PERIOD-18)
+I2C_M_AB		.set	(I2C_M_A>I2C_M_B)*I2C_M_A+(I2C_M_A<=I2C_M_B)*I2C_M_B
+I2C_PAD_M_LOW	.set	(I2C_M_AB>I2C_M_C)*I2C_M_AB+(I2C_M_AB<=I2C_M_C)*I2C_M_C
+I2C_PAD_M_REL	.set	(I2C_C_RISE>4)*(I2C_C_RISE-4)
+
+; Our NACK after the last read byte. The RV3032 lets go of its last bit and the pull-up brings SDA up, which it has to
+; see before SCL goes high.
+I2C_N_A			.set	(I2C_C_NACK>4)*(I2C_C_NACK-4)
+I2C_N_B			.set	(I2C_C_LOW>4)*(I2C_C_LOW-4)
+I2C_N_C			.set	(I2C_C_PERIOD>11)*(I2C_C_PERIOD-11)
+I2C_N_AB		.set	(I2C_N_A>I2C_N_B)*I2C_N_A+(I2C_N_A<=I2C_N_B)*I2C_N_B
+I2C_PAD_N_LOW	.set	(I2C_N_AB>I2C_N_C)*I2C_N_AB+(I2C_N_AB<=I2C_N_C)*I2C_N_C
+
+; The SCL low before a STOP or a repeated START. 11 cycles low (8 for the repeated START), SDA settled 4 cycles before SCL goes high.
+I2C_P_A			.set	(I2C_C_LOW>11)*(I2C_C_LOW-11)
+I2C_P_B			.set	(I2C_C_SU_DAT>4)*(I2C_C_SU_DAT-4)
+I2C_P_C			.set	(I2C_C_PERIOD>14)*(I2C_C_PERIOD-14)
+I2C_P_AB		.set	(I2C_P_A>I2C_P_B)*I2C_P_A+(I2C_P_A<=I2C_P_B)*I2C_P_B
+I2C_PAD_P_LOW	.set	(I2C_P_AB>I2C_P_C)*I2C_P_AB+(I2C_P_AB<=I2C_P_C)*I2C_P_C
+I2C_S_A			.set	(I2C_C_LOW>8)*(I2C_C_LOW-8)
+I2C_S_AB		.set	(I2C_S_A>I2C_P_B)*I2C_S_A+(I2C_S_A<=I2C_P_B)*I2C_P_B
+I2C_PAD_S_LOW	.set	(I2C_S_AB>I2C_P_C)*I2C_S_AB+(I2C_S_AB<=I2C_P_C)*I2C_P_C
+
+; START and STOP. SDA falls 8 cycles after SCL went high (or after the last STOP, which is much longer ago), and SCL
+; goes low 3 after that. STOP rises 4 after SCL went high.
+I2C_T_A			.set	(I2C_C_SU_STA>8)*(I2C_C_SU_STA-8)
+I2C_T_B			.set	(I2C_C_BUF>8)*(I2C_C_BUF-8)
+I2C_PAD_SU_STA	.set	(I2C_T_A>I2C_T_B)*I2C_T_A+(I2C_T_A<=I2C_T_B)*I2C_T_B
+I2C_PAD_HD_STA	.set	(I2C_C_HD_STA>3)*(I2C_C_HD_STA-3)
+I2C_PAD_SU_STO	.set	(I2C_C_SU_STO>4)*(I2C_C_SU_STO-4)
+
+
+; *** Registers
+;
+; R7  = Count of bytes that did not get an ACK. What we return (as 0 or 1).
+; R8  = I2C_SDA, so we can use it where a #constant would cost an extra word and cycle
+; R9  = The byte going out or coming in
+; R10 = P1OUT as it was when we were called, with SCL and SDA low
+; R11 = What to write to P1OUT to take SCL low while leaving SDA where it is
+;
+; R12-R15 are the C arguments. R6-R10 belong to the caller under the EABI, so we save them.
+
+
+; *** Bus conditions. All of these are CALLed, so 4 cycles in and 4 out, which the base counts above do not include.
+
+; START from idle (SCL high, SDA pulled up). Returns with SCL low and SDA driven low.
+
+I2C_START:
+			BIS.B		R8,&I2C_DTA_PDIR		; Drive SDA high (OUT is already high from the pull-up)
+			.loop		I2C_PAD_SU_STA
+			NOP
+			.endloop
+			BIC.B		R8,&I2C_DTA_POUT		; SDA low while SCL is high is a START
+			.loop		I2C_PAD_HD_STA
+			NOP
+			.endloop
+			MOV.B		R10,&I2C_CLK_POUT		; SCL low
+			MOV.B		R10,R11
+			RET
+
+; Repeated START from after an ACK (SCL low, SDA pulled up). Gets SCL high with SDA high and then does a START.
+
+I2C_RESTART:
+			.loop		I2C_PAD_TURN
+			NOP
+			.endloop
+			BIS.B		R8,&I2C_DTA_PDIR		; Drive SDA high
+			.loop		I2C_PAD_S_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; SCL high
+			JMP			I2C_START
+
+; STOP from after an ACK or NACK (SCL low, SDA pulled up). Leaves the bus idle with SCL high and SDA pulled up.
+
+I2C_STOP:
+			MOV.B		R10,&I2C_CLK_POUT		; SDA pull-down
+			BIS.B		R8,&I2C_DTA_PDIR		; Drive SDA low. If the RV3032 is still holding an ACK low we agree with it.
+			.loop		I2C_PAD_P_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; SCL high
+			.loop		I2C_PAD_SU_STO
+			NOP
+			.endloop
+			BIS.B		R8,&I2C_DTA_POUT		; SDA high while SCL is high is a STOP
+			BIC.B		R8,&I2C_DTA_PDIR		; Let go of SDA so the pull-up holds it high, which is idle
+			RET
+
+
+; *** Bytes
+
+; Send the byte in R9 and get the ACK. Starts with SCL low (after a START or an ACK), returns with SCL low and SDA
+; pulled up. Adds 1 to R7 if the RV3032 did not ACK. 8 bits at 15 cycles each and 16 for the ACK.
+
+I2C_WRITE_BYTE:
+			.loop		I2C_PAD_TURN
+			NOP
+			.endloop
+			BIS.B		R8,&I2C_DTA_PDIR		; Drive SDA. It stays wherever R11 has it until the first bit.
+
+			; Move the byte up so that each bit passes over the SDA bit in the high byte as we shift it left. Then SWPB
+			; brings the current bit down to the SDA bit of the low byte where we can mask it straight into the image.
+			SWPB		R9
+			.loop		7-I2C_DTA_B
+			RRA.W		R9
+			.endloop
+
+			.loop		7
+			MOV.B		R11,&I2C_CLK_POUT		; SCL low (3)
+			MOV.W		R9,R11					; (1)
+			SWPB		R11						; (1) This bit is now at I2C_SDA
+			AND.B		R8,R11					; (1) Just that bit
+			BIS.B		R10,R11					; (1) R11 = P1OUT with SCL low and SDA = this bit
+			RLA.W		R9						; (1) Next bit
+			MOV.B		R11,&I2C_CLK_POUT		; (3) SDA = this bit
+			.loop		I2C_PAD_W_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; (4) SCL high. The RV3032 takes the bit.
+			.loop		I2C_PAD_W_HIGH
+			NOP
+			.endloop
+			.endloop
+
+			; The last bit is the same, except that we let go of SDA while SCL is still high. The pull is the same way
+			; the bit was so SDA does not move, and it means we are never driving SDA high when the RV3032 pulls it
+			; low for the ACK, which it is allowed to do as soon as SCL goes low.
+			MOV.B		R11,&I2C_CLK_POUT		; SCL low
+			MOV.W		R9,R11
+			SWPB		R11
+			AND.B		R8,R11
+			BIS.B		R10,R11
+			RLA.W		R9						; Not needed, but keeps the low the same as the other bits
+			MOV.B		R11,&I2C_CLK_POUT		; SDA = last bit
+			.loop		I2C_PAD_W_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; SCL high
+			BIC.B		R8,&I2C_DTA_PDIR		; Let go of SDA
+			.loop		I2C_PAD_W_HIGH_LAST
+			NOP
+			.endloop
+
+			MOV.B		R11,&I2C_CLK_POUT		; SCL low
+			MOV.B		R10,R11
+			BIS.B		R8,R11					; R11 = SCL low with the pull-up
+			MOV.B		R11,&I2C_CLK_POUT		; Pull-up on (if the last bit was a 0, SDA was on the pull-down until now)
+			.loop		I2C_PAD_A_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; SCL high
+			BIT.B		R8,&I2C_DTA_PIN			; C = SDA, which is high for a NACK
+			ADC.W		R7
+			.loop		I2C_PAD_A_HIGH
+			NOP
+			.endloop
+			MOV.B		R11,&I2C_CLK_POUT		; SCL low. The RV3032 lets go of its ACK.
+			RET
+
+; Read a byte into R9. Starts with SCL low and SDA pulled up (after an ACK), returns the same way. Does not do our
+; ACK or NACK since only the caller knows if there are more bytes to come. 8 bits at 11 cycles each.
+
+I2C_READ_BYTE:
+			.loop		8
+			.loop		I2C_PAD_R_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; (4) SCL high
+			BIT.B		R8,&I2C_DTA_PIN			; (3) C = this bit
+			RLC.B		R9						; (1) ...into the bottom of R9
+			.loop		I2C_PAD_R_HIGH
+			NOP
+			.endloop
+			MOV.B		R11,&I2C_CLK_POUT		; (3) SCL low. The RV3032 puts out its next bit.
+			.endloop
+			RET
+
+; ACK the byte we just read so the RV3032 sends the next one.
+
+I2C_ACK:
+			MOV.B		R10,&I2C_CLK_POUT		; SDA pull-down
+			BIS.B		R8,&I2C_DTA_PDIR		; Drive SDA low for the ACK
+			.loop		I2C_PAD_M_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; SCL high
+			.loop		I2C_PAD_W_HIGH
+			NOP
+			.endloop
+			MOV.B		R10,&I2C_CLK_POUT		; SCL low
+			BIC.B		R8,&I2C_DTA_PDIR		; Let go of SDA. The RV3032 is putting out the first bit of the next byte.
+			MOV.B		R11,&I2C_CLK_POUT		; Pull-up on
+			.loop		I2C_PAD_M_REL
+			NOP
+			.endloop
+			RET
+
+; NACK the last byte so the RV3032 lets go of SDA for the STOP. SDA is already pulled up, so we just clock it.
+
+I2C_NACK:
+			.loop		I2C_PAD_N_LOW
+			NOP
+			.endloop
+			BIS.B		#I2C_SCL,&I2C_CLK_POUT	; SCL high
+			.loop		I2C_PAD_W_HIGH
+			NOP
+			.endloop
+			MOV.B		R11,&I2C_CLK_POUT		; SCL low
+			RET
+
+
+; *** The C side
+
+; Set up the registers every transfer uses. Bus must be idle.
+
+I2C_BEGIN:
+			CLR.W		R7
+			MOV.W		#I2C_SDA,R8
+			MOV.B		&I2C_CLK_POUT,R10
+			BIC.B		#(I2C_SCL|I2C_SDA),R10
+			RET
+
+; Turn the count of missing ACKs in R7 into the 0 or 1 we return, put back the caller's registers, and return to C.
+
+I2C_END:
+			CLR.W		R12
+			TST.W		R7
+			JZ			i2c_end_ack
+			MOV.W		#1,R12
+i2c_end_ack:
+			POP.W		R10
+			POP.W		R9
+			POP.W		R8
+			POP.W		R7
+			POP.W		R6
+			RET
+
+
+; unsigned char i2c_transfer(unsigned char slave, const i2c_op_t *ops, uint8_t count)
+;
+; Do `count` register reads and writes from the `ops` array, all in one bus session. There is one START at the beginning,
+; a repeated START between each op (and between setting the register and reading in a read op), and one STOP at the end.
+; Starts and ends with the bus idle.
+;
+; Each i2c_op_t is 4 bytes (see i2c_master.h)...
+;   +0  register to start at
+;   +1  byte count, with I2C_OP_READ set for a read
+;   +2  pointer to the bytes to write, or where to put the bytes read
+;
+; Returns 0 on success, 1 if any byte was not ACKed. We still clock through everything in that case, so reads get
+; 0xFF (nobody is pulling SDA low) and the bus ends up idle either way.
+;
+; R6 = data pointer, R13 = next op, R14 = ops left, R15 = bytes left in this op
+
+			.global		i2c_transfer
+i2c_transfer:
+			PUSH.W		R6
+			PUSH.W		R7
+			PUSH.W		R8
+			PUSH.W		R9
+			PUSH.W		R10
+			CALL		#I2C_BEGIN
+			CALL		#I2C_START
+			JMP			i2c_transfer_op
+
+i2c_transfer_next:
+			CALL		#I2C_RESTART
+i2c_transfer_op:
+			MOV.B		R12,R9
+			RLA.B		R9						; Slave address with the write bit...
+			CALL		#I2C_WRITE_BYTE
+			MOV.B		@R13+,R9				; ...then the register to start at
+			CALL		#I2C_WRITE_BYTE
+			MOV.B		@R13+,R15
+			MOV.W		@R13+,R6
+			BIT.B		#I2C_OP_READ,R15
+			JNZ			i2c_transfer_read
+
+			TST.B		R15
+			JZ			i2c_transfer_done
+i2c_transfer_write:
+			MOV.B		@R6+,R9
+			CALL		#I2C_WRITE_BYTE
+			DEC.B		R15
+			JNZ			i2c_transfer_write
+			JMP			i2c_transfer_done
+
+i2c_transfer_read:
+			AND.B		#(~I2C_OP_READ)&0xFF,R15	; Not BIC, which leaves the flags alone
+			JZ			i2c_transfer_done		; Nothing to read, so we only set the register
+			CALL		#I2C_RESTART
+			MOV.B		R12,R9
+			SETC
+			RLC.B		R9						; Slave address with the read bit
+			CALL		#I2C_WRITE_BYTE
+i2c_transfer_read_next:
+			CALL		#I2C_READ_BYTE
+			MOV.B		R9,0(R6)
+			INC.W		R6
+			DEC.B		R15
+			JZ			i2c_transfer_read_last
+			CALL		#I2C_ACK
+			JMP			i2c_transfer_read_next
+i2c_transfer_read_last:
+			CALL		#I2C_NACK
+
+i2c_transfer_done:
+			DEC.B		R14
+			JNZ			i2c_transfer_next
+			CALL		#I2C_STOP
+			JMP			I2C_END
+
+			.end
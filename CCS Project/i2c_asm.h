@@ -0,0 +1,58 @@
+/*
+ * i2c_asm.h
+ *
+ *  The bus timing for the bit-banged I2C engine in i2c_asm.asm, which is how we talk to the RV3032.
+ *
+ *  Everything the engine does is a fixed number of cycles, so it works out at assembly time how many NOPs it needs between
+ *  the pin writes to meet these times at I2C_MCLK_HZ. At our ~1MHz MCLK the instructions themselves are already slower than
+ *  any of the minimums and no NOPs get put in, but if MCLK ever goes up, change I2C_MCLK_HZ and the pads will grow to keep
+ *  the bus legal.
+ *
+ *  sim/i2c_bus.py runs the engine against a model of the RV3032 and checks every edge against these numbers.
+ *
+ */
+
+#ifndef I2C_ASM_H_
+#define I2C_ASM_H_
+
+// The fastest MCLK can be. The DCO is 1MHz +/-10%, and faster means each cycle is shorter, so we take the fast end.
+#define I2C_MCLK_HZ 1100000
+
+// Fastest SCL allowed. The RV3032 does fast mode (400kHz). Set to 100000 for standard mode timing if the bus ever gets long
+// or picks up something slower.
+#define I2C_BUS_HZ 400000
+
+// How long a released SDA takes to get from low to a solid high through the internal pull-up (~30K) and the pin and trace
+// capacitance (~20pF), with some margin.
+#define I2C_T_RISE_NS 1200
+
+// Or'ed into the count of an i2c_op_t (see i2c_master.h) to make it a read. So an op can move at most 127 bytes.
+#define I2C_OP_READ 0x80
+
+// Minimums from the RV3032 datasheet (RV-3032-C7 App Manual 8.7, I2C bus characteristics), in ns.
+
+#if I2C_BUS_HZ > 100000
+
+#define I2C_T_LOW_NS        1300        // SCL low
+#define I2C_T_HIGH_NS       600         // SCL high
+#define I2C_T_SU_STA_NS     600         // SCL high before a repeated START
+#define I2C_T_HD_STA_NS     600         // START before the first SCL low
+#define I2C_T_SU_STO_NS     600         // SCL high before STOP
+#define I2C_T_BUF_NS        1300        // Bus free between a STOP and the next START
+#define I2C_T_SU_DAT_NS     100         // SDA settled before SCL goes high
+#define I2C_T_VD_DAT_NS     900         // SCL low until the RV3032 has its next bit (or ACK) on SDA. A maximum, we wait this long.
+
+#else
+
+#define I2C_T_LOW_NS        4700
+#define I2C_T_HIGH_NS       4000
+#define I2C_T_SU_STA_NS     4700
+#define I2C_T_HD_STA_NS     4000
+#define I2C_T_SU_STO_NS     4000
+#define I2C_T_BUF_NS        4700
+#define I2C_T_SU_DAT_NS     250
+#define I2C_T_VD_DAT_NS     3450
+
+#endif
+
+#endif /* I2C_ASM_H_ */
@@ -8,21 +8,35 @@
 #ifndef I2C_MASTER_H_
 #define I2C_MASTER_H_
 
+#include "i2c_asm.h"        // I2C_OP_READ
+
 
 //********** Prototypes **********//
 
 void              i2c_init( void );
-unsigned char USI_TWI_Start_Transceiver_With_Data(unsigned char, unsigned char * , unsigned char );
-unsigned char USI_TWI_Get_State_Info( void );
 
-unsigned char i2c_read(unsigned char slave,unsigned char addr, void *msg, unsigned char msgSize);
+// One register read or write for i2c_transfer(). The layout is fixed since i2c_asm.asm walks the array itself.
+
+typedef struct {
+    uint8_t reg;            // Register to start at. The slave moves to the next register after each byte.
+    uint8_t count;          // How many bytes, with I2C_OP_READ or'ed in for a read
+    void *data;             // Bytes to write, or where to put the bytes read
+} i2c_op_t;
+
+// Do all the ops in one bus session, with repeated STARTs between them. Starts and ends with the bus idle.
+// Returns 0 on success, 1 if the slave did not ACK something. Reads of a slave that is not there come back as 0xFF.
+// This is in i2c_asm.asm.
 
-unsigned char i2c_write(unsigned char slave, unsigned char addr, const void *data , uint8_t size);
+#ifdef __cplusplus
+extern "C" {
+#endif
 
+unsigned char i2c_transfer( unsigned char slave , const i2c_op_t *ops , uint8_t count );
 
-/// float pins and disable input buffers
+#ifdef __cplusplus
+}
+#endif
 
-void USI_TWI_Master_disable( void );
 
 // Drive both pins low
 
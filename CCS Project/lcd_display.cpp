@@ -185,6 +185,14 @@ constexpr digit_lpin_record_t digitplace_lpins_table[DIGITPLACE_COUNT] {
 #define HOURS_ONES_DIGITPLACE_INDEX ( 4)
 #define HOURS_TENS_DIGITPLACE_INDEX ( 5)
 
+// The day digits only change at midnight, so they just had to fit wherever the routing would let them.
+#define DAYS_ONES_DIGITPLACE_INDEX              ( 6)
+#define DAYS_TENS_DIGITPLACE_INDEX              ( 7)
+#define DAYS_HUNDREDS_DIGITPLACE_INDEX          ( 8)
+#define DAYS_THOUSANDS_DIGITPLACE_INDEX         ( 9)
+#define DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX     (10)
+#define DAYS_HUNDRED_THOUSANDS_DIGITPLACE_INDEX (11)
+
 // Returns the byte address for the specified L-pin
 // Assumes MSP430 LCD is in 4-Mux mode
 // This mapping comes from the MSP430FR2xx datasheet Fig 17-2
@@ -389,6 +397,67 @@ void fill_lcd_bytes( byte *bytes , const byte digit_index ) {
 };
 
 
+// The day ones and tens digits happen to share a LCDMEM word, so TSL_MODE_ISR walks this table once per day just like it walks the
+// mins table once per minute. Same +1 offset as the other words tables, so [99] = "00" and [0] = "01".
+
+word days_lcd_words[DAYS_LCD_WORDS_COUNT];
+
+static_assert( lpin_t<digitplace_lpins_table[DAYS_ONES_DIGITPLACE_INDEX].lpin_a_thru_d >::lcdmem_offset() >> 1 ==  lpin_t<digitplace_lpins_table[DAYS_ONES_DIGITPLACE_INDEX].lpin_e_thru_g>::lcdmem_offset() >> 1  , "The days ones digit LPINs must be in the same LCDMEM word");
+static_assert( lpin_t<digitplace_lpins_table[DAYS_TENS_DIGITPLACE_INDEX].lpin_a_thru_d >::lcdmem_offset() >> 1 ==  lpin_t<digitplace_lpins_table[DAYS_TENS_DIGITPLACE_INDEX].lpin_e_thru_g>::lcdmem_offset() >> 1  , "The days tens digit LPINs must be in the same LCDMEM word");
+static_assert( lpin_t<digitplace_lpins_table[DAYS_ONES_DIGITPLACE_INDEX].lpin_a_thru_d >::lcdmem_offset() >> 1 ==  lpin_t<digitplace_lpins_table[DAYS_TENS_DIGITPLACE_INDEX].lpin_e_thru_g>::lcdmem_offset() >> 1  , "The days ones and tens digits LPINs must be in the same LCDMEM word");
+
+// This word is hardcoded into the ASM as LCDM0W_L+8
+static_assert( (lpin_t<digitplace_lpins_table[DAYS_ONES_DIGITPLACE_INDEX].lpin_a_thru_d >::lcdmem_offset() & ~0x01 ) == 8 , "TSL_MODE_ISR writes the days ones and tens to LCDMEM+8");
+
+// The days hundreds digit has its nibbles in the same byte and in the same order as the hours digits, so the ISR just uses `hours_lcd_bytes` for it.
+static_assert( lpin_t<digitplace_lpins_table[DAYS_HUNDREDS_DIGITPLACE_INDEX].lpin_a_thru_d>::lcdmem_offset() == lpin_t<digitplace_lpins_table[DAYS_HUNDREDS_DIGITPLACE_INDEX].lpin_e_thru_g>::lcdmem_offset() , "days 100's digit pins must be in the same LCDMEM byte " );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_HUNDREDS_DIGITPLACE_INDEX].lpin_a_thru_d>::nibble() == lpin_t<digitplace_lpins_table[HOURS_ONES_DIGITPLACE_INDEX].lpin_a_thru_d>::nibble() , "days 100's digit must have its nibbles in the same order as the hours digits" );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_HUNDREDS_DIGITPLACE_INDEX].lpin_a_thru_d>::lcdmem_offset() == 7 , "TSL_MODE_ISR writes the days 100's digit to LCDMEM+7" );
+
+// The top two day digits each have their own byte, but with the nibbles the other way around from the hours digits, so they get their own table.
+
+byte days_high_lcd_bytes[10];
+
+static_assert( lpin_t<digitplace_lpins_table[DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::lcdmem_offset() == lpin_t<digitplace_lpins_table[DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX].lpin_e_thru_g>::lcdmem_offset() , "days 10,000's digit pins must be in the same LCDMEM byte " );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_HUNDRED_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::lcdmem_offset() == lpin_t<digitplace_lpins_table[DAYS_HUNDRED_THOUSANDS_DIGITPLACE_INDEX].lpin_e_thru_g>::lcdmem_offset() , "days 100,000's digit pins must be in the same LCDMEM byte " );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::nibble() == lpin_t<digitplace_lpins_table[DAYS_HUNDRED_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::nibble() , "both high days digits must have thier nibbbles in the same order" );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::lcdmem_offset() == 1 , "TSL_MODE_ISR writes the days 10,000's digit to LCDMEM+1" );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_HUNDRED_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::lcdmem_offset() == 2 , "TSL_MODE_ISR writes the days 100,000's digit to LCDMEM+2" );
+
+// The days thousands digit is the odd one out - its two LPINs ended up in different LCDMEM bytes. Luckily both are upper nibbles, so for each
+// digit we keep the upper nibble for each of the two bytes and the ISR merges them in with a BIC.B #0xf0 and a BIS.B.
+
+byte days_thousands_e_thru_g_lcd_bytes[10];
+byte days_thousands_a_thru_d_lcd_bytes[10];
+
+static_assert( lpin_t<digitplace_lpins_table[DAYS_THOUSANDS_DIGITPLACE_INDEX].lpin_e_thru_g>::nibble() == UPPER , "TSL_MODE_ISR assumes the days 1,000's digit E-G pin is an upper nibble" );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::nibble() == UPPER , "TSL_MODE_ISR assumes the days 1,000's digit A-D pin is an upper nibble" );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_THOUSANDS_DIGITPLACE_INDEX].lpin_e_thru_g>::lcdmem_offset() == 0 , "TSL_MODE_ISR writes the days 1,000's digit E-G pin to LCDMEM+0" );
+static_assert( lpin_t<digitplace_lpins_table[DAYS_THOUSANDS_DIGITPLACE_INDEX].lpin_a_thru_d>::lcdmem_offset() == 6 , "TSL_MODE_ISR writes the days 1,000's digit A-D pin to LCDMEM+6" );
+
+// Builds a pair of RAM-based tables of bytes for a digitplace whose two LPINs are in different LCDMEM bytes. Each byte has only the nibble for
+// that digitplace set, and the other nibble is left as 0 so it can be ORed into the LCDMEM byte.
+
+void fill_lcd_split_bytes( byte *e_thru_g_bytes , byte *a_thru_d_bytes , const byte digit_index ) {
+
+    const digit_lpin_record_t logical_digit = digitplace_lpins_table[ digit_index];
+
+    for( byte digit = 0; digit < 10  ; digit ++ ) {
+
+        byte e_thru_g_byte = 0;
+        byte a_thru_d_byte = 0;
+
+        set_nibble( &e_thru_g_byte , lpin_nibble( logical_digit.lpin_e_thru_g ) , digit_segments[digit].nibble_e_thru_g );
+        set_nibble( &a_thru_d_byte , lpin_nibble( logical_digit.lpin_a_thru_d ) , digit_segments[digit].nibble_a_thru_d );
+
+        e_thru_g_bytes[ digit ] = e_thru_g_byte;
+        a_thru_d_bytes[ digit ] = a_thru_d_byte;
+
+    }
+
+};
+
+
 
 
 // Define a full LCD frame so we can put it into LCD memory in one shot.
@@ -480,6 +549,307 @@ void fill_ready_to_launch_lcd_frames() {
 */
 
 
+// *** Messages compiled into frames
+
+// A whole screen in the same compact format as the ready-to-launch frames - only the LCDMEM words that have pins connected, in
+// `used_rtl_lcdmem_bytes` order. The messages below are worked out into these at compile time and live in FRAM, so showing
+// one is just 8 word moves.
+
+struct lcd_frame_words_t {
+    word w[RTL_LCDMEM_WORD_COUNT];
+};
+
+// These are never defined. Calling one inside a constexpr function means it can not be worked out at compile time, so a message
+// with a character we have no glyph for, or that does not fill exactly 12 digitplaces, will not compile and the error points here.
+
+glyph_segment_t lcd_message_has_a_character_with_no_glyph( const char c );
+void lcd_message_is_not_12_digitplaces_long();
+
+// The glyph for a character in a message. Case matters since the upper and lower case versions look different, and only the
+// ones we have glyphs for work. 'm' is not here because it takes two digitplaces, see lcd_compile_message().
+
+constexpr glyph_segment_t glyph_for_char( const char c ) {
+
+    switch ( c ) {
+
+        case '0': return glyph_0;
+        case '1': return glyph_1;
+        case '2': return glyph_2;
+        case '3': return glyph_3;
+        case '4': return glyph_4;
+        case '5': return glyph_5;
+        case '6': return glyph_6;
+        case '7': return glyph_7;
+        case '8': return glyph_8;
+        case '9': return glyph_9;
+        case 'A': return glyph_A;
+        case 'b': return glyph_b;
+        case 'C': return glyph_C;
+        case 'c': return glyph_c;
+        case 'd': return glyph_d;
+        case 'E': return glyph_E;
+        case 'F': return glyph_F;
+        case 'g': return glyph_g;
+        case 'H': return glyph_H;
+        case 'I': return glyph_I;
+        case 'J': return glyph_J;
+        case 'K': return glyph_K;
+        case 'i': return glyph_i;
+        case 'L': return glyph_L;
+        case 'n': return glyph_n;
+        case 'O': return glyph_O;
+        case 'o': return glyph_o;
+        case 'P': return glyph_P;
+        case 'r': return glyph_r;
+        case 'S': return glyph_S;
+        case 't': return glyph_t;
+        case 'u': return glyph_u;
+        case 'X': return glyph_X;
+        case 'y': return glyph_y;
+        case ' ': return glyph_SPACE;
+        case '-': return glyph_dash;
+        case '[': return glyph_lbrac;
+        case ']': return glyph_rbrac;
+
+        default: return lcd_message_has_a_character_with_no_glyph( c );
+
+    }
+
+}
+
+// Same as set_nibble(), but for an image of all of LCDMEM that we are building at compile time
+
+constexpr void lcd_image_set_nibble( byte *image , const uint8_t lpin , const nibble x ) {
+
+    if ( lpin_nibble( lpin ) == nibble_t::LOWER ) {
+        image[ lpin_lcdmem_offset( lpin ) ] |= x;
+    } else {
+        image[ lpin_lcdmem_offset( lpin ) ] |= x << 4;
+    }
+
+}
+
+// Same as lcd_show_f(), but into the image. The image starts blank and each digitplace only gets drawn once, so we can just OR.
+
+constexpr void lcd_image_show( byte *image , const uint8_t pos , const glyph_segment_t segs ) {
+
+    lcd_image_set_nibble( image , digitplace_lpins_table[pos].lpin_a_thru_d , segs.nibble_a_thru_d );
+    lcd_image_set_nibble( image , digitplace_lpins_table[pos].lpin_e_thru_g , segs.nibble_e_thru_g );
+
+}
+
+// Pull the words with pins connected out of the image
+
+constexpr lcd_frame_words_t lcd_image_to_frame( const byte *image ) {
+
+    lcd_frame_words_t frame = {};
+
+    for( byte i=0 ; i< RTL_LCDMEM_WORD_COUNT ; i++ ) {
+        const byte b = used_rtl_lcdmem_bytes[i];
+        frame.w[i] = image[b] | ( image[b+1] << 8 );        // Little endian, same as reading it as a word
+    }
+
+    return frame;
+}
+
+// A frame showing the 12 glyphs in `message`, leftmost first. For messages that need glyphs with no character.
+
+constexpr lcd_frame_words_t lcd_compile_glyphs( const glyph_segment_t *message ) {
+
+    byte image[ LCDMEM_WORD_COUNT * 2 ] = {};         // Start blank so the nibbles for the unconnected LPINs are predictable
+
+    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
+        lcd_image_show( image , DIGITPLACE_COUNT - 1 - i , message[i] );       // digit place 0 is rightmost, so reverse order for text
+    }
+
+    return lcd_image_to_frame( image );
+}
+
+// How many digitplaces `text` takes up
+
+constexpr unsigned lcd_message_digitplaces( const char *text ) {
+
+    unsigned places = 0;
+
+    for( const char *c = text ; *c ; c++ ) {
+        places += ( *c == 'm' ) ? 2 : 1;
+    }
+
+    return places;
+}
+
+// A frame showing `text`, leftmost character first. An 'm' is drawn as the two halves we use for it, so it takes two digitplaces
+// and "  Arming   " fills the screen.
+
+constexpr lcd_frame_words_t lcd_compile_message( const char *text ) {
+
+    if ( lcd_message_digitplaces( text ) != DIGITPLACE_COUNT ) {
+        lcd_message_is_not_12_digitplaces_long();
+    }
+
+    byte image[ LCDMEM_WORD_COUNT * 2 ] = {};
+
+    uint8_t pos = DIGITPLACE_COUNT;
+
+    for( const char *c = text ; *c ; c++ ) {
+
+        if ( *c == 'm' ) {
+            lcd_image_show( image , --pos , glyph_m1 );
+            lcd_image_show( image , --pos , glyph_m2 );
+        } else {
+            lcd_image_show( image , --pos , glyph_for_char( *c ) );
+        }
+
+    }
+
+    return lcd_image_to_frame( image );
+}
+
+// Put a whole frame on the screen
+
+#pragma FUNC_ALWAYS_INLINE
+static inline void lcd_show_frame( const lcd_frame_words_t *frame ) {
+
+    #pragma UNROLL( RTL_LCDMEM_WORD_COUNT )
+    for( byte i=0 ; i< RTL_LCDMEM_WORD_COUNT ; i++ ) {
+        LCDMEMW[ used_rtl_lcdmem_bytes[i]/2 ] = frame->w[i];  // div by 2 to convert byte index into word index
+    }
+
+}
+
+
+// *** Composing a frame in RAM
+
+// Screens with numbers in them get built up in this copy of the used LCDMEM words, then lcd_compose_commit() puts the whole thing
+// up at once, only writing the words that are different from what is already on the screen.
+
+static lcd_frame_words_t lcd_compose_words;
+
+// Where one nibble of a digitplace lives in a lcd_frame_words_t
+
+struct frame_nibble_slot_t {
+    uint8_t word_index;         // Index into lcd_frame_words_t.w
+    uint8_t shift;              // 0, 4, 8, or 12
+};
+
+struct digitplace_frame_slot_t {
+    frame_nibble_slot_t a_thru_d;
+    frame_nibble_slot_t e_thru_g;
+};
+
+struct digitplace_frame_slots_t {
+    digitplace_frame_slot_t slot[DIGITPLACE_COUNT];
+};
+
+// Never defined, same trick as lcd_message_has_a_character_with_no_glyph()
+frame_nibble_slot_t lpin_is_not_in_a_used_lcdmem_word( const uint8_t lpin );
+
+constexpr frame_nibble_slot_t lpin_frame_nibble_slot( const uint8_t lpin ) {
+
+    for( uint8_t i=0 ; i< RTL_LCDMEM_WORD_COUNT ; i++ ) {
+
+        if ( used_rtl_lcdmem_bytes[i] == ( lpin_lcdmem_offset( lpin ) & ~0x01 ) ) {
+
+            const uint8_t shift = ( ( lpin_lcdmem_offset( lpin ) & 0x01 ) ? 8 : 0 ) + ( lpin_nibble( lpin ) == nibble_t::UPPER ? 4 : 0 );
+            return { i , shift };
+
+        }
+
+    }
+
+    return lpin_is_not_in_a_used_lcdmem_word( lpin );
+}
+
+constexpr digitplace_frame_slots_t compute_digitplace_frame_slots() {
+
+    digitplace_frame_slots_t slots = {};
+
+    for( uint8_t pos=0 ; pos < DIGITPLACE_COUNT ; pos++ ) {
+        slots.slot[pos].a_thru_d = lpin_frame_nibble_slot( digitplace_lpins_table[pos].lpin_a_thru_d );
+        slots.slot[pos].e_thru_g = lpin_frame_nibble_slot( digitplace_lpins_table[pos].lpin_e_thru_g );
+    }
+
+    return slots;
+}
+
+// Worked out at compile time from `digitplace_lpins_table`, so moving a pin can not leave this behind
+constexpr digitplace_frame_slots_t digitplace_frame_slots = compute_digitplace_frame_slots();
+
+// Put one nibble in its place in the frame. We have no barrel shifter, so the switch gets us constant shifts instead of a shift loop.
+
+static void lcd_compose_nibble( const frame_nibble_slot_t slot , const nibble x ) {
+
+    word *w = &lcd_compose_words.w[ slot.word_index ];
+
+    switch ( slot.shift ) {
+        case  0: *w = ( *w & 0xfff0 ) | ( x       ); break;
+        case  4: *w = ( *w & 0xff0f ) | ( x <<  4 ); break;
+        case  8: *w = ( *w & 0xf0ff ) | ( x <<  8 ); break;
+        case 12: *w = ( *w & 0x0fff ) | ( x << 12 ); break;
+    }
+
+}
+
+static void lcd_compose_glyph( const uint8_t pos , const glyph_segment_t segs ) {
+
+    const digitplace_frame_slot_t slot = digitplace_frame_slots.slot[pos];
+
+    lcd_compose_nibble( slot.a_thru_d , segs.nibble_a_thru_d );
+    lcd_compose_nibble( slot.e_thru_g , segs.nibble_e_thru_g );
+
+}
+
+// Start composing from a compiled message
+
+static void lcd_compose_frame( const lcd_frame_words_t *frame ) {
+    lcd_compose_words = *frame;
+}
+
+void lcd_compose_clear() {
+    lcd_compose_words = {};
+}
+
+void lcd_compose_digit( const uint8_t pos , const byte d ) {
+    lcd_compose_glyph( pos , digit_segments[d] );
+}
+
+void lcd_compose_commit() {
+
+    for( byte i=0 ; i< RTL_LCDMEM_WORD_COUNT ; i++ ) {
+
+        word * const lcdmem_word = &LCDMEMW[ used_rtl_lcdmem_bytes[i]/2 ];
+
+        if ( *lcdmem_word != lcd_compose_words.w[i] ) {
+            *lcdmem_word = lcd_compose_words.w[i];
+        }
+
+    }
+
+}
+
+
+// *** Overlay in the other bank
+
+// Put a frame into LCDBMEM. The COM pins get their COM assignments from whichever bank is on the screen, so those get copied over too.
+
+static void lcd_overlay_load( const lcd_frame_words_t *frame ) {
+
+    word * const lcdbmemw = (word *) LCDBMEM;
+
+    for( byte i=0 ; i< RTL_LCDMEM_WORD_COUNT ; i++ ) {
+        lcdbmemw[ used_rtl_lcdmem_bytes[i]/2 ] = frame->w[i];
+    }
+
+    LCDBM4 = LCDM4;
+    LCDBM5 = LCDM5;
+
+}
+
+void lcd_overlay_hide() {
+    LCDMEMCTL &= ~LCDDISP;
+}
+
+
 // Fills the arrays
 
 void initLCDPrecomputedWordArrays() {
@@ -496,6 +866,10 @@ void initLCDPrecomputedWordArrays() {
     // Fill the array of frames for ready-to-launch-mode animation
     fill_lcd_bytes( hours_lcd_bytes , HOURS_ONES_DIGITPLACE_INDEX );
     fill_ready_to_launch_lcd_frames();
+    // Fill the day digit tables that TSL_MODE_ISR uses at midnight. The days 100's digit uses the hours table.
+    fill_lcd_words( days_lcd_words , DAYS_TENS_DIGITPLACE_INDEX , DAYS_ONES_DIGITPLACE_INDEX , 10 , 10 );
+    fill_lcd_split_bytes( days_thousands_e_thru_g_lcd_bytes , days_thousands_a_thru_d_lcd_bytes , DAYS_THOUSANDS_DIGITPLACE_INDEX );
+    fill_lcd_bytes( days_high_lcd_bytes , DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX );
 }
 
 
@@ -701,14 +1075,10 @@ void lcd_show_digit_f( const uint8_t pos, const byte d ) {
 // For now, show all 9's.
 // TODO: Figure out something better here
 
-void lcd_show_long_now() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-
-        lcd_show_digit_f( i , 9 );
-
-    }
+constexpr lcd_frame_words_t long_now_frame = lcd_compile_message( "999999999999" );
 
+void lcd_show_long_now() {
+    lcd_show_frame( &long_now_frame );
 }
 
 
@@ -742,179 +1112,74 @@ void lcd_show_squiggle_frame( byte step ) {
 
 // Fill the screen with horizontal dashes
 
-void lcd_show_dashes() {
+constexpr lcd_frame_words_t dashes_frame = lcd_compile_message( "------------" );
 
-    for( uint8_t i=0 ; i<DIGITPLACE_COUNT; i++ ) {
-
-        lcd_show_f( i , glyph_dash );
-
-    }
+void lcd_show_dashes() {
+    lcd_show_frame( &dashes_frame );
 }
 
 
 // Fill the screen with 0's
 
-void lcd_show_zeros() {
+constexpr lcd_frame_words_t zeros_frame = lcd_compile_message( "000000000000" );
 
-    for( uint8_t i=0 ; i<DIGITPLACE_COUNT; i++ ) {
-
-        lcd_show_f( i , glyph_0 );
-
-    }
+void lcd_show_zeros() {
+    lcd_show_frame( &zeros_frame );
 }
 
 // Fill the screen with X's
 
-void lcd_show_XXX() {
-
-    for( uint8_t i=0 ; i<DIGITPLACE_COUNT; i++ ) {
-
-        lcd_show_f( i , glyph_X );
+constexpr lcd_frame_words_t XXX_frame = lcd_compile_message( "XXXXXXXXXXXX" );
 
-    }
+void lcd_show_XXX() {
+    lcd_show_frame( &XXX_frame );
 }
 
 
-
-constexpr glyph_segment_t testingonly_message[] = {
-                                                   glyph_t,
-                                                   glyph_E,
-                                                   glyph_S,
-                                                   glyph_t,
-                                                   glyph_I,
-                                                   glyph_n,
-                                                   glyph_g,
-                                                   glyph_SPACE,
-                                                   glyph_O,
-                                                   glyph_n,
-                                                   glyph_L,
-                                                   glyph_y,
-};
-
+constexpr lcd_frame_words_t testingonly_frame = lcd_compile_message( "tEStIng OnLy" );
 
 void lcd_show_testing_only_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , testingonly_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
-
+    lcd_show_frame( &testingonly_frame );
 }
 
 
-// "bAtt Error X"
-
-constexpr glyph_segment_t batt_errorcode_message[] = {
-     glyph_b, // "b"
-     glyph_A, // "A"
-     glyph_t,  // t
-     glyph_t,  // t
-     glyph_SPACE, // " "
-     glyph_E, // "E"
-     glyph_r, // "r"
-     glyph_r, // "r"
-     glyph_o, // "o"
-     glyph_r, // "r"
-     glyph_SPACE, // " "
-     glyph_X, // "X"
-
-};
+constexpr lcd_frame_words_t batt_errorcode_frame = lcd_compile_message( "bAtt Error X" );
 
 // Show the message "bAtt Error X" on the lcd.
 
 void lcd_show_batt_errorcode( byte code  ) {
 
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , batt_errorcode_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
-
-    lcd_show_digit_f( 0 , code );
+    lcd_compose_frame( &batt_errorcode_frame );
+    lcd_compose_digit( 0 , code );
+    lcd_compose_commit();
 
 }
 
 
-// "Error CodE X"
-
-constexpr glyph_segment_t errorcode_message[] = {
-    glyph_E, // "E"
-    glyph_r, // "r"
-    glyph_r, // "r"
-    glyph_o, // "o"
-    glyph_r, // "r"
-    glyph_SPACE, // " "
-    glyph_C, // "C"
-    glyph_o, // "o"
-    glyph_d, // "d"
-    glyph_E, // "E"
-    glyph_SPACE, // " "
-    glyph_X, // "X"
-
-};
+constexpr lcd_frame_words_t errorcode_frame = lcd_compile_message( "Error CodE X" );
 
 // Show the message "Error X" on the lcd.
 
 void lcd_show_errorcode( byte code  ) {
 
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , errorcode_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
-
-    lcd_show_digit_f( 0 , code );
+    lcd_compose_frame( &errorcode_frame );
+    lcd_compose_digit( 0 , code );
+    lcd_compose_commit();
 
 }
 
 
-// PIn In--=
-
-constexpr glyph_segment_t pin_is_in_message[] = {
-                                                 glyph_P,
-                                                 glyph_i,
-                                                 glyph_n,
-                                                 glyph_SPACE,
-                                                 glyph_i,
-                                                 glyph_n,
-                                                 glyph_SPACE,
-                                                 glyph_E,
-                                                 glyph_r,
-                                                 glyph_r,
-                                                 glyph_SPACE,
-                                                 glyph_SPACE,
-};
-
+constexpr lcd_frame_words_t pin_is_in_frame = lcd_compile_message( "Pin in Err  " );
 
 void lcd_show_pin_in_err_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , pin_is_in_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 0 is rightmost, so reverse order for text
-    }
-
+    lcd_show_frame( &pin_is_in_frame );
 }
 
 
-
-// LoAd PIn --=
-
-constexpr glyph_segment_t load_pin_message[] = {
-                                                 glyph_L,
-                                                 glyph_O,
-                                                 glyph_A,
-                                                 glyph_d,
-                                                 glyph_SPACE,
-                                                 glyph_P,
-                                                 glyph_i,
-                                                 glyph_n,
-                                                 glyph_SPACE,
-                                                 glyph_SPACE,
-                                                 glyph_SPACE,
-                                                 glyph_SPACE,
-};
-
+constexpr lcd_frame_words_t load_pin_frame = lcd_compile_message( "LOAd Pin    " );
 
 void lcd_show_load_pin_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , load_pin_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 0 is rightmost, so reverse order for text
-    }
-
+    lcd_show_frame( &load_pin_frame );
 }
 
 // Since dash is moving to the right, we only need to erase the slot immediately to the left on each step.
@@ -954,55 +1219,23 @@ void lcd_show_load_pin_animation(unsigned int step) {
 }
 
 
-constexpr glyph_segment_t first_start_message[] = {
-                                                   glyph_F,
-                                                   glyph_i,
-                                                   glyph_r,
-                                                   glyph_S,
-                                                   glyph_t,
-                                                   glyph_SPACE,
-                                                   glyph_S,
-                                                   glyph_t,
-                                                   glyph_A,
-                                                   glyph_r,
-                                                   glyph_t,
-                                                   glyph_SPACE,
-};
+constexpr lcd_frame_words_t first_start_frame = lcd_compile_message( "FirSt StArt " );
 
 // Show "First Start"
 void lcd_show_first_start_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , first_start_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_show_frame( &first_start_frame );
 }
 
-// " -Armning-  "
-
-constexpr glyph_segment_t arming_message[] = {
-                                                   glyph_SPACE,
-                                                   glyph_SPACE,
-                                                   glyph_A,
-                                                   glyph_r,
-                                                   glyph_m1,
-                                                   glyph_m2,
-                                                   glyph_i,
-                                                   glyph_n,
-                                                   glyph_g,
-                                                   glyph_SPACE,
-                                                   glyph_SPACE,
-                                                   glyph_SPACE,
-};
+constexpr lcd_frame_words_t arming_frame = lcd_compile_message( "  Arming   " );
 
 // Show "Arming"
 void lcd_show_arming_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , arming_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_show_frame( &arming_frame );
 }
 
 
+// These glyphs only make sense all together, so there are no characters for them.
+
 constexpr glyph_segment_t centesimus_dies_message[] = {
     {0x09,0x05},
     {0x08,0x06},
@@ -1018,195 +1251,111 @@ constexpr glyph_segment_t centesimus_dies_message[] = {
     {0x06,0x07},
 };
 
+constexpr lcd_frame_words_t centesimus_dies_frame = lcd_compile_glyphs( centesimus_dies_message );
+
 // Refresh day 100's places digits
 void lcd_show_centesimus_dies_message() {
+    lcd_show_frame( &centesimus_dies_frame );
+}
 
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , centesimus_dies_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+void lcd_overlay_load_centesimus_dies() {
+    lcd_overlay_load( &centesimus_dies_frame );
 }
 
 
-// CLOCK GOOd
-
-constexpr glyph_segment_t clock_good_message[] = {
-                                                   glyph_SPACE,
-                                                   glyph_C,
-                                                   glyph_L,
-                                                   glyph_O,
-                                                   glyph_C,
-                                                   glyph_K,
-                                                   glyph_SPACE,
-                                                   glyph_g,
-                                                   glyph_O,
-                                                   glyph_O,
-                                                   glyph_d,
-                                                   glyph_SPACE,
-};
+constexpr lcd_frame_words_t clock_good_frame = lcd_compile_message( " CLOCK gOOd " );
 
 // Show "CLOCK GOOd"
 void lcd_show_clock_good_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , clock_good_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_show_frame( &clock_good_frame );
 }
 
 
-
-// CLOCK LOSt
-
-constexpr glyph_segment_t clock_lost_message[] = {
-                                                   glyph_SPACE,
-                                                   glyph_C,
-                                                   glyph_L,
-                                                   glyph_O,
-                                                   glyph_C,
-                                                   glyph_K,
-                                                   glyph_SPACE,
-                                                   glyph_L,
-                                                   glyph_O,
-                                                   glyph_S,
-                                                   glyph_t,
-                                                   glyph_SPACE,
-};
+constexpr lcd_frame_words_t clock_lost_frame = lcd_compile_message( " CLOCK LOSt " );
 
 // Show "CLOCK LOSt"
 void lcd_show_clock_lost_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , clock_lost_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_show_frame( &clock_lost_frame );
 }
 
 
-constexpr glyph_segment_t all_8s_message[] = {
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-                                                   glyph_8,
-};
+constexpr lcd_frame_words_t all_8s_frame = lcd_compile_message( "888888888888" );
 
 // Show "888888888888"
 void lcd_show_all_8s_message() {
-
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , all_8s_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_show_frame( &all_8s_frame );
 }
 
 
-constexpr glyph_segment_t amps_hi_message[] = {
-                                                   glyph_A,
-                                                   glyph_m1,
-                                                   glyph_m2,
-                                                   glyph_P,
-                                                   glyph_S,
-                                                   glyph_SPACE,
-                                                   glyph_H,
-                                                   glyph_I,
-                                                   glyph_SPACE,
-                                                   glyph_SPACE,
-                                                   glyph_SPACE,
-                                                   glyph_SPACE,
-};
+constexpr lcd_frame_words_t amps_hi_frame = lcd_compile_message( "AmPS HI    " );
 
-// Show "888888888888"
 void lcd_show_amps_hi_message( unsigned count ) {
 
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , amps_hi_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_compose_frame( &amps_hi_frame );
 
-    lcd_show_digit_f( 2 , (count / 100 ) % 10  );
-    lcd_show_digit_f( 1 , (count / 10 )  % 10  );
-    lcd_show_digit_f( 0 , (count / 1 )   % 10  );
+    lcd_compose_digit( 2 , (count / 100 ) % 10  );
+    lcd_compose_digit( 1 , (count / 10 )  % 10  );
+    lcd_compose_digit( 0 , (count / 1 )   % 10  );
+
+    lcd_compose_commit();
 
 }
 
 
-constexpr glyph_segment_t amps_lo_message[] = {
-                                                   glyph_A,
-                                                   glyph_m1,
-                                                   glyph_m2,
-                                                   glyph_P,
-                                                   glyph_S,
-                                                   glyph_SPACE,
-                                                   glyph_L,
-                                                   glyph_o,
-                                                   glyph_SPACE,
-                                                   glyph_X,
-                                                   glyph_X,
-                                                   glyph_X,
-};
+constexpr lcd_frame_words_t amps_lo_frame = lcd_compile_message( "AmPS Lo XXX" );
 
 void lcd_show_amps_lo_message( unsigned count ) {
 
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , amps_lo_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_compose_frame( &amps_lo_frame );
 
     if (count<1000) {
-        lcd_show_digit_f( 2 , (count / 100 ) % 10  );
-        lcd_show_digit_f( 1 , (count / 10 )  % 10  );
-        lcd_show_digit_f( 0 , (count / 1 )   % 10  );
+        lcd_compose_digit( 2 , (count / 100 ) % 10  );
+        lcd_compose_digit( 1 , (count / 10 )  % 10  );
+        lcd_compose_digit( 0 , (count / 1 )   % 10  );
     }
+
+    lcd_compose_commit();
 }
 
-constexpr glyph_segment_t lo_volt_message[] = {
-                                                   glyph_L,
-                                                   glyph_o,
-                                                   glyph_SPACE,
-                                                   glyph_u,
-                                                   glyph_o,
-                                                   glyph_L,
-                                                   glyph_t,
-                                                   glyph_SPACE,
-                                                   glyph_X,
-                                                   glyph_X,
-                                                   glyph_X,
-                                                   glyph_X,
-};
+constexpr lcd_frame_words_t lo_volt_frame = lcd_compile_message( "Lo uoLt XXXX" );
 
 void lcd_show_lo_volt_message( unsigned count ) {
 
-    for( byte i=0; i<DIGITPLACE_COUNT; i++ ) {
-        lcd_show_f(  i , lo_volt_message[ DIGITPLACE_COUNT - 1- i] );        // digit place 12 is rightmost, so reverse order for text
-    }
+    lcd_compose_frame( &lo_volt_frame );
 
     if (count<10000) {
-        lcd_show_digit_f( 2 , (count / 1000) % 10  );
-        lcd_show_digit_f( 2 , (count / 100 ) % 10  );
-        lcd_show_digit_f( 1 , (count / 10 )  % 10  );
-        lcd_show_digit_f( 0 , (count / 1 )   % 10  );
+        lcd_compose_digit( 3 , (count / 1000) % 10  );
+        lcd_compose_digit( 2 , (count / 100 ) % 10  );
+        lcd_compose_digit( 1 , (count / 10 )  % 10  );
+        lcd_compose_digit( 0 , (count / 1 )   % 10  );
     }
+
+    lcd_compose_commit();
 }
 
+constexpr lcd_frame_words_t crc_frame = lcd_compile_message( "CrC     XXXX" );
 
+void lcd_show_crc_message( unsigned crc ) {
 
-// Save the current LCD display pixels. Must be in the header because it is a template.
-// Do not look at the object code for these two function or you will be very sad. Come on compiler, you had one job and I made it easy for you.
-void lcd_save_screen( lcd_save_screen_buffer_t *buffer) {
-    unsigned *x = buffer->w;
-    for( unsigned i=0; i< LCDMEM_WORD_COUNT ; i++ ) {
-        *(x++) = *(LCDMEMW +i);
-    }
+    lcd_compose_frame( &crc_frame );
 
+    lcd_compose_digit( 3 , (crc >> 12) & 0x0f );
+    lcd_compose_digit( 2 , (crc >> 8 ) & 0x0f );
+    lcd_compose_digit( 1 , (crc >> 4 ) & 0x0f );
+    lcd_compose_digit( 0 , (crc >> 0 ) & 0x0f );
+
+    lcd_compose_commit();
 }
 
-// Save the current LCD display pixels. Must be in the header because it is a template.
-void lcd_restore_screen( lcd_save_screen_buffer_t *buffer) {
-    unsigned *x = buffer->w;
-    for( unsigned i=0; i< LCDMEM_WORD_COUNT ; i++ ) {
-        *(LCDMEMW +i) = *(x++) ;
-    }
 
+constexpr lcd_frame_words_t drive_sweep_frame = lcd_compile_message( "8888888888XX" );
+
+void lcd_show_drive_sweep_message( unsigned profile ) {
+
+    lcd_compose_frame( &drive_sweep_frame );
+
+    lcd_compose_digit( 1 , (profile / 10 ) % 10  );
+    lcd_compose_digit( 0 , (profile / 1 )  % 10  );
+
+    lcd_compose_commit();
 }
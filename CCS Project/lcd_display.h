@@ -29,6 +29,8 @@ extern "C" {
 
     #define MINS_PER_HOUR 60
 
+    #define DAYS_LCD_WORDS_COUNT 100        // The days ones and tens digits, 00-99
+
     const byte READY_TO_LAUNCH_LCD_FRAME_COUNT=8;                             // How many frames in the ready-to-launch mode animation
 
     // Fills the arrays
@@ -107,6 +109,22 @@ extern "C" {
 
     void lcd_show_lo_volt_message( unsigned count );
 
+    // Show "CrC     XXXX" with the image CRC in hex
+    void lcd_show_crc_message( unsigned crc );
+
+    // Show "8888888888NN" with the LCD drive profile the sweep is on
+    void lcd_show_drive_sweep_message( unsigned profile );
+
+    // Build up a screen in RAM and then put it up all at once with lcd_compose_commit(), which only writes the LCDMEM
+    // words that changed. Start with lcd_compose_clear() for a blank screen.
+
+    void lcd_compose_clear();
+
+    // Digit d (0-15) at position pos, where 0 is the rightmost
+    void lcd_compose_digit( const uint8_t pos , const byte d );
+
+    void lcd_compose_commit();
+
 
 
     // these arrays hold the pre-computed words that we will write to word in LCD memory that
@@ -118,16 +136,15 @@ extern "C" {
     // Write a value from this array into this word to update the two digits on the LCD display
     extern word *secs_lcdmem_word;
 
-    struct lcd_save_screen_buffer_t {
-        unsigned w[LCDMEM_WORD_COUNT];
-    };
-
+    // The LCD_E has a second bank of segment memory, LCDBMEM, and the LCDDISP bit picks which bank is on the screen. We draw a message
+    // into LCDBMEM once, and then putting it up and taking it down is just flipping that bit. Whatever is counting in LCDMEM never gets touched.
 
-    // Save the current LCD display pixels
-    void lcd_save_screen( lcd_save_screen_buffer_t *buffer);
+    // Draw "centesimus dies" into LCDBMEM. Call after the COM pins are set up in LCDMEM. TSL_MODE_ISR flips to it at midnight every 128 days
+    // by setting LCDDISP itself, and clears it again on the next minute.
+    void lcd_overlay_load_centesimus_dies();
 
-    // Restore the current LCD display pixels
-    void lcd_restore_screen( lcd_save_screen_buffer_t *buffer);
+    // Back to LCDMEM, in case we reset while TSL_MODE_ISR had the overlay up
+    void lcd_overlay_hide();
 
 }
 
@@ -1,49 +1,99 @@
 /*
  * persistent.h
  *
- * This is the structure for the data that we store in the "InfoA" section of flash memory. This data persists through power cycles.
- * We break it out into a header file solely so that the ASM code can include it to find the address of `mins`, which the ISR needs to increment once per minute.
+ * GENERATED FROM persistent_schema.json BY gen_persistent.py. DO NOT EDIT.
  *
- *  Created on: Jul 18, 2024
- *      Author: passp
+ * The data that we store in the "InfoA" section of FRAM at 0x1800. This data persists through power cycles and reprogramming.
+ * persistent_schema.json is the only place the layout is written down. Change it there and run gen_persistent.py, which rewrites the C structs
+ * (persistent.h), the offsets for the ASM (persistent_offsets.h), and the decoders the tools in /programming use to read dumps.
  */
 
 #ifndef PERSISTENT_H_
 #define PERSISTENT_H_
 
+#include <stddef.h>
+
 #include "timeblock.h"
+#include "persistent_offsets.h"
+
+// One copy of the time since launch. `crc` covers `days` and `seq` (but not `mins`, which gets incremented in place) and is computed with the
+// CRC module, starting from PERSISTENT_SLOT_CRC_SEED. A slot whose `crc` does not match has never been written or was interrupted mid-write.
+
+struct __attribute__((__packed__)) persistent_counter_slot_t {
+    volatile unsigned mins;                 // It would be too much work to update this every second, so once a minute is good. Note that it is possible for this value to end up at `minutes_per_day`, in which case you must normalize it and increment days.
+    volatile unsigned long days;            // Has to be long since 2^16 days is only ~180 years and we plan on working for much longer than that.
+    volatile unsigned crc;
+    volatile unsigned seq;                  // Written last. One more than the other slot's `seq` (mod 2^16) when this is the newest slot.
+};
 
 // Here is the persistent data that we store in "information memory" FRAM that survives power cycles
 // and reprogramming.
 
 struct __attribute__((__packed__)) persistent_data_t {
-
-    rv3032_time_block_t programmed_time;       // Calendar time when this unit was Programmed.Used to initialize the RTC on first power up.
-    rv3032_time_block_t launched_time;          // Time when this unit was launched relative to programmed time. Set when trigger pulled, never read.
-
+    rv3032_time_block_t programmed_time;    // Calendar time when this unit was Programmed.Used to initialize the RTC on first power up.
+    rv3032_time_block_t launched_time;      // Time when this unit was launched relative to programmed time. Set when trigger pulled, never read.
 
     // State. We have 3 persistent states, (1) first startup fresh from factory programming, (2) ready to launch, (3) launched.
     // We make these volatile to ensure that the compiler actually writes changes to memory rather than trying to cache in a register
-
-    volatile unsigned initalized_flag;                         // Set to 1 after first time we boot up after programming. At this step, we check for excess current draw when we power down.
-    volatile unsigned commisisoned_flag;                       // Set to 1 after we commission, which involves inserting the batteries and trigger pin.
-    volatile unsigned launched_flag;                           // Set to 1 when the trigger pin is pulled.
-
-    volatile unsigned porsoltCount;                            // How many 0.1 seconds did the unit stay alive after power was removed during initialization?
-
-    volatile unsigned tsl_powerup_count;                           // How many times have we booted up since we initialized (Max 65535. Should be 1 until first battery change in about 150 years.)
-
-    // Time since launch
-    volatile unsigned mins;             // It would be too much work to update this every second, so once a minute is good. Note that it is possible for this value to end up at `minutes_per_day`, in which case you must normalize it and increment days.
-    volatile unsigned long days;        // Has to be long since 2^16 days is only ~180 years and we plan on working for much longer than that.
-
-    // We need to be able to update the above values atomically so we use an interlock here so we can do the right thing in case we get interrupted exactly in the middle of an update.
-    volatile unsigned update_flag;             // Set to 1 when an update is in progress (backup values are valid)
-    volatile unsigned backup_mins;             // These backup values are captured before we set `update_flag`.
-    volatile unsigned long backup_days;
-
+    volatile unsigned initalized_flag;      // Set to 1 after first time we boot up after programming. At this step, we check for excess current draw when we power down.
+    volatile unsigned commisisoned_flag;    // Set to 1 after we commission, which involves inserting the batteries and trigger pin.
+    volatile unsigned launched_flag;        // Set to 1 when the trigger pin is pulled.
+    volatile unsigned porsoltCount;         // How many 0.1 seconds did the unit stay alive after power was removed during initialization?
+    volatile unsigned tsl_powerup_count;    // How many times have we booted up since we initialized (Max 65535. Should be 1 until first battery change in about 150 years.)
+
+    // Time since launch, as written by firmware from before the counter slots below. Never written anymore. We only read these once,
+    // the first time we boot up after an update, to migrate a unit that was launched with the old firmware. The old firmware updated them
+    // with an interlock: `update_flag` was set while an update was in progress, and then the backup values were the ones to use.
+    volatile unsigned legacy_mins;
+    volatile unsigned long legacy_days;
+    volatile unsigned legacy_update_flag;
+    volatile unsigned legacy_backup_mins;
+    volatile unsigned long legacy_backup_days;
+
+    // Time since launch. Two slots, and the one with the newest valid `seq` is the current time. TSL_MODE_ISR increments the `mins` of
+    // the current slot in place, and at midnight writes the new day into the *other* slot and then commits it with a single write to its `seq`.
+    // If we lose power before that write, the old slot is still the newest, so there is never a moment when neither slot is good.
+    persistent_counter_slot_t counter_slots[2];
+
+    // CRC of the program FRAM, computed on the first boot after programming. The programming station writes the complement of the CRC it
+    // expects here along with the image, and reads it back after letting us run, instead of reading back the whole image to verify it.
+    volatile unsigned image_crc;
+
+    // CRC of the RV3032 config we wrote into its EEPROM at commissioning, as read back from the EEPROM. Once this matches the profile the
+    // firmware wants, the RTC loads that config by itself after any power loss and rv3032_init() does not have to write it on every boot.
+    volatile unsigned rtc_profile_crc;
+
+    // Which entry in `lcd_drive_profiles` (tsl-calibre-msp.cpp) initLCD() drives the glass with, as PERSISTENT_LCD_DRIVE_KEY plus the index,
+    // or PERSISTENT_LCD_DRIVE_KEY plus PERSISTENT_LCD_DRIVE_SWEEP for the characterization sweep. The programming station writes it with the image.
+    unsigned lcd_drive_profile;
 };
 
+// Check that the compiler laid things out where persistent_offsets.h (and so the ASM) thinks they are.
+
+static_assert( sizeof( rv3032_time_block_t ) == 7 , "rv3032_time_block_t in timeblock.h does not match persistent_schema.json" );
+static_assert( sizeof( persistent_counter_slot_t ) == PERSISTENT_COUNTER_SLOT_SIZE , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_counter_slot_t , mins ) == PERSISTENT_COUNTER_SLOT_MINS_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_counter_slot_t , days ) == PERSISTENT_COUNTER_SLOT_DAYS_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_counter_slot_t , crc ) == PERSISTENT_COUNTER_SLOT_CRC_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_counter_slot_t , seq ) == PERSISTENT_COUNTER_SLOT_SEQ_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( sizeof( persistent_data_t ) == PERSISTENT_DATA_SIZE , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , programmed_time ) == PERSISTENT_PROGRAMMED_TIME_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , launched_time ) == PERSISTENT_LAUNCHED_TIME_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , initalized_flag ) == PERSISTENT_INITALIZED_FLAG_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , commisisoned_flag ) == PERSISTENT_COMMISISONED_FLAG_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , launched_flag ) == PERSISTENT_LAUNCHED_FLAG_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , porsoltCount ) == PERSISTENT_PORSOLTCOUNT_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , tsl_powerup_count ) == PERSISTENT_TSL_POWERUP_COUNT_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , legacy_mins ) == PERSISTENT_LEGACY_MINS_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , legacy_days ) == PERSISTENT_LEGACY_DAYS_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , legacy_update_flag ) == PERSISTENT_LEGACY_UPDATE_FLAG_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , legacy_backup_mins ) == PERSISTENT_LEGACY_BACKUP_MINS_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , legacy_backup_days ) == PERSISTENT_LEGACY_BACKUP_DAYS_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , counter_slots ) == PERSISTENT_COUNTER_SLOTS_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , image_crc ) == PERSISTENT_IMAGE_CRC_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , rtc_profile_crc ) == PERSISTENT_RTC_PROFILE_CRC_OFFSET , "persistent.h does not match persistent_offsets.h" );
+static_assert( offsetof( persistent_data_t , lcd_drive_profile ) == PERSISTENT_LCD_DRIVE_PROFILE_OFFSET , "persistent.h does not match persistent_offsets.h" );
+
 // Tell compiler/linker to put this in "info memory" that we set up in the linker file to live at 0x1800
 // This area of memory never gets overwritten, not by power cycle and not by downloading a new binary image into program FRAM.
 
@@ -0,0 +1,54 @@
+/*
+ * persistent_offsets.h
+ *
+ * GENERATED FROM persistent_schema.json BY gen_persistent.py. DO NOT EDIT.
+ *
+ * Byte offsets of the persistent_data_t fields. The ASM .cdecls this to get at the fields as `persistent_data+OFFSET`, since
+ * the assembler can not see into structs. Only #defines in here so that the assembler can take it.
+ */
+
+#ifndef PERSISTENT_OFFSETS_H_
+#define PERSISTENT_OFFSETS_H_
+
+#define PERSISTENT_BASE_ADDRESS                  0x1800 // Where the linker puts persistent_data (PERSISTANT in lnk_msp430fr4133.cmd)
+
+// persistent_counter_slot_t
+#define PERSISTENT_COUNTER_SLOT_SIZE             10
+#define PERSISTENT_COUNTER_SLOT_MINS_OFFSET      0
+#define PERSISTENT_COUNTER_SLOT_DAYS_OFFSET      2
+#define PERSISTENT_COUNTER_SLOT_CRC_OFFSET       6
+#define PERSISTENT_COUNTER_SLOT_SEQ_OFFSET       8
+
+// persistent_data_t
+#define PERSISTENT_DATA_SIZE                     64
+#define PERSISTENT_PROGRAMMED_TIME_OFFSET        0
+#define PERSISTENT_LAUNCHED_TIME_OFFSET          7
+#define PERSISTENT_INITALIZED_FLAG_OFFSET        14
+#define PERSISTENT_COMMISISONED_FLAG_OFFSET      16
+#define PERSISTENT_LAUNCHED_FLAG_OFFSET          18
+#define PERSISTENT_PORSOLTCOUNT_OFFSET           20
+#define PERSISTENT_TSL_POWERUP_COUNT_OFFSET      22
+#define PERSISTENT_LEGACY_MINS_OFFSET            24
+#define PERSISTENT_LEGACY_DAYS_OFFSET            26
+#define PERSISTENT_LEGACY_UPDATE_FLAG_OFFSET     30
+#define PERSISTENT_LEGACY_BACKUP_MINS_OFFSET     32
+#define PERSISTENT_LEGACY_BACKUP_DAYS_OFFSET     34
+#define PERSISTENT_COUNTER_SLOTS_OFFSET          38
+#define PERSISTENT_COUNTER_SLOTS_COUNT           2
+#define PERSISTENT_COUNTER_SLOTS_TOGGLE          22     // XOR into the address of one of the counter_slots to get the other
+#define PERSISTENT_IMAGE_CRC_OFFSET              58
+#define PERSISTENT_RTC_PROFILE_CRC_OFFSET        60
+#define PERSISTENT_LCD_DRIVE_PROFILE_OFFSET      62
+
+#define PERSISTENT_SLOT_CRC_SEED                 0xFFFF // Written to CRCINIRES before feeding a counter slot's days and seq into CRCDI. Same as CRC-CCITT, and free from the constant generator.
+#define PERSISTENT_IMAGE_CRC_START               0xC400 // Start of the program FRAM that `image_crc` covers (FRAM in lnk_msp430fr4133.cmd). It runs to the top of memory, so the vectors are in it too.
+#define PERSISTENT_IMAGE_CRC_WORDS               0x1E00 // 0xC400-0xFFFF, fed into CRCDI a word at a time
+#define PERSISTENT_IMAGE_CRC_SEED                0xFFFF
+#define PERSISTENT_RTC_PROFILE_CRC_SEED          0xFFFF // Written to CRCINIRES before feeding the RV3032 EEPROM profile (address and value of each register) into CRCDI.
+#define PERSISTENT_LCD_DRIVE_KEY                 0xA500 // High byte of `lcd_drive_profile` when it was really written. Anything else there (like a unit from before the field existed) means the production profile.
+#define PERSISTENT_LCD_DRIVE_KEY_MASK            0xFF00
+#define PERSISTENT_LCD_DRIVE_SWEEP               0x00FF // Low byte of `lcd_drive_profile` that runs the LCD drive characterization sweep at boot instead of the normal life cycle.
+#define PERSISTENT_LCD_DRIVE_PROFILE_COUNT       15     // How many entries `lcd_drive_profiles` has. A lower byte at or past this gets the production profile.
+#define PERSISTENT_LCD_DRIVE_EXTERNAL_VLCD_COUNT 8      // Profiles below this take Vlcd from the TPS7A0228. The ones from here up make it on the chip and fight the regulator on a production board.
+
+#endif /* PERSISTENT_OFFSETS_H_ */
@@ -1,5 +1,6 @@
 #include <msp430.h>
 #include <limits.h>
+#include <stddef.h>
 #include "util.h"
 #include "pins.h"
 #include "i2c_master.h"
@@ -35,6 +36,14 @@ void lcd_blinking_mode() {
     LCDBLKCTL = LCDBLKPRE__64 | LCDBLKMOD_2;       // Clock prescaler for blink rate, "10b = Blinking of all segments"
 }
 
+// Start the long-life blinking for TSL mode if this build has it. After this the LCD does it all by itself.
+
+void lcd_tsl_blink_mode() {
+#if TSL_LCD_BLINK
+    LCDBLKCTL = TSL_LCD_BLINK_CTL;
+#endif
+}
+
 
 // Turn off power to RV3032 (also takes care of making the IO pin not float and disabling the interrupt)
 void depower_rv3032() {
@@ -225,102 +234,113 @@ void initGPIO() {
 
 }
 
-void initLCD() {
-
-    // Configure LCD pins
-    SYSCFG2 |= LCDPCTL;                                 // LCD R13/R23/R33/LCDCAP0/LCDCAP1 pins enabled
-
-    // TODO: We can make a template to compute these from logical_digits
-    LCDPCTL0 = 0b1110111100111110;  // LCD pins L15-L01, 1=enabled
-    LCDPCTL1 = 0b1111110000111111;  // LCD pins L31-L16, 1=enabled
-    LCDPCTL2 = 0b0000000000001111;  // LCD pins L35-L32, 1=enabled
-
-    // LCDCTL0 = LCDSSEL_0 | LCDDIV_7;                     // flcd ref freq is xtclk
-
-    // TODO: Try different clocks and dividers
-
-    // Divide by 2 (so CLK will be 10KHz/2= 5KHz), Very Low Osc, Turn on LCD, 4-mux selected (LCD4MUX also includes LCDSON)
-    // Note this has a bit of a flicker
-    //LCDCTL0 = LCDDIV_2 | LCDSSEL__VLOCLK | LCD4MUX | LCDSON | LCDON  ;
-
-    // TODO: Try different clocks and dividers
-    // Divide by 1 (so CLK will be 10Khz), Very Low Osc, Turn on LCD, 4-mux selected (LCD4MUX also includes LCDSON)
-    //LCDCTL0 = LCDDIV_1 | LCDSSEL__VLOCLK | LCD4MUX | LCDSON | LCDON  ;
-
-    // Divide by 1 (so CLK will be 10Khz), Very Low Osc, Turn on LCD, 4-mux selected (LCD4MUX also includes LCDSON), Low power waveform
-    //LCDCTL0 = LCDDIV_1 | LCDSSEL__VLOCLK | LCD4MUX | LCDSON | LCDON | LCDLP ;
-
-    // LCD using VLO clock, divide by 4 (on 10KHz from VLO) , 4-mux (LCD4MUX also includes LCDSON), low power waveform. No flicker. Squiggle=1.45uA. Count=2.00uA. I guess not worth the flicker for 0.2uA?
-    LCDCTL0 =  LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP ;
-
-    // LCD using VLO clock, divide by 5 (on 10KHz from VLO) , 4-mux (LCD4MUX also includes LCDSON), low power waveform. Visible flicker at large view angles. Squiggle=1.35uA. Count=1.83uA
-    //LCDCTL0 =  LCDSSEL__VLOCLK | LCDDIV__5 | LCD4MUX | LCDLP ;
-
-    // LCD using VLO clock, divide by 6 (on 10KHz from VLO) , 4-mux (LCD4MUX also includes LCDSON), low power waveform. VISIBLE FLICKER at 3.5V
-    //LCDCTL0 =  LCDSSEL__VLOCLK | LCDDIV__6 | LCD4MUX | LCDLP ;
-
-
-/*
-    // Divide by 32 (so CLK will be 32768/32 = ~1KHz), Very Low Osc, Turn on LCD, 4-mux selected (LCD4MUX also includes LCDSON)
-    LCDCTL0 = LCDDIV_7 | LCDSSEL__XTCLK | LCD4MUX | LCDSON | LCDON  ;
-*/
-
-
-    // LCD Operation - Mode 3, internal 3.08v, charge pump 256Hz, ~5uA from 3.5V Vcc
-    //LCDVCTL = LCDCPEN | LCDREFEN | VLCD_6 | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3);
-
-
-
-    // LCD Operation - internal V1 regulator=3.32v , charge pump 256Hz
-    // LCDVCTL = LCDCPEN | LCDREFEN | VLCD_12 | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3);
-
-
-    // LCD Operation - Pin R33 is connected to external Vcc, charge pump 256Hz, 1.7uA
-    //LCDVCTL = LCDCPEN | LCDSELVDD | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3);
-
-
-    // LCD Operation - Pin R33 is connected to internal Vcc, no charge pump
-    //LCDVCTL = LCDSELVDD;
-
+// LCD drive profiles. Each is a clock setting (LCDCTL0) and a Vlcd source (LCDVCTL) that we have tried on the glass, with what we measured.
+// `lcd_drive_profile` in persistent_data picks one at boot, so trying a different one is a config write rather than a rebuild. Measurements
+// are the whole unit at Vcc=3.5V unless noted ("Squiggle" is ready-to-launch, "Count" is time-since-launch).
+//
+// Also tried, but these need different parts on the board so they are not profiles:
+//   All 3 LCD voltages from external regulators, LCDVCTL=0: 2.48uA. Not worth it.
+//   1 external regulator + a 3x 1M Ohm ladder, LCDVCTL=0: 2.9uA. Not worth it.
+//   LCDSSEL__XTCLK/32 off a 32768Hz crystal, which we do not have.
+
+enum lcd_drive_profile_index_t {
+
+    // Vlcd from the TPS7A0228 on R33 (2.8V), charge pump at the slowest setting. These are all safe on the production board, and the sweep runs these.
+
+    LCD_DRIVE_VLO_DIV4_LP,          // Production. No flicker. Squiggle=1.45uA. Count=2.00uA. Another run got 1.7uA, and 2.1uA/180uA with the regulator.
+    LCD_DRIVE_VLO_DIV5_LP,          // Visible flicker at large view angles. Squiggle=1.35uA. Count=1.83uA. I guess not worth the flicker for 0.2uA?
+    LCD_DRIVE_VLO_DIV6_LP,          // VISIBLE FLICKER at 3.5V
+    LCD_DRIVE_VLO_DIV3_LP,          // Not measured yet
+    LCD_DRIVE_VLO_DIV2_LP,          // Not measured yet. Without the low power waveform this one had a bit of a flicker.
+    LCD_DRIVE_VLO_DIV1_LP,          // Not measured yet
+    LCD_DRIVE_VLO_DIV4,             // Not measured yet. Same as production but the normal waveform.
+    LCD_DRIVE_VLO_DIV4_LP_CP64,     // Same as production but the charge pump at 64Hz. 2.1uA/180uA, so no better.
+
+    // The rest make Vlcd on the chip, which fights the TPS7A0228 on R33. Only for boards or glass without it.
+
+    LCD_DRIVE_VDD_CP,               // R33 to internal Vcc, charge pump at 256Hz. 1.7uA one time, 2.5uA another. Good for testing without a regulator.
+    LCD_DRIVE_VDD,                  // R33 to internal Vcc, no charge pump
+    LCD_DRIVE_INT_VLCD3_REFMODE,    // Internal 2.78V, reference only on 1/256th of the time. ~4.0uA
+    LCD_DRIVE_INT_VLCD6_REFMODE,    // Internal 2.96V, reference only on 1/256th of the time. ~4.2uA
+    LCD_DRIVE_INT_VLCD7_REFMODE,    // Internal 3.02V, reference only on 1/256th of the time. ~4.2uA
+    LCD_DRIVE_INT_VLCD6,            // Mode 3, internal 3.08V. ~5uA
+    LCD_DRIVE_INT_VLCD12,           // Internal V1 regulator=3.32V
+
+    LCD_DRIVE_PROFILE_COUNT
+};
 
-    // LCD Operation - Pin R33 is connected to external V1, charge pump 256Hz, 1.7uA
-    //LCDVCTL = LCDCPEN | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3);
+// The sweep stops before the first profile that would fight the regulator
 
+static const unsigned lcd_drive_sweep_count = LCD_DRIVE_VDD_CP;
 
-    // LCD Operation - Mode 3, internal 2.96v, charge pump 256Hz, voltage reference only on 1/256th of the time. ~4.2uA from 3.5V Vcc
-    // LCDVCTL = LCDCPEN | LCDREFEN | VLCD_6 | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3) | LCDREFMODE;
+// The programming station range checks what it writes into `lcd_drive_profile` against these
 
-    // LCD Operation - Mode 3, internal 3.02v, charge pump 256Hz, voltage reference only on 1/256th of the time. ~4.2uA from 3.5V Vcc
-    //LCDVCTL = LCDCPEN | LCDREFEN | VLCD_7 | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3) | LCDREFMODE;
+static_assert( LCD_DRIVE_PROFILE_COUNT == PERSISTENT_LCD_DRIVE_PROFILE_COUNT , "PERSISTENT_LCD_DRIVE_PROFILE_COUNT in persistent_schema.json must match lcd_drive_profile_index_t" );
+static_assert( LCD_DRIVE_VDD_CP == PERSISTENT_LCD_DRIVE_EXTERNAL_VLCD_COUNT , "PERSISTENT_LCD_DRIVE_EXTERNAL_VLCD_COUNT in persistent_schema.json must match lcd_drive_profile_index_t" );
 
+struct lcd_drive_profile_t {
+    unsigned lcdctl0;           // Clock, divider, mux, and waveform. Without LCDON, which initLCD() sets once everything else is ready.
+    unsigned lcdvctl;           // Where Vlcd comes from, and the charge pump
+};
 
-    // LCD Operation - Mode 3, internal 2.78v, charge pump 256Hz, voltage reference only on 1/256th of the time. ~4.2uA from 3.5V Vcc
-    //LCDVCTL = LCDCPEN | LCDREFEN | VLCD_3 | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3) | LCDREFMODE;
+#define LCD_CP_256HZ    (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3)        // Charge pump at its slowest
+#define LCD_CP_64HZ     (LCDCPFSEL0 | LCDCPFSEL1 )
+
+// In the same order as `lcd_drive_profile_index_t`. LCD4MUX also includes LCDSON.
+
+static const lcd_drive_profile_t lcd_drive_profiles[] = {
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCD_CP_256HZ },                                   // LCD_DRIVE_VLO_DIV4_LP
+    { LCDSSEL__VLOCLK | LCDDIV__5 | LCD4MUX | LCDLP , LCDCPEN | LCD_CP_256HZ },                                   // LCD_DRIVE_VLO_DIV5_LP
+    { LCDSSEL__VLOCLK | LCDDIV__6 | LCD4MUX | LCDLP , LCDCPEN | LCD_CP_256HZ },                                   // LCD_DRIVE_VLO_DIV6_LP
+    { LCDSSEL__VLOCLK | LCDDIV__3 | LCD4MUX | LCDLP , LCDCPEN | LCD_CP_256HZ },                                   // LCD_DRIVE_VLO_DIV3_LP
+    { LCDSSEL__VLOCLK | LCDDIV__2 | LCD4MUX | LCDLP , LCDCPEN | LCD_CP_256HZ },                                   // LCD_DRIVE_VLO_DIV2_LP
+    { LCDSSEL__VLOCLK | LCDDIV__1 | LCD4MUX | LCDLP , LCDCPEN | LCD_CP_256HZ },                                   // LCD_DRIVE_VLO_DIV1_LP
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX         , LCDCPEN | LCD_CP_256HZ },                                   // LCD_DRIVE_VLO_DIV4
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCD_CP_64HZ  },                                   // LCD_DRIVE_VLO_DIV4_LP_CP64
+
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCDSELVDD | LCD_CP_256HZ },                       // LCD_DRIVE_VDD_CP
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDSELVDD },                                                // LCD_DRIVE_VDD
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCDREFEN | VLCD_3 | LCD_CP_256HZ | LCDREFMODE },  // LCD_DRIVE_INT_VLCD3_REFMODE
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCDREFEN | VLCD_6 | LCD_CP_256HZ | LCDREFMODE },  // LCD_DRIVE_INT_VLCD6_REFMODE
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCDREFEN | VLCD_7 | LCD_CP_256HZ | LCDREFMODE },  // LCD_DRIVE_INT_VLCD7_REFMODE
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCDREFEN | VLCD_6 | LCD_CP_256HZ },               // LCD_DRIVE_INT_VLCD6
+    { LCDSSEL__VLOCLK | LCDDIV__4 | LCD4MUX | LCDLP , LCDCPEN | LCDREFEN | VLCD_12 | LCD_CP_256HZ },              // LCD_DRIVE_INT_VLCD12
+};
 
+static_assert( sizeof( lcd_drive_profiles ) / sizeof( lcd_drive_profiles[0] ) == LCD_DRIVE_PROFILE_COUNT , "lcd_drive_profiles must have one entry for each lcd_drive_profile_index_t" );
 
-    // LCD Operation - Mode 3, internal 2.78v, charge pump 256Hz, voltage reference only on 1/256th of the time. ~4.0uA from 3.5V Vcc
-    //LCDVCTL = LCDCPEN | LCDREFEN | VLCD_3 | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3) | LCDREFMODE;
+// The profile `lcd_drive_profile` asks for. Anything without the key (like a unit from before we had the field) or off the end of the table gets production.
 
+static unsigned lcd_drive_profile_selected() {
 
-    // LCD Operation - All 3 LCD voltages external. When generating all 3 with regulators, we get 2.48uA @ Vcc=3.5V so not worth it.
-    //LCDVCTL = 0;
+    const unsigned v = persistent_data.lcd_drive_profile;
 
+    if ( ( v & PERSISTENT_LCD_DRIVE_KEY_MASK ) == PERSISTENT_LCD_DRIVE_KEY && ( v & ~PERSISTENT_LCD_DRIVE_KEY_MASK ) < LCD_DRIVE_PROFILE_COUNT ) {
+        return v & ~PERSISTENT_LCD_DRIVE_KEY_MASK;
+    }
 
-    // LCD Operation - All 3 LCD voltages external. When generating 1 regulators + 3 1M Ohm resistors, we get 2.9uA @ Vcc=3.5V so not worth it.
-    //LCDVCTL = 0;
+    return LCD_DRIVE_VLO_DIV4_LP;
+}
 
+// Only call with the LCD off (LCDON clear). The clock and Vlcd settings can not change while it is running.
 
-    // LCD Operation - Charge pump enable, Vlcd=Vcc , charge pump FREQ=/256Hz (lowest)  2.5uA - Good for testing without a regulator
-    //LCDVCTL = LCDCPEN |  LCDSELVDD | (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3);
+static void lcd_set_drive( unsigned profile ) {
+    LCDCTL0 = lcd_drive_profiles[ profile ].lcdctl0;
+    LCDVCTL = lcd_drive_profiles[ profile ].lcdvctl;
+}
 
-    /* WINNER for controlled Vlcd - Uses external TSP7A0228 regulator for Vlcd on R33 */
-    // LCD Operation - Charge pump enable, Vlcd=external from R33 pin , charge pump FREQ=/256Hz (lowest). 2.1uA/180uA  @ Vcc=3.5V . Vlcd=2.8V  from TPS7A0228 no blinking.
-    LCDVCTL = LCDCPEN |   (LCDCPFSEL0 | LCDCPFSEL1 | LCDCPFSEL2 | LCDCPFSEL3);
+void initLCD() {
 
+    // Configure LCD pins
+    SYSCFG2 |= LCDPCTL;                                 // LCD R13/R23/R33/LCDCAP0/LCDCAP1 pins enabled
 
-    // LCD Operation - Charge pump enable, Vlcd=external from R33 pin , charge pump FREQ=/64Hz . 2.1uA/180uA  @ Vcc=3.5V . Vlcd=2.8V  from TPS7A0228 no blinking.
-    //LCDVCTL = LCDCPEN |   (LCDCPFSEL0 | LCDCPFSEL1 );
+    // TODO: We can make a template to compute these from logical_digits
+    LCDPCTL0 = 0b1110111100111110;  // LCD pins L15-L01, 1=enabled
+    LCDPCTL1 = 0b1111110000111111;  // LCD pins L31-L16, 1=enabled
+    LCDPCTL2 = 0b0000000000001111;  // LCD pins L35-L32, 1=enabled
 
+    // Clock and Vlcd from the drive profile table above. Production is VLO/4 with the low power waveform and Vlcd from the TPS7A0228.
+    lcd_set_drive( lcd_drive_profile_selected() );
 
     //LCDMEMCTL |= LCDCLRM;                                      // Clear LCD memory
 
@@ -344,6 +364,9 @@ void initLCD() {
 
     LCDBLKCTL = 0x00;       // Disable blinking. We do this because this bit is not cleared on reset so if we are resetting out of at blinking mode then it would otherwise persist.
 
+    lcd_overlay_hide();     // In case we reset while the centesimus dies message was up
+    lcd_overlay_load_centesimus_dies();
+
     LCDCTL0 |= LCDON;                                           // Turn on LCD
 
 }
@@ -363,30 +386,154 @@ static_assert( sizeof( rv3032_time_block_t ) == 7 , "The size of this structure
 #define RV3032_DAYS_REG  0x05
 #define RV3032_MONS_REG  0x06
 #define RV3032_YEARS_REG 0x07
+#define RV3032_STATUS_REG 0x0D
+#define RV3032_TEMP_LSB_REG 0x0E    // Temperature low bits, and also some more status flags
+#define RV3032_CONTROL1_REG 0x10
+#define RV3032_EEADDR_REG   0x3D    // Which EEPROM byte the next EECMD works on
+#define RV3032_EEDATA_REG   0x3E
+#define RV3032_EECMD_REG    0x3F
+#define RV3032_PMU_REG      0xC0    // The config registers from here on are RAM mirrors of the EEPROM
+#define RV3032_CLKOUT2_REG  0xC3
+
+#define RV3032_EECMD_WRITE_BYTE (0x21)      // Write EEDATA into the EEPROM at EEADDR
+#define RV3032_EECMD_READ_BYTE  (0x22)      // Read the EEPROM at EEADDR into EEDATA
+
+#define RV3032_STATUS_PORF (0b00000010)     // Power On Reset Flag. The RTC lost power completely, so the time registers are meaningless.
+#define RV3032_STATUS_VLF  (0b00000001)     // Voltage Low Flag. The supply got low enough that the RTC can not vouch for the time.
+
+#define RV3032_TEMP_LSB_EEBUSY (0b00000100) // EEPROM Busy. Set while the config registers are being refreshed from the EEPROM, including the POR refresh.
+#define RV3032_TEMP_LSB_BSF    (0b00000001) // Backup Switch Flag. The RTC switched over to the backup cap at some point since we last cleared it.
+
+// Everything we say to the RV3032 goes through a batch. Queue up the register reads and writes, then rv3032_batch_run() does them all in one
+// bus session - one i2c_init(), a repeated START between each, and one i2c_shutdown() - so the SDA pull-up is only on while we are really talking.
+//
+// We also keep a RAM shadow of the config registers (CONTROL1 and PMU thru CLKOUT2). These only change when we write them, or when the RTC
+// refreshes them from its EEPROM, which puts back the same values we committed there. A queued write of values the shadow already has gets
+// dropped, and a batch with nothing left in it does not touch the bus at all. The shadow starts out unknown at each boot and fills in from
+// whatever we read or write. The time, status, and EEPROM registers change by themselves, so they are never shadowed.
+
+static const unsigned rv3032_batch_max_ops = 4;         // Most any of our batches needs
+
+struct rv3032_batch_t {
+    i2c_op_t ops[ rv3032_batch_max_ops ];
+    uint8_t count;
+};
 
-// Read the time regs in one transaction
+static uint8_t rv3032_shadow[5];                        // CONTROL1, then PMU, OFFSET, CLKOUT1, CLKOUT2
+static uint8_t rv3032_shadow_known = 0;                 // Bit for each entry in `rv3032_shadow` that we know
 
-void readRV3032time( rv3032_time_block_t *b ) {
+// Where a register lives in `rv3032_shadow`, or -1 if we do not shadow it
 
-    i2c_init();
+static int rv3032_shadow_index( unsigned reg ) {
 
-    i2c_read( RV_3032_I2C_ADDR , RV3032_SECS_REG  , b , sizeof( rv3032_time_block_t ) );
+    if ( reg == RV3032_CONTROL1_REG ) return 0;
 
-    i2c_shutdown();
+    if ( reg >= RV3032_PMU_REG && reg <= RV3032_CLKOUT2_REG ) return 1 + ( reg - RV3032_PMU_REG );
 
+    return -1;
 }
 
+static void rv3032_batch_begin( rv3032_batch_t *batch ) {
+    batch->count = 0;
+}
 
-// Write the time regs in one transacton. Clears the hundreths to zero.
+// Queue a read of `count` registers starting at `reg` into `data`, which has to still be there when the batch runs.
 
-void writeRV3032time( const rv3032_time_block_t *b ) {
+static void rv3032_batch_read( rv3032_batch_t *batch , uint8_t reg , void *data , uint8_t count ) {
 
-    i2c_init();
+    i2c_op_t *op = &batch->ops[ batch->count++ ];
+
+    op->reg = reg;
+    op->count = count | I2C_OP_READ;
+    op->data = data;
+
+}
+
+// Queue a write of `count` registers starting at `reg` from `data`, unless the shadow says they already all have those values.
+// `data` has to still be there when the batch runs.
+
+static void rv3032_batch_write( rv3032_batch_t *batch , uint8_t reg , const void *data , uint8_t count ) {
+
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint8_t i = 0;
+
+    while ( i < count ) {
+        const int shadow_index = rv3032_shadow_index( reg + i );
+        if ( shadow_index < 0 || !( rv3032_shadow_known & ( 1 << shadow_index ) ) || rv3032_shadow[ shadow_index ] != bytes[i] ) break;
+        i++;
+    }
+
+    if ( i == count ) return;           // Nothing new
 
-    i2c_write( RV_3032_I2C_ADDR , RV3032_SECS_REG  , b , sizeof( rv3032_time_block_t ) );
+    i2c_op_t *op = &batch->ops[ batch->count++ ];
 
+    op->reg = reg;
+    op->count = count;
+    op->data = (void *) data;
+
+}
+
+// Do everything in the batch in one bus session and leave it empty again. Returns non-zero if the RV3032 did not ACK something.
+
+static unsigned char rv3032_batch_run( rv3032_batch_t *batch ) {
+
+    if ( batch->count == 0 ) return 0;
+
+    i2c_init();
+    const unsigned char nack = i2c_transfer( RV_3032_I2C_ADDR , batch->ops , batch->count );
     i2c_shutdown();
 
+    if ( nack ) {
+
+        // Some of it did not happen, and we do not know which part
+        rv3032_shadow_known = 0;
+
+    } else {
+
+        for( unsigned o = 0 ; o < batch->count ; o++ ) {
+
+            const i2c_op_t *op = &batch->ops[o];
+            const uint8_t *bytes = (const uint8_t *) op->data;
+            const unsigned count = op->count & ~I2C_OP_READ;
+
+            for( unsigned i = 0 ; i < count ; i++ ) {
+                const int shadow_index = rv3032_shadow_index( op->reg + i );
+                if ( shadow_index >= 0 ) {
+                    rv3032_shadow[ shadow_index ] = bytes[i];
+                    rv3032_shadow_known |= ( 1 << shadow_index );
+                }
+            }
+
+        }
+
+    }
+
+    batch->count = 0;
+
+    return nack;
+}
+
+// Read the time regs in one transaction
+
+void readRV3032time( rv3032_time_block_t *b ) {
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+    rv3032_batch_read( &batch , RV3032_SECS_REG , b , sizeof( rv3032_time_block_t ) );
+    rv3032_batch_run( &batch );
+
+}
+
+
+// Write the time regs in one transacton. Clears the hundreths to zero.
+
+void writeRV3032time( const rv3032_time_block_t *b ) {
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+    rv3032_batch_write( &batch , RV3032_SECS_REG , b , sizeof( rv3032_time_block_t ) );
+    rv3032_batch_run( &batch );
+
 }
 
 // We write this to the RTC at the moment the trigger pin is pulled, so it starts counting up from here.
@@ -427,13 +574,151 @@ uint8_t c2bcd( uint8_t c ) {
 
 }
 
+
+#if TSL_RTC_RECOVERY
+
+#ifdef C2_IS_10K
+    #warning "TSL_RTC_RECOVERY needs the RTC to keep time through a battery swap, but C2_IS_10K boards have backup switchover disabled."
+#endif
+
+// The RV3032 calendar runs from 1/1/00 to 12/31/99 and treats every year divisible by 4 as a leap year (including 00). We reset it to
+// 00:00:00 1/1/00 at launch, so the date is just days since launch, modulo a century.
+
+static const unsigned rv3032_days_per_century = (100 * 365) + 25;
+
+static const uint8_t days_per_month[12] = { 31 , 28 , 31 , 30 , 31 , 30 , 31 , 31 , 30 , 31 , 30 , 31 };
+
+static unsigned rv3032_days_in_month( unsigned year , unsigned month ) {
+    return days_per_month[ month - 1 ] + ( ( month == 2 && ( year % 4 ) == 0 ) ? 1 : 0 );
+}
+
+// Days since 1/1/00 for a date on the RV3032 calendar. Assumes the date has already been range checked.
+
+static unsigned rv3032_days_since_epoch( unsigned year , unsigned month , unsigned date ) {
+
+    unsigned days = ( year * 365 ) + ( ( year + 3 ) / 4 );         // Leap days in all the years before this one, counting 00
+
+    for( unsigned m = 1 ; m < month ; m++ ) {
+        days += rv3032_days_in_month( year , m );
+    }
+
+    return days + ( date - 1 );
+
+}
+
+// Longest we will believe the RTC kept counting on its own past the last checkpoint. If it claims more than this, then it is more
+// likely that it got confused than that the batteries were out for that long, so we go with the checkpoint.
+
+static const unsigned long rtc_recovery_max_gap_mins = 30UL * minutes_per_day;
+
+// Rebuild the exact time since launch from the RTC.
+// `days` and `mins` come in as the persistent checkpoint, which is never ahead of the real time. If the RTC kept time, they go out as
+// the RTC time (in the century that puts it at or just after the checkpoint) along with `secs`, and we return true.
+// If the RTC can not be trusted, we return false and leave everything alone.
+
+bool rv3032_recover_tsl_time( unsigned long *days , unsigned *mins , unsigned *secs ) {
+
+    uint8_t status_reg;
+    rv3032_time_block_t t;
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+    rv3032_batch_read( &batch , RV3032_STATUS_REG , &status_reg , 1 );
+    rv3032_batch_read( &batch , RV3032_SECS_REG , &t , sizeof( rv3032_time_block_t ) );
+    rv3032_batch_run( &batch );
+
+    if ( status_reg & ( RV3032_STATUS_PORF | RV3032_STATUS_VLF ) ) {
+        // RTC lost power (or nearly did) while the batteries were out
+        return false;
+    }
+
+    const unsigned rtc_secs  = bcd2c( t.sec_bcd );
+    const unsigned rtc_mins  = bcd2c( t.min_bcd );
+    const unsigned rtc_hours = bcd2c( t.hour_bcd );
+    const unsigned rtc_date  = bcd2c( t.date_bcd );
+    const unsigned rtc_month = bcd2c( t.month_bcd );
+    const unsigned rtc_year  = bcd2c( t.year_bcd );
+
+    // Check everything before we use it as an index. Garbage here means the RTC is not what we think it is.
+
+    if ( rtc_secs > 59 || rtc_mins > 59 || rtc_hours > 23 || rtc_year > 99 || rtc_month < 1 || rtc_month > 12 || rtc_date < 1 || rtc_date > rv3032_days_in_month( rtc_year , rtc_month ) ) {
+        return false;
+    }
+
+    const unsigned rtc_mins_of_day = ( rtc_hours * minutes_per_hour ) + rtc_mins;
+
+    // Find the first RTC century that puts us at or after the checkpoint
+
+    unsigned long recovered_days = ( ( *days / rv3032_days_per_century ) * rv3032_days_per_century ) + rv3032_days_since_epoch( rtc_year , rtc_month , rtc_date );
+
+    if ( recovered_days < *days || ( recovered_days == *days && rtc_mins_of_day < *mins ) ) {
+        recovered_days += rv3032_days_per_century;
+    }
+
+    const unsigned long gap_mins = ( ( ( recovered_days - *days ) * minutes_per_day ) + rtc_mins_of_day ) - *mins;
+
+    if ( gap_mins > rtc_recovery_max_gap_mins ) {
+        return false;
+    }
+
+    *days = recovered_days;
+    *mins = rtc_mins_of_day;
+    *secs = rtc_secs;
+
+    return true;
+
+}
+
+// Set the RTC to a time since launch and clear the status flags so it will be trusted next time we boot. Used when the RTC lost track
+// while the batteries were out. Note that writing the time also resets the RTC's sub-second counter.
+
+void rv3032_set_tsl_time( unsigned long days , unsigned mins , unsigned secs ) {
+
+    unsigned day_of_century = days % rv3032_days_per_century;
+
+    unsigned year = 0;
+
+    while ( day_of_century >= ( ( year % 4 ) == 0 ? 366U : 365U ) ) {
+        day_of_century -= ( ( year % 4 ) == 0 ? 366U : 365U );
+        year++;
+    }
+
+    unsigned month = 1;
+
+    while ( day_of_century >= rv3032_days_in_month( year , month ) ) {
+        day_of_century -= rv3032_days_in_month( year , month );
+        month++;
+    }
+
+    rv3032_time_block_t t;
+
+    t.sec_bcd     = c2bcd( secs );
+    t.min_bcd     = c2bcd( mins % minutes_per_hour );
+    t.hour_bcd    = c2bcd( mins / minutes_per_hour );
+    t.weekday_bcd = ( 1 + days ) % 7;                   // Launch was a weekday 1 (see `rv_3032_time_block_init`)
+    t.date_bcd    = c2bcd( day_of_century + 1 );
+    t.month_bcd   = c2bcd( month );
+    t.year_bcd    = c2bcd( year );
+
+    const uint8_t status_reg = 0x00;
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+    rv3032_batch_write( &batch , RV3032_SECS_REG , &t , sizeof( rv3032_time_block_t ) );
+    rv3032_batch_write( &batch , RV3032_STATUS_REG , &status_reg , 1 );
+    rv3032_batch_run( &batch );
+
+}
+
+#endif
+
 // Tell compiler/linker to put this in "info memory" that we set up in the linker file to live at 0x1800
 // This area of memory never gets overwritten, not by power cycle and not by downloading a new binary image into program FRAM.
 persistent_data_t __attribute__(( __section__(".persistant") )) persistent_data;
 
-// Here we pull out the address of the mins counter in the persistent data structure for no other reason than to pass it to the ASM
-// code. We have to do this because the ASM code can not get this address directly since the assembler seems to choke on nested structs.
-volatile unsigned *persistant_mins_ptr = &persistent_data.mins;
+// Which counter slot TSL_MODE_BEGIN should start counting in. main() sets this right before we start TSL mode.
+// The ASM finds the slot itself from the offsets in persistent_offsets.h.
+unsigned tsl_counter_slot;
 
 // Note that we do *not* need the password here. This fact is hidden in a hard find footnote in 1.16.2.1 in the application manual "These bits have no affect on MSP430FR413x, MSP430FR203x devices."
 inline void unlock_persistant_data() {
@@ -444,62 +729,320 @@ inline void lock_persistant_data() {
     SYSCFG0 |= DFWP;                      // 1b = Data (Information) FRAM write protected (not writable). Compiles to a single instruction.
 }
 
+// The CRC that goes in a counter slot. Must match what TSL_MODE_ISR does at midnight.
+
+unsigned persistent_slot_crc( unsigned long days , unsigned seq ) {
+    CRCINIRES = PERSISTENT_SLOT_CRC_SEED;
+    CRCDI = (unsigned) days;
+    CRCDI = (unsigned) ( days >> 16 );
+    CRCDI = seq;
+    return CRCINIRES;
+}
+
+// The CRC of our whole program FRAM, for `image_crc`. The programming station computes the same thing from the image
+// (persistent_time.image_crc()), so if they match then the write was good and it does not have to read it all back.
+// About 8K words, so ~50ms at 1MHz. Only done once, on the first boot after programming.
+
+unsigned program_fram_crc() {
+    CRCINIRES = PERSISTENT_IMAGE_CRC_SEED;
+    const unsigned *p = (const unsigned *) PERSISTENT_IMAGE_CRC_START;
+    for( unsigned n = PERSISTENT_IMAGE_CRC_WORDS ; n ; n-- ) {
+        CRCDI = *p++;
+    }
+    return CRCINIRES;
+}
+
+// Returns the counter slot that holds the current time since launch, or NULL if neither slot is valid (we have never launched, or
+// we were launched by firmware that used the legacy fields).
+// Normally the two seqs are one apart. The signed difference keeps that working when they wrap around (which takes ~180 years).
+
+persistent_counter_slot_t *persistent_newest_slot() {
+
+    persistent_counter_slot_t *newest = NULL;
+
+    for( persistent_counter_slot_t *slot = persistent_data.counter_slots ; slot < persistent_data.counter_slots + 2 ; slot++ ) {
+
+        if ( slot->crc == persistent_slot_crc( slot->days , slot->seq ) ) {
+
+            if ( newest == NULL || (int) ( slot->seq - newest->seq ) > 0 ) {
+                newest = slot;
+            }
+
+        }
+    }
+
+    return newest;
+}
+
+// Atomically replace the persistent time since launch the same way TSL_MODE_ISR does at midnight - write the other slot, then commit it by writing its seq.
+
+void commit_persistent_time( unsigned long days , unsigned mins ) {
+
+    persistent_counter_slot_t *newest = persistent_newest_slot();
+
+    persistent_counter_slot_t *slot = &persistent_data.counter_slots[0];
+    unsigned seq = 0;
+
+    if ( newest != NULL ) {
+        slot = ( newest == &persistent_data.counter_slots[0] ) ? &persistent_data.counter_slots[1] : &persistent_data.counter_slots[0];
+        seq = newest->seq + 1;
+    }
+
+    const unsigned crc = persistent_slot_crc( days , seq );
+
+    unlock_persistant_data();
+    slot->mins = mins;
+    slot->days = days;
+    slot->crc = crc;
+    slot->seq = seq;                // Commit. Until this lands, `newest` is still the newest.
+    lock_persistant_data();
+}
+
+// Sleep in LPM3 for one tick of the watchdog interval timer running off the VLO, which is ~50ms (512 ticks at ~10KHz).
+// We use this rather than __delay_cycles() so we are not burning active current while we wait for the RV3032.
+// The VLO is already running for the LCD, so this costs us nothing extra.
+
+#pragma vector = WDT_VECTOR
+__interrupt void rv3032_wait_isr(void) {
+    __bic_SR_register_on_exit( LPM3_bits | GIE );       // Wake up and come back with interrupts off again
+}
+
+static void rv3032_wait_tick() {
+
+    SFRIFG1 &= ~WDTIFG;
+    SFRIE1 |= WDTIE;
+    WDTCTL = WDTPW | WDTSSEL__VLO | WDTTMSEL | WDTCNTCL | WDTIS__512;   // Interval mode, starting from zero
+
+    __bis_SR_register( LPM3_bits | GIE );
+
+    WDTCTL = WDTPW | WDTHOLD | WDTSSEL__VLO;                            // Back to how main() left it
+    SFRIE1 &= ~WDTIE;
+    SFRIFG1 &= ~WDTIFG;
+
+}
+
+// Worst case we wait about as long as the fixed delay we used to have, and then try anyway.
+
+static const unsigned rv3032_ready_max_ticks = 24;      // 24 * ~50ms = ~1.2s
+
+// The config we want the RV3032 to run with.
+
+//static const uint8_t rv3032_clkout2_reg = 0b00000000;      // CLKOUT XTAL low freq mode, freq=32768Hz
+//static const uint8_t rv3032_clkout2_reg = 0b00100000;      // CLKOUT XTAL low freq mode, freq=1024Hz
+static const uint8_t rv3032_clkout2_reg = 0b01100000;        // CLKOUT XTAL low freq mode, freq=1Hz
+
+// Note that turning off backup switch-over seems to save ~0.1uA
+//static const uint8_t rv3032_pmu_reg = 0b01000001;         // CLKOUT off, backup switchover disabled, no charge pump, 1K OHM trickle resistor, trickle charge Vbackup to Vdd.
+//static const uint8_t rv3032_pmu_reg = 0b01010000;         // CLKOUT off, Direct backup switching mode, no charge pump, 0.6K OHM trickle resistor, trickle charge Vbackup to Vdd. Only predicted to use 50nA more than disabled.
+//static const uint8_t rv3032_pmu_reg = 0b01100001;         // CLKOUT off, Level backup switching mode (2v) , no charge pump, 1K OHM trickle resistor, trickle charge Vbackup to Vdd. Predicted to use ~200nA more than disabled because of voltage monitor.
+//static const uint8_t rv3032_pmu_reg = 0b01000000;         // CLKOUT off, Other disabled backup switching mode, no charge pump, trickle resistor off, trickle charge Vbackup to Vdd
+
+#ifdef C2_IS_10K
+    static const uint8_t rv3032_pmu_reg = 0b00000000;       // CLKOUT ON, backup switching disabled
+#else
+    static const uint8_t rv3032_pmu_reg = 0b00011101;       // CLKOUT ON, Direct backup switching mode, no charge pump, 12K OHM trickle resistor, trickle charge Vbackup to Vdd.
+#endif
+
+static const uint8_t rv3032_control1_reg = 0b00000100;      // TE=0 so no periodic timer interrupt, EERD=1 to disable automatic EEPROM refresh while we are messing with the config.
+
+// The part of that config that lives in the RV3032's EEPROM. We write this into the EEPROM once at commissioning, and from then on the RTC loads it
+// into the config registers by itself every time it powers up, before we are even running. CONTROL1 is not in the EEPROM.
+// In the order we write them. CLKOUT2 goes first so CLKOUT never comes on at the wrong frequency.
+
+struct rv3032_profile_reg_t {
+    uint8_t addr;
+    uint8_t value;
+};
+
+static const rv3032_profile_reg_t rv3032_profile[] = {
+    { RV3032_CLKOUT2_REG , rv3032_clkout2_reg },
+    { RV3032_PMU_REG     , rv3032_pmu_reg     },
+};
+
+static const unsigned rv3032_profile_count = sizeof( rv3032_profile ) / sizeof( rv3032_profile[0] );
+
+// CRC of the profile with these values, for `rtc_profile_crc`.
+
+static unsigned rv3032_profile_crc_of( const uint8_t *values ) {
+    CRCINIRES = PERSISTENT_RTC_PROFILE_CRC_SEED;
+    for( unsigned i = 0 ; i < rv3032_profile_count ; i++ ) {
+        CRCDI = ( rv3032_profile[i].addr << 8 ) | values[i];
+    }
+    return CRCINIRES;
+}
+
+unsigned rv3032_profile_crc() {
+    uint8_t values[ rv3032_profile_count ];
+    for( unsigned i = 0 ; i < rv3032_profile_count ; i++ ) {
+        values[i] = rv3032_profile[i].value;
+    }
+    return rv3032_profile_crc_of( values );
+}
+
+// Is the RTC already going to come up with our config by itself?
+// Only once we are commissioned - before that, the first boot power test switches CLKOUT to 64Hz, and the RTC can ride through on the backup cap
+// into the commissioning boot still running that way.
+
+static bool rv3032_profile_committed() {
+    return persistent_data.commisisoned_flag == 0x01 && persistent_data.rtc_profile_crc == rv3032_profile_crc();
+}
+
 // Initialize RV3032 for the first time
 // sets clkout to 1Hz
 // disables backup capacitor
 // disabled the automatic refresh of config registers from EEPROM.
 // Does not enable any interrupts
+// Once the profile is in the RV3032's EEPROM, it only waits for the RTC to be ready.
 
 // Note that we use CLKOUT at 1Hz rather than using a 1 sec periodic timer because the periodic timer uses *much* more power all the time on the RTC 9not documented!) and slightly more power on the MCU because it is open collector pulling on a pull-up resistor.
 // It would have been slightly nice to set the periodic timer to 2Hz and then interrupt on both edges. :/
 
 void rv3032_init() {
 
-    // Give the RV3230 a chance to wake up before we start pounding it.
-    // POR refresh time(1) At power up ~66ms
-    // Also there is Tdeb which is the time it takes to recover from a backup switch over back to Vcc. It is unclear if this is 1ms or 1000ms so lets be safe.
-    __delay_cycles(1100000);    // 1 sec +/-10% (we are running at 1Mhz)
+    // Wait for the RV3230 to be ready before we start pounding it.
+    // After a power up, it does not answer on the bus until the POR refresh (~66ms) is done, and then EEbusy stays set until the config registers
+    // have been loaded from the EEPROM. If it was still running when we booted (like a quick battery swap where it rode through on the backup cap)
+    // then it answers right away and we do not wait at all.
+    // This used to be a fixed 1.1 sec __delay_cycles() at full active current on every boot.
 
-    // Initialize our i2c pins as pull-up
-    i2c_init();
+    uint8_t status_regs[2] = { 0 , 0 };     // RV3032_STATUS_REG, RV3032_TEMP_LSB_REG. Stays 0 (no BSF) if the RTC never answers.
+    unsigned ticks = 0;
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
 
+    while (1) {
 
-    // Set all the registers we care about that can get reset by either power-on-reset or recover from backup
-    //uint8_t clkout2_reg = 0b00000000;        // CLKOUT XTAL low freq mode, freq=32768Hz
-    //uint8_t clkout2_reg = 0b00100000;        // CLKOUT XTAL low freq mode, freq=1024Hz
-    uint8_t clkout2_reg = 0b01100000;        // CLKOUT XTAL low freq mode, freq=1Hz
-    i2c_write( RV_3032_I2C_ADDR , 0xc3 , &clkout2_reg , 1 );
+        rv3032_batch_read( &batch , RV3032_STATUS_REG , status_regs , sizeof( status_regs ) );
+        const unsigned char nack = rv3032_batch_run( &batch );
 
-    // First control reg. Note that turning off backup switch-over seems to save ~0.1uA
-    //uint8_t pmu_reg = 0b01000001;         // CLKOUT off, backup switchover disabled, no charge pump, 1K OHM trickle resistor, trickle charge Vbackup to Vdd.
-    //uint8_t pmu_reg = 0b01010000;          // CLKOUT off, Direct backup switching mode, no charge pump, 0.6K OHM trickle resistor, trickle charge Vbackup to Vdd. Only predicted to use 50nA more than disabled.
-    //uint8_t pmu_reg = 0b01100001;         // CLKOUT off, Level backup switching mode (2v) , no charge pump, 1K OHM trickle resistor, trickle charge Vbackup to Vdd. Predicted to use ~200nA more than disabled because of voltage monitor.
-    //uint8_t pmu_reg = 0b01000000;         // CLKOUT off, Other disabled backup switching mode, no charge pump, trickle resistor off, trickle charge Vbackup to Vdd
+        if ( !nack && !( status_regs[1] & RV3032_TEMP_LSB_EEBUSY ) ) break;
 
-    #ifdef C2_IS_10K
-        uint8_t pmu_reg = 0b00000000;          // CLKOUT ON, backup switching disabled
-    #else
-        uint8_t pmu_reg = 0b00011101;        // CLKOUT ON, Direct backup switching mode, no charge pump, 12K OHM trickle resistor, trickle charge Vbackup to Vdd.
-    #endif
-    i2c_write( RV_3032_I2C_ADDR , 0xc0 , &pmu_reg , 1 );
+        if ( ticks == rv3032_ready_max_ticks ) break;       // Give up waiting and try anyway, same as we always used to
 
-    uint8_t control1_reg = 0b00000100;      // TE=0 so no periodic timer interrupt, EERD=1 to disable automatic EEPROM refresh (why would you want that?).
-    i2c_write( RV_3032_I2C_ADDR , 0x10 , &control1_reg , 1 );
+        rv3032_wait_tick();
+        ticks++;
 
-    i2c_shutdown();
+    }
+
+    // There is also Tdeb, which is the time it takes to recover from a backup switch-over back to Vcc. It is unclear if this is 1ms or 1000ms,
+    // but we only need to worry about it if there actually was a switch-over, which BSF tells us. We give it one tick and then clear the flag so we do not wait for it again next boot.
+    // Note we leave PORF and VLF alone since rv3032_recover_tsl_time() needs to see those.
+
+    if ( status_regs[1] & RV3032_TEMP_LSB_BSF ) {
+        rv3032_wait_tick();
+    }
+
+    const uint8_t temp_lsb_reg = 0;                     // Clears BSF (and CLKF and EEF, which we do not use). The temperature bits are read only.
+
+    if ( status_regs[1] & RV3032_TEMP_LSB_BSF ) {
+        rv3032_batch_write( &batch , RV3032_TEMP_LSB_REG , &temp_lsb_reg , 1 );
+    }
+
+    if ( rv3032_profile_committed() ) {
+
+        // The RTC loaded our config from its EEPROM when it powered up, and nobody has changed it since we were commissioned. We leave CONTROL1
+        // alone here. CONTROL1 is not in the EEPROM, so EERD is whatever it was: still 1 from the commissioning boot if the RTC has kept running since,
+        // or its power up default of 0 (the RTC refreshes the config registers from the EEPROM once a day by itself) if the RTC has been reset since.
+        // Either way the config registers already hold the profile.
+
+        rv3032_batch_run( &batch );
+        return;
+
+    }
+
+    // Set all the registers we care about that can get reset by either power-on-reset or recover from backup, but only the ones
+    // that are not already right. If the RTC kept running then usually none of them are.
+    // Reading them puts them in the shadow, so then the writes only go out for the ones that are different.
+
+    uint8_t config_regs[4];         // PMU, OFFSET, CLKOUT1, CLKOUT2
+    uint8_t control1_current;
+
+    rv3032_batch_read( &batch , RV3032_PMU_REG , config_regs , sizeof( config_regs ) );
+    rv3032_batch_read( &batch , RV3032_CONTROL1_REG , &control1_current , 1 );
+    rv3032_batch_run( &batch );
+
+    rv3032_batch_write( &batch , RV3032_CLKOUT2_REG , &rv3032_clkout2_reg , 1 );
+    rv3032_batch_write( &batch , RV3032_PMU_REG , &rv3032_pmu_reg , 1 );
+    rv3032_batch_write( &batch , RV3032_CONTROL1_REG , &rv3032_control1_reg , 1 );
+    rv3032_batch_run( &batch );
+
+}
+
+// Wait for an EEPROM command to finish. Each byte takes a few ms to write, so normally this is one tick. The bus is off while we wait.
+
+static void rv3032_eeprom_wait() {
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+
+    for( unsigned ticks = 0 ; ticks < rv3032_ready_max_ticks ; ticks++ ) {
+
+        rv3032_wait_tick();
+
+        uint8_t temp_lsb_reg;
+        rv3032_batch_read( &batch , RV3032_TEMP_LSB_REG , &temp_lsb_reg , 1 );
+        rv3032_batch_run( &batch );
+
+        if ( !( temp_lsb_reg & RV3032_TEMP_LSB_EEBUSY ) ) break;
+
+    }
+
+}
+
+// Write our config profile into the RV3032's EEPROM, then read it back out of the EEPROM and return the CRC of what we got.
+// That matches rv3032_profile_crc() if it worked. A failed write (EEF) shows up here too, since the EEPROM will not hold what we wrote. Only call after rv3032_init(), which sets EERD=1 so the RTC does not
+// start its own refresh in the middle of this.
+// Only done once, at commissioning. The EEPROM is only good for ~100K writes, so we do not want to do this on every boot anyway.
+
+unsigned rv3032_commit_profile() {
+
+    uint8_t readback[ rv3032_profile_count ];
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+
+    const uint8_t write_cmd = RV3032_EECMD_WRITE_BYTE;
+    const uint8_t read_cmd = RV3032_EECMD_READ_BYTE;
+
+    for( unsigned i = 0 ; i < rv3032_profile_count ; i++ ) {
+
+        const uint8_t addr_data[2] = { rv3032_profile[i].addr , rv3032_profile[i].value };     // EEADDR, EEDATA
+        rv3032_batch_write( &batch , RV3032_EEADDR_REG , addr_data , sizeof( addr_data ) );
+        rv3032_batch_write( &batch , RV3032_EECMD_REG , &write_cmd , 1 );
+        rv3032_batch_run( &batch );
+
+        rv3032_eeprom_wait();
 
+    }
+
+    for( unsigned i = 0 ; i < rv3032_profile_count ; i++ ) {
+
+        rv3032_batch_write( &batch , RV3032_EEADDR_REG , &rv3032_profile[i].addr , 1 );
+        rv3032_batch_write( &batch , RV3032_EECMD_REG , &read_cmd , 1 );
+        rv3032_batch_run( &batch );
+
+        rv3032_eeprom_wait();
+
+        rv3032_batch_read( &batch , RV3032_EEDATA_REG , &readback[i] , 1 );
+        rv3032_batch_run( &batch );
+
+    }
+
+    return rv3032_profile_crc_of( readback );
 }
 
 // Switch the CLKOUT from 1Hz to 64Hz
 
 void rv3032_switchto_64Hz() {
-    // Initialize our i2c pins as pull-up
-    i2c_init();
 
-    uint8_t clkout2_reg = 0b01000000;        // CLKOUT XTAL low freq mode, freq=64Hz
-    i2c_write( RV_3032_I2C_ADDR , 0xc3 , &clkout2_reg , 1 );
+    const uint8_t clkout2_reg = 0b01000000;        // CLKOUT XTAL low freq mode, freq=64Hz
+
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+    rv3032_batch_write( &batch , RV3032_CLKOUT2_REG , &clkout2_reg , 1 );
+    rv3032_batch_run( &batch );
 
-    i2c_shutdown();
 }
 
 
@@ -507,24 +1050,26 @@ void rv3032_switchto_64Hz() {
 
 void rv3032_shutdown() {
 
-    i2c_init();
-
-    uint8_t pmu_reg = 0b01000000;         // CLKOUT off, backup switchover disabled, no charge pump
-    i2c_write( RV_3032_I2C_ADDR , 0xc0 , &pmu_reg , 1 );
+    const uint8_t pmu_reg = 0b01000000;         // CLKOUT off, backup switchover disabled, no charge pump
 
-    i2c_shutdown();
+    rv3032_batch_t batch;
+    rv3032_batch_begin( &batch );
+    rv3032_batch_write( &batch , RV3032_PMU_REG , &pmu_reg , 1 );
+    rv3032_batch_run( &batch );
 
 }
 
 // During time-since-launch mode, this is how long we have been counting.
 // These are global so we can easily share them into the ASM code (If we passed via the call convention then we'd have to mess around with the stack).
 // Note that the ASM code only takes a snapshot of these into registers and then uses the registers for canonical storage.
-// Note that there is no `tsl_days` variable, the `days_digits[]` are the canonical storage for the running day count, and these are only ever updated
-// in C inside `tsl_next_day()`
+// Note that there is no `tsl_days` variable. The ASM keeps days % 100 as a pointer into `days_lcd_words` and the rest in `tsl_days_hundreds_bcd`,
+// and does the whole day rollover itself (including the persistent data transaction).
 
 unsigned tsl_secs=0;
 unsigned tsl_mins=0;
 unsigned tsl_hours=0;
+unsigned tsl_days_ones_tens=0;
+unsigned tsl_days_hundreds_bcd=0;
 
 //**** INTERRUPT STUFFS
 
@@ -579,27 +1124,36 @@ __interrupt void trigger_isr(void) {
 
         // Do the actual launch, which will...
         // 1. Read the current RTC time and save it to FRAM
-        // 2. Set the launchflag in FRAM so we will forevermore know that we did launch already.
-        // 3. Reset the current RTC time to midnight 1/1/00.
+        // 2. Reset the current RTC time to midnight 1/1/00.
+        // 3. Set the launchflag in FRAM so we will forevermore know that we did launch already.
+        // 1 and 2 are one bus session, so the RTC starts counting from as close to the pull as we can get it.
 
-        // Initialize our i2c pins as pull-up
-        i2c_init();
+        rv3032_batch_t batch;
+        rv3032_batch_begin( &batch );
 
-        unlock_persistant_data();
         // First get current time and save it to FRAM for archival purposes.
-        i2c_read( RV_3032_I2C_ADDR , RV3032_SECS_REG  , (void *)  &persistent_data.launched_time , sizeof( rv3032_time_block_t ) );
-        // Also update the persistent storage to reflect that we launched now.
-        persistent_data.mins=0;
-        persistent_data.days=0;
-        persistent_data.update_flag=0;
-        persistent_data.launched_flag=0x01;
-        lock_persistant_data();
+        rv3032_batch_read( &batch , RV3032_SECS_REG , (void *) &persistent_data.launched_time , sizeof( rv3032_time_block_t ) );
 
         // Then zero out the RTC to start counting over again, starting now. Note that writing any value to the seconds register resets the sub-second counters to the beginning of the second.
         // "Writing to the Seconds register creates an immediate positive edge on the LOW signal on CLKOUT pin."
-        i2c_write( RV_3032_I2C_ADDR , RV3032_SECS_REG  , &rv_3032_time_block_init , sizeof( rv3032_time_block_t ) );
+        rv3032_batch_write( &batch , RV3032_SECS_REG , &rv_3032_time_block_init , sizeof( rv3032_time_block_t ) );
+
+        #if TSL_RTC_RECOVERY
+            // Clear the power on reset and low voltage flags from when the batteries first went in, so from now on they only get set if the RTC really loses time.
+            const uint8_t status_reg = 0x00;
+            rv3032_batch_write( &batch , RV3032_STATUS_REG , &status_reg , 1 );
+        #endif
 
-        i2c_shutdown();
+        unlock_persistant_data();           // The read goes straight into FRAM
+        rv3032_batch_run( &batch );
+        lock_persistant_data();
+
+        // Also update the persistent storage to reflect that we launched now.
+        commit_persistent_time( 0 , 0 );
+
+        unlock_persistant_data();
+        persistent_data.launched_flag=0x01;
+        lock_persistant_data();
 
         // Note that the tsl_* variables will already be initialized to zero from power up
 
@@ -617,9 +1171,10 @@ __interrupt void trigger_isr(void) {
         flash();
 
         // Start ticking from... now!
-        // (We rely on the secs, mins, hours, and days_digits[] all having been init'ed to zeros.)
+        // (We rely on the tsl_* variables all having been init'ed to zeros.)
 
         // Begin TSL mode on next tick
+        lcd_tsl_blink_mode();
         SET_CLKOUT_VECTOR( &TSL_MODE_BEGIN );
 
     }
@@ -750,8 +1305,9 @@ __interrupt void startup_isr(void) {
 }
 
 // Hard earned everlasting sleep
+// TSL_MODE_ISR calls this when the days roll over to 1,000,000. Since it is called from ASM, we need the `extern "C"` to keep the name from getting mangled.
 
-void long_now_mode() {
+extern "C" void long_now_mode() {
 
     lcd_show_long_now();
     blinkforeverandever();
@@ -761,105 +1317,6 @@ void long_now_mode() {
 }
 
 
-
-
-
-// Spread the 6 day counter digits out to minimize superfluous digit updates and avoid mod and div operations.
-// These are set either when trigger is pulled or on power up after a battery change.
-// day_digits[0] is the ones digit, day_digits[5] is the 100 thousands digit.
-
-unsigned days_digits[6];
-
-
-// Called by the ASM TSL_MODE_ISR when it rolls over from 23:59:59 to 00:00:00
-// Since it is called from ASM, we need the `extern "C"` to keep the name from getting mangled.
-
-extern "C" void tsl_new_day() {
-
-    unsigned long days = persistent_data.days;          // Copy to a local variable for faster access (the persistent variable is volatile)
-
-    // Update the count in persistent data to reflect that yet another day has passed.
-    unlock_persistant_data();
-    persistent_data.backup_mins=persistent_data.mins;
-    persistent_data.backup_days=days;
-    persistent_data.update_flag = 1;                // BEGIN TRANSACTION
-    persistent_data.mins = 0;                       // We hard set the mins to zero. It should be at 24*60 when we get here.
-    days++;
-    persistent_data.days = days;
-    persistent_data.update_flag = 0;                // END TRANSACTION
-    lock_persistant_data();
-
-
-    if ((days &  ~127) == days ) {
-
-        lcd_save_screen_buffer_t lcd_screen_save_buffer;
-        lcd_save_screen(&lcd_screen_save_buffer);
-        lcd_show_centesimus_dies_message();
-        // Switch the MCU over to the very slow ~10KHz VLO clock. Things will take forever, but low power.
-        CSCTL4 = SELMS__VLOCLK;
-        __delay_cycles(5000UL);         // Pause for about half a second
-        // Switch the MCU back to DCO clock which uses more power per time, but more than compensates for it by getting even more done per time.
-        CSCTL4 = 0;
-        lcd_restore_screen(&lcd_screen_save_buffer);
-
-    }
-
-    // Update the actual display to reflect the new day
-    // We could have done this with meta code in a template, but I think that would have been even uglier! At least this is clear.
-
-    days_digits[0]++;
-
-    if (days_digits[0] == 10 ) {
-
-        days_digits[0]=0x00;
-
-        days_digits[1]++;
-
-        if (days_digits[1] == 10 ) {
-
-            days_digits[1]=0x00;
-
-            days_digits[2]++;
-
-            if (days_digits[2] == 10 ) {
-
-                days_digits[2]=0x00;
-
-                days_digits[3]++;
-
-                if (days_digits[3] == 10 ) {
-
-                    days_digits[3]=0x00;
-
-                    days_digits[4]++;
-
-                    if (days_digits[4] == 10 ) {
-
-                        days_digits[4]=0x00;
-
-                        days_digits[5]++;
-
-                        if (days_digits[5] == 10 ) {
-
-                            // If we get here then we just passed 1 million days, so go into long now mode.
-                            long_now_mode();
-                            // unreachable
-
-                        }
-                        lcd_show_digit_f( 11 , days_digits[5] );
-                    }
-                    lcd_show_digit_f( 10 , days_digits[4] );
-                }
-                lcd_show_digit_f(  9 , days_digits[3] );
-            }
-            lcd_show_digit_f(  8 , days_digits[2] );
-        }
-        lcd_show_digit_f(  7 , days_digits[1] );
-    }
-    lcd_show_digit_f(  6 , days_digits[0] );
-}
-
-
 // Reference version of the ready to launch animation. This has been replaced with optimized ASM in tsl_asm.asm
 void ready_to_launch_reference() {
     // We depend on the trigger ISR to move us from ready-to-launch to time-since-launch
@@ -1218,6 +1675,66 @@ void trigger_pin_test() {
 }
 
 
+
+// LCD drive characterization. Steps through the drive profiles that are safe on this board, `lcd_drive_sweep_seconds` each, forever, so a
+// long EnergyTrace or bench capture has every profile in it a few times. Each profile starts right after a tick with a marker: the CPU on at
+// full current for (index+1) * 10ms, which stands way out of the ~2uA around it, so programming/lcd_sweep.py can find where each profile
+// starts and which one it is. The screen shows the profile index on the right and 8's everywhere else so you can check every segment for
+// flicker and contrast. The CPU still wakes on every tick like in TSL mode, so the numbers compare to the `Current Usage` table.
+// Never returns.
+
+static const unsigned lcd_drive_sweep_seconds = 60;
+
+// Wakes lcd_drive_sweep() on each tick
+
+__interrupt void lcd_drive_sweep_isr(void) {
+    CBI( RV3032_CLKOUT_PIFG , RV3032_CLKOUT_B );        // Clear pending interrupt from CLKOUT
+    __bic_SR_register_on_exit( LPM4_bits );
+}
+
+#pragma FUNC_NEVER_RETURNS
+void lcd_drive_sweep() {
+
+    SET_CLKOUT_VECTOR( &lcd_drive_sweep_isr );
+    ACTIVATE_RAM_ISRS();
+
+    CBI( RV3032_CLKOUT_PIFG     , RV3032_CLKOUT_B    );
+    SBI( RV3032_CLKOUT_PIE      , RV3032_CLKOUT_B    );
+
+    __bis_SR_register( LPM4_bits | GIE );                  // Start on a tick
+
+    while (1) {
+
+        for ( unsigned profile = 0 ; profile < lcd_drive_sweep_count ; profile++ ) {
+
+            DEBUG_PULSE_ON();
+            for ( unsigned i = 0 ; i <= profile ; i++ ) {
+                __delay_cycles( 10000 );                    // ~10ms at ~245uA
+            }
+            DEBUG_PULSE_OFF();
+
+            LCDCTL0 &= ~LCDON;
+            lcd_set_drive( profile );
+            LCDCTL0 |= LCDON;
+
+            lcd_show_drive_sweep_message( profile );
+
+            for ( unsigned s = 0 ; s < lcd_drive_sweep_seconds ; s++ ) {
+                __bis_SR_register( LPM4_bits | GIE );
+            }
+        }
+    }
+}
+
+// Wait for any CLKOUT transition and then clear the pending interrupt, so we know we have ~500ms until the next transition and the
+// next rising edge we see is a whole new second. This should always take <500ms. It also proves the RV3032 is running and we are connected on CLKOUT.
+
+static void rv3032_clkout_sync() {
+    unsigned start_val = TBI( RV3032_CLKOUT_PIN, RV3032_CLKOUT_B );
+    while (TBI( RV3032_CLKOUT_PIN, RV3032_CLKOUT_B )==start_val); // wait for any transition
+    CBI( RV3032_CLKOUT_PIFG     , RV3032_CLKOUT_B    );
+}
+
 int main( void )
 {
 
@@ -1256,13 +1773,32 @@ int main( void )
 
     // TEST CODE GOES HERE
 
+    // A bench unit set up for the LCD drive sweep never commissions or launches
+    if ( persistent_data.lcd_drive_profile == ( PERSISTENT_LCD_DRIVE_KEY | PERSISTENT_LCD_DRIVE_SWEEP ) ) {
+
+        // The programming station still waits for our image CRC like for any other unit, so give it that much of the first start up.
+        // We leave `initalized_flag` alone since this unit never goes on to commission.
+        if (persistent_data.initalized_flag!=0x01) {
+            const unsigned image_crc = program_fram_crc();
+            unlock_persistant_data();
+            persistent_data.image_crc=image_crc;
+            lock_persistant_data();
+        }
+
+        lcd_drive_sweep();
+    }
+
     if (persistent_data.initalized_flag!=0x01) {
 
         // This is the first time we have ever powered up
 
+        // Check our own image. The programming station is waiting to read this back (it wrote the complement of what it expects here, so it can tell we
+        // have not got this far yet from a bad write).
+        const unsigned image_crc = program_fram_crc();
 
         // Now remember that we did our start up. From now on, the RTC will run on its own forever.
         unlock_persistant_data();
+        persistent_data.image_crc=image_crc;
         persistent_data.tsl_powerup_count=0;
         persistent_data.commisisoned_flag=0xff;           // Ready for next step in setup sequence
         persistent_data.initalized_flag=0x01;             // Remember that we already started up once and never do it again.
@@ -1273,6 +1809,9 @@ int main( void )
         // We never return from this, but we will be able to check the results in FRAM next time we are powered up.
 
 
+        // Show the CRC while we flash, so you can check a unit against the image by eye too.
+        lcd_show_crc_message( image_crc );
+
         // Flash the LEDs to prove they work.
         flash();
 
@@ -1293,6 +1832,8 @@ int main( void )
     }
     lock_persistant_data();
 
+    bool clkout_synced = false;     // Set once we have lined up with a CLKOUT transition, see below
+
     if ( persistent_data.commisisoned_flag != 0x01 ) {
 
         // First lets check how long we stayed alive after the power was pulled when we were first programmed. This helps to weed out any units that
@@ -1337,6 +1878,16 @@ int main( void )
         // These wall-clock time values are only used for logging and diagnostics.
         writeRV3032time(&persistent_data.programmed_time);
 
+        // Put our RTC config into the RV3032's EEPROM, so from now on it comes up with it by itself after any power loss (see rv3032_init()).
+        // We keep whatever CRC we read back. If it does not match then rv3032_init() just keeps setting up the registers on every boot like it always
+        // did, and we try again if we come through here again.
+        if ( persistent_data.rtc_profile_crc != rv3032_profile_crc() ) {
+            const unsigned rtc_profile_crc = rv3032_commit_profile();
+            unlock_persistant_data();
+            persistent_data.rtc_profile_crc = rtc_profile_crc;
+            lock_persistant_data();
+        }
+
         // Make sure that the trigger pin is inserted because
         // we would not want to just launch because the pin was out when batteries were inserted.
         // This also lets us test both trigger positions during commissioning at the factory.
@@ -1398,47 +1949,78 @@ int main( void )
         unsigned retrieved_mins;
         unsigned long retrieved_days;
 
-        // First check if there was an update in progress when we lost power
+        persistent_counter_slot_t *newest = persistent_newest_slot();
 
-        if (persistent_data.update_flag) {
+        if ( newest != NULL ) {
 
-            // We somehow managed to power down exactly in the middle of an update. This is extremely unlikely, but if something *can* happen, then we have to be ready for it.
+            retrieved_mins = newest->mins;
+            retrieved_days = newest->days;
 
-            retrieved_mins = persistent_data.backup_mins;
-            retrieved_days = persistent_data.backup_days;
+        } else {
 
-            // roll-back the in-progress update
-            unlock_persistant_data();
-            persistent_data.mins = retrieved_mins;
-            persistent_data.days = retrieved_days;
-            persistent_data.update_flag = 0;
-            lock_persistant_data();
+            // Neither slot is valid, so we must have been launched by firmware that kept the time in the legacy fields. Resolve its
+            // interlock the way it did and move the time into the counter slots. This happens once per unit, ever.
 
-        } else {
+            if (persistent_data.legacy_update_flag) {
+
+                // It somehow managed to power down exactly in the middle of an update, so roll back to the backup values.
+
+                retrieved_mins = persistent_data.legacy_backup_mins;
+                retrieved_days = persistent_data.legacy_backup_days;
+
+            } else {
 
-            // No update in progress, so we can directly use the primary (non-backup) values
-            retrieved_mins = persistent_data.mins;
-            retrieved_days = persistent_data.days;
+                retrieved_mins = persistent_data.legacy_mins;
+                retrieved_days = persistent_data.legacy_days;
+
+            }
+
+            commit_persistent_time( retrieved_days , retrieved_mins );
 
         }
 
         // Now we have to normalize the minutes+days because of the very edge case condition where we
-        // lost power just after we ticked the last minute of the day but had not yet started to update the day counter.
+        // lost power just after we ticked the last minute of the day but had not yet committed the new day.
 
         if ( retrieved_mins == minutes_per_day ) {
             // Commit the normalization update
-            unlock_persistant_data();
             retrieved_days++;
             retrieved_mins=0;
-            persistent_data.backup_mins=retrieved_mins;
-            persistent_data.backup_days=retrieved_days;
-            persistent_data.update_flag = 1;                // Yep, we have to do this - what if we lost power _right here_??
-            persistent_data.mins = retrieved_mins;
-            persistent_data.days = retrieved_days;
-            persistent_data.update_flag = 0;
-            lock_persistant_data();
+            commit_persistent_time( retrieved_days , retrieved_mins );
         }
 
+        unsigned retrieved_secs = 0;        // We only know the seconds if the RTC tells us
+
+        #if TSL_RTC_RECOVERY
+
+            // The RTC has been counting since launch, so see if it kept going while the batteries were out and can tell us exactly where we are.
+            // We read it right after a CLKOUT transition, so the second it gives us is still current when TSL_MODE_BEGIN takes the next rising
+            // edge. If we synced after the read instead, an edge in between would get cleared and we would count one second behind the RTC from then on.
+
+            rv3032_clkout_sync();
+            clkout_synced = true;
+
+            if ( !rv3032_recover_tsl_time( &retrieved_days , &retrieved_mins , &retrieved_secs ) ) {
+
+                // It did not, so we go with the checkpoint. Put the RTC back in step with it so next time it will know.
+                rv3032_set_tsl_time( retrieved_days , retrieved_mins , retrieved_secs );
+                clkout_synced = false;      // Setting the time restarts the RTC's second, so CLKOUT has moved and we need to line up again
+
+            }
+
+            // TSL_MODE_ISR adds 60 to the checkpoint each hour and counts on it landing exactly on `minutes_per_day` at midnight,
+            // so the checkpoint is always the top of the current hour.
+
+            const unsigned checkpoint_mins = retrieved_mins - ( retrieved_mins % minutes_per_hour );
+
+            newest = persistent_newest_slot();
+
+            if ( newest->days != retrieved_days || newest->mins != checkpoint_mins ) {
+                commit_persistent_time( retrieved_days , checkpoint_mins );
+            }
+
+        #endif
+
         if (retrieved_days >= 999999UL) {
 
             // we had preciously reached the end of our long journey before the battery swap
@@ -1448,25 +2030,25 @@ int main( void )
 
         }
 
-        // Break out the days into digits for more efficient updating while running.
-        // We only do this ONCE per set of batteries so no need for efficiency here.
-        // Note that there is no `tsl_days` variable, the `days_digits[]` are the canonical storage for the running day count.
+        // Break out the days for the ASM. The ones and tens become an index into `days_lcd_words` and the rest goes in as packed BCD
+        // so the ASM can bump it with a DADD every 100 days. We only do this ONCE per set of batteries so no need for efficiency here.
 
-        days_digits[0]= (retrieved_days / 1      ) % 10 ;
-        days_digits[1]= (retrieved_days / 10     ) % 10 ;
-        days_digits[2]= (retrieved_days / 100    ) % 10 ;
-        days_digits[3]= (retrieved_days / 1000   ) % 10 ;
-        days_digits[4]= (retrieved_days / 10000  ) % 10 ;
-        days_digits[5]= (retrieved_days / 100000 ) % 10 ;
+        tsl_days_ones_tens = retrieved_days % 100;
 
-        // Show the days since launch on the display
+        unsigned days_hundreds = retrieved_days / 100;
 
-        lcd_show_digit_f(  6 , days_digits[0] );
-        lcd_show_digit_f(  7 , days_digits[1] );
-        lcd_show_digit_f(  8 , days_digits[2] );
-        lcd_show_digit_f(  9 , days_digits[3] );
-        lcd_show_digit_f( 10 , days_digits[4] );
-        lcd_show_digit_f( 11 , days_digits[5] );
+        tsl_days_hundreds_bcd = ( (unsigned) c2bcd( days_hundreds / 100 ) << 8 ) | c2bcd( days_hundreds % 100 );
+
+        // Show the time since launch on the display. We build it up in RAM and put it up at once below.
+
+        lcd_compose_clear();
+
+        lcd_compose_digit(  6 , (retrieved_days / 1      ) % 10 );
+        lcd_compose_digit(  7 , (retrieved_days / 10     ) % 10 );
+        lcd_compose_digit(  8 , (retrieved_days / 100    ) % 10 );
+        lcd_compose_digit(  9 , (retrieved_days / 1000   ) % 10 );
+        lcd_compose_digit( 10 , (retrieved_days / 10000  ) % 10 );
+        lcd_compose_digit( 11 , (retrieved_days / 100000 ) % 10 );
 
         // Break out the persistent minutes into hours for display.
 
@@ -1474,20 +2056,25 @@ int main( void )
 
         tsl_mins = retrieved_mins - ( tsl_hours * minutes_per_hour );
 
-        tsl_secs = 0;           // We always fall back to the beginning of the minute. This means we can lose up to 59 secs of count time, but
-                                // that should happen less than once per century so it is worth it since we save power not needing to update the persistent counter every second.
+        tsl_secs = retrieved_secs;  // Without TSL_RTC_RECOVERY we always fall back to the beginning of the minute. This means we can lose up to 59 secs of count time, but
+                                    // that should happen less than once per century so it is worth it since we save power not needing to update the persistent counter every second.
+
+        lcd_compose_digit( 4 , tsl_hours % 10  );
+        lcd_compose_digit( 5 , tsl_hours / 10  );
+        lcd_compose_digit( 2 , tsl_mins  % 10  );
+        lcd_compose_digit( 3 , tsl_mins  / 10  );
+        lcd_compose_digit( 0 , tsl_secs  % 10  );
+        lcd_compose_digit( 1 , tsl_secs  / 10  );
 
-        lcd_show_digit_f( 4 , tsl_hours % 10  );
-        lcd_show_digit_f( 5 , tsl_hours / 10  );
-        lcd_show_digit_f( 2 , tsl_mins  % 10  );
-        lcd_show_digit_f( 3 , tsl_mins  / 10  );
-        lcd_show_digit_f( 0 , tsl_secs  % 10  );
-        lcd_show_digit_f( 1 , tsl_secs  / 10  );
+        lcd_compose_commit();
+
+        // Tell the ASM which slot it should count in. It finds the other one itself at midnight.
+
+        tsl_counter_slot = persistent_newest_slot() - persistent_data.counter_slots;
 
         // Now start ticking at next second tick interrupt
         // The TSL_MODE_BEGIN ISR will initialize the TSL mode counting registers from
-        // the `hours`, `mins`, and `secs` globals. Note that the ISR does not know about `days`
-        // because it calls back to the C `tsl_next_day()` routine when days increment.
+        // the `hours`, `mins`, `secs`, and `days` globals.
         // We do not set up the trigger ISR since it can never come. We will tick like this
         // forever (or at least until we loose power).
 
@@ -1498,6 +2085,7 @@ int main( void )
         // Set us up to run TSL_MODE_BEGIN on the first tick
         // This will set up the registers and then do the first update.
         // It also switches over to directly run TSL_MODE_ISR on the next tick.
+        lcd_tsl_blink_mode();
         SET_CLKOUT_VECTOR( &TSL_MODE_BEGIN );
     }
 
@@ -1509,17 +2097,15 @@ int main( void )
 
 
     // Wait for any clkout transition so we know we have at least 500ms until next transition so we dont miss any seconds.
-    // This should always take <500ms
-    // This also proves the RV3032 is running and we are connected on clkout
-    unsigned start_val = TBI( RV3032_CLKOUT_PIN, RV3032_CLKOUT_B );
-    while (TBI( RV3032_CLKOUT_PIN, RV3032_CLKOUT_B )==start_val); // wait for any transition
+    // Clears any pending interrupts from the RV3032 clkout pin, so we should not get a real one for 500ms and we have time to do our stuff.
+    // If we already synced before reading the time from the RTC then we do not do it again. An edge that came since then is a real second
+    // and its pending interrupt has to stay.
+    if ( !clkout_synced ) {
+        rv3032_clkout_sync();
+    }
 
     // Now we enable the interrupt on the RTC CLKOUT pin. For now on we must remember to
     // disable it again if we are going to end up in sleepforever mode.
-
-    // Clear any pending interrupts from the RV3032 clkout pin and then enable interrupts for the next falling edge
-    // We we should not get a real one for 500ms so we have time to do our stuff
-    CBI( RV3032_CLKOUT_PIFG     , RV3032_CLKOUT_B    );
     SBI( RV3032_CLKOUT_PIE      , RV3032_CLKOUT_B    );
 
     // Wait for interrupt to fire at next clkout low-to-high change to drive us into the state machine (in either "pin loading" or "time since launch" mode)
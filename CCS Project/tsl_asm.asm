@@ -3,13 +3,15 @@
         	.cdecls C,LIST,"msp430.h"  				; Include device header file
             .cdecls C,LIST,"lcd_display_exp.h"  	; Links to the info we need to update the LCD
             .cdecls C,LIST,"tsl_asm.h"  			; References to calls and variables shared with the C side
+            .cdecls C,LIST,"persistent_offsets.h"	; Where the fields of persistent_data are, since the assembler can not see into the struct
             .cdecls C,LIST,"ram_isrs.h"  			; We need the addresses for the RAM vector table so we can update from RTL_BEGIN to RTL mode.
             .cdecls C,LIST,"pins.h"					; We need the specific RAM vector for the CLKOUT pin
 
             .retain                         ; Ensure current section gets linked
             .retainrefs
 
-			.ref 		tsl_new_day			; C function called when day rolls over. Sadly I can not figure out how to define this in the tsl_asm.h file. :(
+			.ref 		long_now_mode		; C function called when the days reach 1,000,000. Sadly I can not figure out how to define this in the tsl_asm.h file. :(
+			.ref		persistent_data		; The persistent_data_t in info FRAM. We get at its fields with the offsets from persistent_offsets.h.
 
 			.text
 
@@ -33,7 +35,8 @@ TSL_MODE_BEGIN:
 
 	;For MSP430 and MSP430X, the ABI designates R4-R10 as callee-saved registers. That is, a called function is
 	;expected to preserve them so they have the same value on return from a function as they had at the point of the
-	;call. We will use these since we call back to C when date count changes and we don't want them to get clobbered.
+	;call. We used to care because we called back to C on each new day, but now the day rollover is done here too
+	;and the only C we ever call is long_now_mode(), which never returns. So every register is ours.
 
 			MOV.W 		#secs_lcd_words,R4			; R4=Base of the secs table (so we can reset back to the begining when we get to the end)
 			MOV.W		#(secs_lcd_words+2*60),R5	; R5=1 byte past end of the secs table (so we can test if we got to the end)
@@ -59,11 +62,18 @@ TSL_MODE_BEGIN:
 			MOV.B		&tsl_hours,R10				;  R10=Hours
 
 			; Next we need a register to hold the address of the persistent mins counter in FRAM. We do this once a minute, so should be efficient.
-			MOV.W		&persistant_mins_ptr,R11    ; R11=Address of persitent_data.mins counter in FRAM.
-													; Must be saved before calling C!
+			MOV.W		#(persistent_data+PERSISTENT_COUNTER_SLOTS_OFFSET),R11	; R11=Address of counter_slots[0], which starts with its mins counter
+			TST.W		&tsl_counter_slot
+			JZ			TSL_COUNTER_SLOT_SET
+			XOR.W		#PERSISTENT_COUNTER_SLOTS_TOGGLE,R11	; R11=counter_slots[1] if that is the newest. The day rollover also gets to the rest of the slot through R11.
+TSL_COUNTER_SLOT_SET
 
 			MOV.W 		#(PFWP|DFWP),R12			; R12=The constant to write to SYSCFG0 to relock the info FRAM memory. We keep it in a register becuase it is faster than using a constant for this value (0x03)
-													; Must be saved before calling C!
+
+			; R15= compute our location in the days table from the days ones and tens. This is the same trick as the secs and mins, just once a day.
+			MOV.B		&tsl_days_ones_tens,R15		; Start with days % 100. Note that these are stored as a byte on the C side.
+			ADD.W		R15,R15						; Double it so it is now a word pointer
+			ADD.W		#days_lcd_words,R15			; R15=location of the next day in days table
 
 			; Switch to FRAM based interrupt vector table
 			; Since the TSL_MODE_ISR is the default ISR for the CLKOUT pin in the FRAM vector table,
@@ -72,6 +82,16 @@ TSL_MODE_BEGIN:
 
 			BIC.W	 	#SYSRIVECT,&SYSCTL
 
+	.if TSL_SLEEP_IN_ISR
+
+			; We will never RETI from here on, so remember where the stack is now. Each tick after this will push another
+			; interrupt frame (PC+SR) that nobody will ever pop, and we put SP back here once a minute to throw them away.
+
+			MOV.W		SP,R13						; R13=SP to go back to at each minute rollover
+			MOV.W		#(GIE|LPM4),R14				; R14=The SR value that puts us to sleep with interrupts enabled. In a register so going to sleep is a 1 cycle MOV.
+
+	.endif
+
 			; Fall through to the actual handler, which will run once now and then will get called direct on each subsequent interrupt.
 
 
@@ -88,9 +108,13 @@ TSL_MODE_ISR
 
 			; Next minute
 
+	.if TSL_SLEEP_IN_ISR
+			MOV.W		R13,SP						; 1 cycle. Throw away the interrupt frames from the last 60 ticks (and the one that got us here).
+	.endif
+
 			; Increment the persisant minutes counter in FRAM. Note that if this is the end of the day, this will increment that counter to 1440 (24 hours)
-			; To account for this, (1) the next_day() C code always sets the mins directly back to 0, and (2) the startup code specifically looks for the case where the
-			; mins is 1440 and increments the days if so becuase that means we failed between *here* and when the next_day would have incremented the days.
+			; To account for this, (1) the day rollover below starts the new day in the other counter slot with mins at 0, and (2) the startup code specifically looks for the case where the
+			; mins is 1440 and increments the days if so becuase that means we failed between *here* and when the day rollover would have committed the new slot.
 
 
 			; TODO: Make this more efficient with registers.
@@ -103,16 +127,26 @@ TSL_MODE_ISR
 			; Note that keeping SYSCFG0 in a register would not speed things up since indirect addressing is always implemented as address+register, they just used R0 if you do not specify one.
 			; Is locking/unlock for each update worth it? Well, it only costs about 5 minutes per century: https://www.google.com/search?q=%28100+years%29+*++%286+microsecond%2Fminute%29
 
+	.if TSL_RTC_RECOVERY == 0
+
 			MOV.W		#PFWP,&SYSCFG0			; 3 cycles. Unlock the info section of FRAM, leave program section locked. IN this case, #PFWP is autoaliased to the constant generator register.
-			INC.W		0(R11)					; 4 cycles. Increment the mins counter. Note we do not need to do any overflow checking becuase once a day `tsl_next_day` will run and reset this.
+			INC.W		0(R11)					; 4 cycles. Increment the mins counter. Note we do not need to do any overflow checking becuase once a day the day rollover will reset this.
 			MOV.W		R12,&SYSCFG0	        ; 3 cycles. Lock both info section and program section of FRAM. Using a register for #((PFWP|DFWP) saves one cycle becuase it is not a value in the constant generator.
 
+	.endif
+
 			; Now update the mins on the display
 
 			MOV.W		R4,R6						; Reset the seconds pointer back to the top of the table (which, remember is "01") for next pass. We are currently displaying "00" which is in positon 59 in the table.
 
  	  		MOV.W		@R9+,&(LCDM0W_L+14)			; Read word value from table, increment the pointer, then write the word to the LCDMEM for the Mins digits
 
+			BIC.W		#LCDDISP,&LCDMEMCTL			; Back to showing LCDMEM if the centesimus dies message was up. Cheaper to always do it once a minute than to check. BIC does not touch the flags.
+
+	.if TSL_LCD_BLINK
+			MOV.W		#TSL_LCD_BLINK_CTL,&LCDBLKCTL	; And blinking again, since the message turned it off. The BIC above only sticks with the blinking off.
+	.endif
+
 			CMP.W		R9,R8						;; Check if we have reached the end of the table (seconds incremented to 60)
 
 			JNE			TSL_DONE
@@ -121,6 +155,17 @@ TSL_MODE_ISR
 
 			MOV.W		R7,R9						; Reset the mins pointer back to the top of the table (which, remember is "01").
 
+	.if TSL_RTC_RECOVERY
+
+			; With RTC recovery the persistent mins are just an hourly checkpoint since the RTC has the exact time. It still gets to 1440 at the
+			; end of the day, so the day rollover and the startup code work exactly the same as with the every minute INC.
+
+			MOV.W		#PFWP,&SYSCFG0				; Unlock the info section of FRAM
+			ADD.W		#60,0(R11)					; Bump the checkpoint to the top of this hour
+			MOV.W		R12,&SYSCFG0				; Lock it again
+
+	.endif
+
 			ADD.B		#1,R10						; Increment hours. TODO: We could use an ADD.B here and then use overlfow flag to avoid the CMP
 
 			CMP			#10,R10
@@ -161,18 +206,106 @@ HOURS_EQ_24
 
 			; If we get here then incremented hours is 24 so we have to roll to next day
 
-			MOV.W		#0, R10			; Reset hours to 0
+			MOV.W		#0, R10			; Reset hours to 0. Until we leave, R10 is also our scratch register since it is free while it is 0.
 
 			MOV.B		&(hours_lcd_bytes+0),&(LCDM0W_L+13)			; Display "0" in hours 10's digit
 			MOV.B		&(hours_lcd_bytes+0),&(LCDM0W_L+10)			; Display "0" in hours 1's digit
 
+			; Start the new day in the other counter slot. Nothing in the slot we are leaving changes, and the new slot only becomes the newest
+			; when we write its seq, so if we lose power anywhere in here main() just finds the old slot (with mins==1440) and does the day increment itself.
+			; We do all the math before unlocking the FRAM so it is only unlocked for the 5 writes.
+
+			MOV.W		R11,R10											; R10=The slot we are leaving
+			XOR.W		#PERSISTENT_COUNTER_SLOTS_TOGGLE,R11			; R11=The other slot, which is where the ISR will count from now on
+			MOV.W		PERSISTENT_COUNTER_SLOT_DAYS_OFFSET(R10),R4			; R4:R5=days+1. R4 and R5 are just the secs table bounds, so we borrow them and put them back below.
+			MOV.W		(PERSISTENT_COUNTER_SLOT_DAYS_OFFSET+2)(R10),R5
+			INC.W		R4
+			ADC.W		R5
+			MOV.W		PERSISTENT_COUNTER_SLOT_SEQ_OFFSET(R10),R10			; R10=seq+1
+			INC.W		R10
+
+			MOV.W		#PERSISTENT_SLOT_CRC_SEED,&CRCINIRES			; Run the new days and seq through the CRC module
+			MOV.W		R4,&CRCDI
+			MOV.W		R5,&CRCDI
+			MOV.W		R10,&CRCDI
+
+			MOV.W		#PFWP,&SYSCFG0									; Unlock the info section of FRAM
+			MOV.W		#0,PERSISTENT_COUNTER_SLOT_MINS_OFFSET(R11)		; mins = 0
+			MOV.W		R4,PERSISTENT_COUNTER_SLOT_DAYS_OFFSET(R11)			; days = days+1
+			MOV.W		R5,(PERSISTENT_COUNTER_SLOT_DAYS_OFFSET+2)(R11)
+			MOV.W		&CRCINIRES,PERSISTENT_COUNTER_SLOT_CRC_OFFSET(R11)
+			MOV.W		R10,PERSISTENT_COUNTER_SLOT_SEQ_OFFSET(R11)			; COMMIT. This single write makes it the newest slot.
+			MOV.W		R12,&SYSCFG0									; Lock the info section of FRAM
+
+			; Every 128 days show "centesimus dies" for a minute. (Yes, 128 is not 100, but it is a lot cheaper to check for.)
+			; The message was drawn into the LCDBMEM bank at startup, so putting it up is just switching the display over to that bank.
+			; LCDMEM keeps counting underneath, and the next minute switches back.
+
+			BIT.W		#127,R4
+			MOV.W		#secs_lcd_words,R4				; Give back the secs table bounds. MOV does not touch the flags.
+			MOV.W		#(secs_lcd_words+2*60),R5
+			MOV.W		#0,R10							; ...and hours gets its 0 back
+			JNZ			DAYS_SHOW
+
+	.if TSL_LCD_BLINK
+			MOV.W		#0,&LCDBLKCTL					; LCDDISP can only be set with the blinking off. The next minute turns it back on.
+	.endif
+			BIS.W		#LCDDISP,&LCDMEMCTL				; Show LCDBMEM
+
+DAYS_SHOW
+			; Now the display. The ones and tens are one word, just like the mins.
+
+ 	  		MOV.W		@R15+,&(LCDM0W_L+8)			; Read word value from table, increment the pointer, then write the word to the LCDMEM for the days ones and tens digits
+
+			CMP.W		#(days_lcd_words+2*100),R15	; Check if we have reached the end of the table (days ones and tens incremented to 100)
+			JNE			TSL_DONE
 
-			PUSH.W		R11											; R11-R14 are not callee saved, so we have to save them before calling C.
-			PUSH.W		R12
-			CALL		#tsl_new_day								; Call the C++ side for a new day. Updates the days digits on the LCD and atomically
-																	; (increments the persistant days and clears the minutes).
-			POP.W		R12											; TODO: We could just reload the orginal values here and save a PUSH/POP.
-			POP.W		R11
+			; Next hundred days. This happens once every 100 days, so from here on we are not in a hurry.
+
+			MOV.W		#days_lcd_words,R15			; Reset the days pointer back to the top of the table (which, remember is "01").
+
+			CLRC									; DADD adds in the carry too
+			DADD.W		#1,&tsl_days_hundreds_bcd	; Decimal increment of the hundreds and up
+			JC			DAYS_LONG_NOW				; Carry out of 9999 hundreds means we just got to 1,000,000 days
+
+			MOV.W		&tsl_days_hundreds_bcd,R10
+			AND.W		#0x000f,R10					; Hundreds digit. Sets Z if it rolled over to 0, and MOV and BIC/BIS do not touch the flags.
+			MOV.B		hours_lcd_bytes(R10),&(LCDM0W_L+7)			; The days hundreds digit has its nibbles in the same order as the hours digits.
+			JNZ			DAYS_DONE
+
+			MOV.W		&tsl_days_hundreds_bcd,R10
+			AND.W		#0x00f0,R10					; Thousands digit
+			RRA.W		R10
+			RRA.W		R10
+			RRA.W		R10
+			RRA.W		R10							; Z if it rolled over to 0
+			BIC.B		#0xf0,&(LCDM0W_L+0)			; This digit is split into the upper nibbles of two bytes
+			BIS.B		days_thousands_e_thru_g_lcd_bytes(R10),&(LCDM0W_L+0)
+			BIC.B		#0xf0,&(LCDM0W_L+6)
+			BIS.B		days_thousands_a_thru_d_lcd_bytes(R10),&(LCDM0W_L+6)
+			JNZ			DAYS_DONE
+
+			MOV.W		&tsl_days_hundreds_bcd,R10
+			SWPB		R10
+			AND.W		#0x000f,R10					; Ten thousands digit
+			MOV.B		days_high_lcd_bytes(R10),&(LCDM0W_L+1)
+			JNZ			DAYS_DONE
+
+			MOV.W		&tsl_days_hundreds_bcd,R10
+			SWPB		R10
+			AND.W		#0x00f0,R10					; Hundred thousands digit
+			RRA.W		R10
+			RRA.W		R10
+			RRA.W		R10
+			RRA.W		R10
+			MOV.B		days_high_lcd_bytes(R10),&(LCDM0W_L+2)
+
+DAYS_DONE
+			MOV.W		#0,R10						; Give hours back its 0
+			JMP			TSL_DONE
+
+DAYS_LONG_NOW
+			CALL		#long_now_mode				; Hard earned everlasting sleep. Never returns.
 
 TSL_DONE
 ;----------------------------------------------------------------------
@@ -191,9 +324,17 @@ TSL_DONE
 
  	  		;AND.B     #127,&PAOUT_L+0       ; Clear DEBUGA for profiling purposes.
 
+	.if TSL_SLEEP_IN_ISR
+
+			MOV.W		R14,SR				; 1 cycle. Go to sleep right here with interrupts enabled (vs 5 cycles for a RETI). The next tick will push a frame
+											; pointing to the NOP below and jump to the top of TSL_MODE_ISR. We never come back here, and the frames get thrown away each minute.
+			NOP								; Never executes, but the assembler wants a NOP after anything that sets GIE.
+
+	.else
+
             reti							; pops previous sleep mode, so puts us back to sleep
-            								; TODO: Replace this IRET with a sleep and save 4 cycles, and then
-            								; just clear 60 PUSHes off the stack every minute with a single write to SP.
+
+	.endif
 
             .sect   PORT1_VECTOR             ; Vector
             .short  TSL_MODE_ISR             ;
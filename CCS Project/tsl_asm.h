@@ -12,6 +12,34 @@
 #ifndef TSL_ASM_H_
 #define TSL_ASM_H_
 
+// Set to 1 to have TSL_MODE_ISR go back to sleep from inside itself rather than doing a RETI.
+// Once TSL mode starts the CPU never goes back to main(), so the interrupt frame that each tick pushes just piles up on the
+// stack and we throw them all away with a single write to SP at each minute rollover. This saves 4 cycles on every tick.
+// Note that this means the stack must have room for 60 interrupt frames (240 bytes), so check the stack size in the linker
+// settings if you turn it on.
+// Set to 0 to go back to a normal ISR with a RETI.
+#define TSL_SLEEP_IN_ISR 1
+
+// Set to 1 for boards where the RV3032 keeps time through a battery swap (backup switchover enabled, so not C2_IS_10K).
+// Since we reset the RTC to 00:00:00 1/1/00 at launch, its calendar is itself a time-since-launch counter, so at boot main()
+// rebuilds the exact days, hours, minutes, and seconds from it and only uses the persistent counter to tell which century it is.
+// That means the persistent counter only has to be a coarse checkpoint, so TSL_MODE_ISR adds 60 to it once an hour rather than
+// incrementing it every minute. If the RTC did lose time (PORF or VLF set) then we fall back to the checkpoint and can lose up to an hour.
+// Set to 0 to increment the persistent minutes every minute and always resume at the start of the last minute.
+#define TSL_RTC_RECOVERY 0
+
+// Set to 1 for the long-life variant, where the LCD_E blink controller blanks the Time Since Launch screen half of the time.
+// The blinking is all done by the LCD hardware off the VLO, so the tick does exactly the same work either way. The blink can
+// not be locked to the RV3032 tick, so instead it runs several times faster than the tick. That way a new value is never hidden
+// for more than one short blank and every second gets shown. See `Long-life display` in the README for how to measure it.
+// Set to 0 for a steady screen.
+#define TSL_LCD_BLINK 0
+
+// What main() writes to LCDBLKCTL when TSL_LCD_BLINK is on. LCDBLKPRE__64 is the error blink, and each step down doubles the rate.
+// LCDBLKMOD_2 blanks all segments on the off half. Note LCDDISP can only be changed with the blinking off, so the asm turns it
+// off to show the centesimus dies message and puts this back when the message comes down at the next minute.
+#define TSL_LCD_BLINK_CTL (LCDBLKPRE__16 | LCDBLKMOD_2)
+
 
 // Entry set vector to this to enter ready-to-launch mode on next interrupt
 // Assumes the symbol `ready_to_launch_lcd_frames` points to a table of LCD frames for the squiggle animation
@@ -30,18 +58,20 @@ extern unsigned TSL_MODE_BEGIN; /* declare external asm function as an unsigned
 extern unsigned tsl_hours;
 extern unsigned tsl_mins;
 extern unsigned tsl_secs;
+extern unsigned tsl_days_ones_tens;         // days % 100. The ISR walks a pointer into `days_lcd_words` from here.
 
-extern volatile unsigned *persistant_mins_ptr;  // Pointer to the word in FRAM that holds the current number of elapsed minutes.
-                                                // The asm code does not need the days variable because there are only 1440 mins in a day and it calls back
-                                                // to C on each day rollover.
-                                                // Note that we need this extra pointer because the assembler does not seem to be able to deal with nested structs, so we get the address in C and then pass that to ASM. :/
+// The rest of the days (days / 100) as 4 packed BCD digits, hundreds in the low nibble. Set by C before TSL_MODE_BEGIN, but unlike the
+// variables above, this one *is* the running count - the ISR DADDs it every 100 days and shows whichever digits changed.
+extern unsigned tsl_days_hundreds_bcd;
 
+extern unsigned tsl_counter_slot;           // Which of persistent_data.counter_slots is the newest (0 or 1). The ISR counts in that one and moves to the other at each day rollover.
+                                            // The asm gets to the slots as `persistent_data+PERSISTENT_COUNTER_SLOTS_OFFSET` (see persistent_offsets.h)
+                                            // since the assembler can not see into the struct.
 
 // Note that I could not get this function prototype to work with the assembler. It chokes on the etern "C" which unmangles the function name. :/
 // Instead we must add a ref in the ASM file. :(
 
-//extern "C" void tsl_new_day();      // ASM calls this each time the day rolls over. It is expected to update the day on the LCD and also
-                                    // atomically update the persistent mins and days counter.
+//extern "C" void long_now_mode();    // ASM calls this when the day count reaches 1,000,000. Never returns.
 
 
 // Here are the tables for values to write the the LCD control to display digits
@@ -49,6 +79,13 @@ extern volatile unsigned *persistant_mins_ptr;  // Pointer to the word in FRAM t
 extern unsigned secs_lcd_words[];          // table of prerendered values to write to the seconds word in LCDMEM (one entry for each second 0-59)
 extern unsigned mins_lcd_words[];          // table of prerendered values to write to the minutes word in LCDMEM (one entry for each min 0-59)
 extern unsigned char hours_lcd_bytes[];         // Unfortunately it was not possible to layout the PCB get both hours digits in the same MEMWORD, so we have to do each digit byte separately.
+                                                // The days hundreds digit also uses this table.
+
+extern unsigned days_lcd_words[];                           // table of prerendered values to write to the days ones and tens word in LCDMEM (one entry for each day 0-99)
+extern unsigned char days_thousands_e_thru_g_lcd_bytes[];   // The days thousands digit is split across two LCDMEM bytes, so these are the upper nibbles for each byte.
+extern unsigned char days_thousands_a_thru_d_lcd_bytes[];
+extern unsigned char days_high_lcd_bytes[];                 // The days ten thousands and hundred thousands digits.
+
 
 
 extern unsigned *ready_to_launch_lcd_frame_words;        // A complicated 2D table of words that we write to LCDMEM for the frames of the ready-to-launch animation
@@ -11,7 +11,32 @@ function doPost(e) {
     
     // Parse the JSON data from the POST request
     var values = JSON.parse(e.postData.contents);
-    
+
+    // A batch from logspool.py looks like {"rows": [[timestamp, uuid, hash, mac], ...]}. The rows already have the time they were
+    // programmed on the front since they might get here much later. Add them all in one go so a batch goes in all or nothing.
+    if (values && Array.isArray(values.rows)) {
+
+      var rows = values.rows;
+
+      for (var i = 0; i < rows.length; i++) {
+        if (!Array.isArray(rows[i]) || rows[i].length != 4) {
+          return ContentService.createTextOutput(JSON.stringify({
+            'status': 'error',
+            'message': 'wrong number of params in row '+i
+          })).setMimeType(ContentService.MimeType.JSON);
+        }
+      }
+
+      if (rows.length) {
+        sheet.getRange(sheet.getLastRow() + 1, 1, rows.length, 4).setValues(rows);
+      }
+
+      return ContentService.createTextOutput(JSON.stringify({
+        'status': 'success',
+        'message': 'Data appended successfully'
+      })).setMimeType(ContentService.MimeType.JSON);
+    }
+
     if (!Array.isArray(values) || values.length != 3) {
           // Return an error response if something goes wrong
       return ContentService.createTextOutput(JSON.stringify({
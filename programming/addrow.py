@@ -1,10 +1,8 @@
 import json
+import sys
 import urllib.request
 import urllib.error
 
-import keyring
-import uuid
-
 # takes the google appscript URL and a list of values
 
 def send_data_to_sheet(url,data):
@@ -52,6 +50,23 @@ def send_data_to_sheet(url,data):
                 f.write(json_str + "\n")  # Add newline for better formatting
         
 
+# takes the google appscript URL and a list of rows (each a list of values, starting with the timestamp) and sends them all in one request.
+# raises if they did not all get added, in which case none of them did.
+
+def send_rows(url,rows):
+
+    json_data = json.dumps({"rows": rows}).encode('utf-8')
+
+    req = urllib.request.Request(url, data=json_data, method='POST')
+    req.add_header('Content-Type', 'application/json')
+
+    with urllib.request.urlopen(req, timeout=30) as response:
+        resultJSON = json.loads(response.read().decode('utf-8'))
+
+    if resultJSON.get('message') != "Data appended successfully":
+        raise RuntimeError("Error adding rows to log spreadsheet! Message: " + str(resultJSON.get('message')))
+
+
 if __name__ == "__main__" :
 
     # Example usage
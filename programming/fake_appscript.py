@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+fake_appscript.py - Stand-in for the google app script (addrow-appscript.gs), so the log can be tried without the network
+
+Listens on localhost and takes the same POSTs as the app script...
+
+  * `[uuid, hash, mac]` gets a timestamp put in front, like the app script does.
+  * `{"rows": [[timestamp, uuid, hash, mac], ...]}` (from logspool.py) gets all the rows added at once.
+
+Every row that is added is written to the end of the sheet file (default fake_sheet.jsonl), one JSON row per line.
+
+    python3 fake_appscript.py                                # http://localhost:8765/
+    python3 fake_appscript.py --fail 0.3 --delay 2           # Fail 30% of requests and take 2 seconds over each one
+    tsl_logscript=http://localhost:8765/ python3 station.py fixtures.json
+
+Failures are a mix of HTTP 500s and an error message in the reply, which are the two ways the real one fails.
+"""
+
+import argparse
+import json
+import random
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+SUCCESS_MESSAGE = "Data appended successfully"      # What addrow.py looks for
+
+
+class Handler(BaseHTTPRequestHandler):
+
+    def _reply(self, status, message, code=200):
+        body = json.dumps({"status": status, "message": message}).encode("utf-8")
+        self.send_response(code)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_POST(self):
+        server = self.server
+        contents = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        time.sleep(server.delay)
+
+        if random.random() < server.fail:
+            if random.random() < 0.5:
+                self._reply("error", "Internal error (fake)", 500)
+            else:
+                self._reply("error", "Service invoked too many times (fake)")
+            return
+
+        try:
+            values = json.loads(contents)
+        except ValueError:
+            self._reply("error", "not JSON")
+            return
+
+        if isinstance(values, dict) and isinstance(values.get("rows"), list):
+            rows = values["rows"]
+            for i, row in enumerate(rows):
+                if not isinstance(row, list) or len(row) != 4:
+                    self._reply("error", "wrong number of params in row %d" % i)
+                    return
+        elif isinstance(values, list) and len(values) == 3:
+            rows = [[time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime())] + values]
+        else:
+            self._reply("error", "wrong number of params" + contents.decode("utf-8", "replace") + "<")
+            return
+
+        with server.lock, open(server.sheet, "a") as f:
+            for row in rows:
+                f.write(json.dumps(row) + "\n")
+        print("Added %d rows" % len(rows))
+        self._reply("success", SUCCESS_MESSAGE)
+
+    def log_message(self, format, *args):
+        pass
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", type=int, default=8765)
+    ap.add_argument("--sheet", default="fake_sheet.jsonl", help="file the rows get added to (default fake_sheet.jsonl)")
+    ap.add_argument("--fail", type=float, default=0, help="fraction of requests that fail (0-1)")
+    ap.add_argument("--delay", type=float, default=0, help="seconds each request takes")
+    args = ap.parse_args()
+
+    server = ThreadingHTTPServer(("localhost", args.port), Handler)
+    server.sheet = args.sheet
+    server.fail = args.fail
+    server.delay = args.delay
+    server.lock = threading.Lock()
+    print(f"Fake app script at http://localhost:{args.port}/ adding rows to {args.sheet}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+fake_msp430flasher.py - Stand-in for MSP430Flasher, so station.py and the readers can run without an EZ-FET
+
+Takes the same options that our tools use (-j, -i, -r, -e, -w, -v, -z) and acts like a unit is connected...
+
+  * -r [file,start-end] writes a TI-TXT dump of that range. The device descriptors (0x1a00) get a random die position,
+    so every "unit" has its own UUID. Anything else comes from the last image written to that interface, or 0xFF.
+  * -w checks that the image is valid TI-TXT with a programmed_time section, and remembers it for later reads.
+  * Takes FAKE_MSP430FLASHER_SECONDS (default 3) to do it, like a real erase/write/verify.
+  * Fails with exit code 1 if the -i interface is listed in FAKE_MSP430FLASHER_FAIL (comma separated).
+
+The written images are kept in the temp directory, one per interface.
+"""
+
+import os
+import re
+import sys
+import tempfile
+import time
+
+import titxt
+import persistent_layout
+
+DEVICE_DESCRIPTOR_ADDRESS = 0x1a00
+
+
+def _memory_path(interface):
+    return os.path.join(tempfile.gettempdir(), "fake_msp430flasher_%s.txt" % re.sub(r"\W", "_", interface))
+
+
+def _read(interface, start, end):
+    data = bytearray([0xFF]) * (end - start + 1)
+    if DEVICE_DESCRIPTOR_ADDRESS <= start <= DEVICE_DESCRIPTOR_ADDRESS + 0x12:
+        # Device info, then the lot/wafer and die position that make up the UUID
+        descriptors = bytes([0x06, 0x06, 0x00, 0x00, 0x40, 0x81, 0x21, 0x10, 0x00, 0x00]) + os.urandom(8) + bytes(1)
+        data[:] = descriptors[start - DEVICE_DESCRIPTOR_ADDRESS:end - DEVICE_DESCRIPTOR_ADDRESS + 1]
+    elif os.path.exists(_memory_path(interface)):
+        with open(_memory_path(interface), "rb") as f:
+            data = titxt.TiTxt(f.read()).image(start, end - start + 1)
+    return titxt.encode([(start, data)])
+
+
+def main(argv):
+    interface = "USB"
+    steps = []
+    i = 0
+    while i < len(argv):
+        opt = argv[i]
+        arg = argv[i + 1] if i + 1 < len(argv) else None
+        if opt in ("-j", "-i", "-r", "-e", "-w", "-z"):
+            i += 2
+            if opt == "-i":
+                interface = arg
+            elif opt in ("-r", "-w"):
+                steps.append((opt, arg))
+        else:
+            i += 1
+
+    time.sleep(float(os.environ.get("FAKE_MSP430FLASHER_SECONDS", "3")))
+
+    if interface in os.environ.get("FAKE_MSP430FLASHER_FAIL", "").split(","):
+        print("* Could not find MSP-FET430UIF on specified COM port! (fake)")
+        return 1
+
+    for opt, arg in steps:
+        if opt == "-r":
+            m = re.fullmatch(r"\[(.+),(0x[0-9a-fA-F]+)-(0x[0-9a-fA-F]+)\]", arg)
+            path, start, end = m.group(1), int(m.group(2), 16), int(m.group(3), 16)
+            with open(path, "wb") as f:
+                f.write(_read(interface, start, end))
+        else:
+            with open(arg, "rb") as f:
+                image = f.read()
+            address = persistent_layout.BASE_ADDRESS + persistent_layout.PERSISTENT_PROGRAMMED_TIME_OFFSET
+            titxt.TiTxt(image).read(address, 7)         # Raises if there is no timestamp
+            if not image.rstrip().endswith(b"q"):
+                print("* File does not end with q (fake)")
+                return 1
+            with open(_memory_path(interface), "wb") as f:
+                f.write(image)
+
+    print("* Driver      : closed (No error) (fake)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
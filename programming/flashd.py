@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+"""
+flashd.py - Keep the EZ-FET open between units and program over a local socket, instead of starting MSP430Flasher each time
+
+Every MSP430Flasher run finds the EZ-FET, checks its firmware, powers up, and connects to the target before it does anything,
+and then lets it all go again. That is most of the time it takes, and we pay it again for every unit and every read. This is
+a small server that holds one EZ-FET open through the MSP Debug Stack (MSP430.DLL, the library MSP430Flasher itself uses) and
+takes requests from the tools on a local socket, so all that is left per unit is syncing to the new target over SBW.
+
+    python3 flashd.py --interface COM5                      # One server per EZ-FET, on localhost:7430
+    python3 flashd.py --interface COM6 --port 7431
+    python3 flashd.py --backend fake                        # No hardware, see FakeBackend
+
+Then point the tools at it...
+
+  * program.py, tsl_reader.py and printPersistentData.py use it when `tsl_flashd` is set, like `set tsl_flashd=localhost:7430`
+  * station.py uses it for fixtures with a `"flashd": "localhost:7430"` in their config
+
+The protocol is one JSON object per line each way. Bytes go as hex...
+
+    {"op": "open"}                                          -> {"ok": true}     sync to whatever target is connected now
+    {"op": "read", "address": 6656, "length": 18}           -> {"ok": true, "data": "0606..."}
+    {"op": "erase"}                                         -> {"ok": true}     ERASE_MAIN, like -e ERASE_MAIN
+    {"op": "write", "address": 6144, "data": "3015..."}     -> {"ok": true}
+    {"op": "verify", "address": 6144, "data": "3015..."}    -> {"ok": true}     checked on the target, not read back
+    {"op": "run"}                                           -> {"ok": true}     reset and let go, VCC stays on (like -z [VCC])
+    {"op": "run", "release": false}                         -> {"ok": true}     reset and run, but keep hold of it for peek
+    {"op": "peek", "address": 6202, "length": 2}            -> {"ok": true, "data": "b296"}     stop, read, carry on (no reset)
+    {"op": "release"}                                       -> {"ok": true}     let go of a unit we kept hold of
+
+Anything that goes wrong comes back as {"ok": false, "error": "..."} and FlasherSession raises it as a RuntimeError.
+"""
+
+import argparse
+import ctypes
+import json
+import os
+import socket
+import socketserver
+import sys
+import threading
+import time
+
+import titxt
+import persistent_layout
+from persistent_time import crc16
+
+DEFAULT_PORT = 7430
+
+DEVICE_DESCRIPTOR_ADDRESS = 0x1a00
+DEVICE_DESCRIPTOR_LENGTH = 0x12             # Through the die Y position, all that get_ddid_from_file() needs
+
+VCC_MILLIVOLTS = 3000
+
+IMAGE_CRC_ADDRESS = persistent_layout.BASE_ADDRESS + persistent_layout.PERSISTENT_IMAGE_CRC_OFFSET
+IMAGE_CRC_TIMEOUT_SECONDS = 5   # The first boot takes ~0.2s to get to program_fram_crc() (RV3032 POR refresh, then the CRC), or ~1.2s if the RV3032 never answers
+IMAGE_CRC_POLL_SECONDS = 0.1
+
+
+# ** Backends
+
+class Msp430DllBackend:
+    """The EZ-FET through the MSP Debug Stack. Same library and calls MSP430Flasher makes, we just do not close it after each unit."""
+
+    # From MSP430.h / MSP430_Debug.h in the MSP Debug Stack
+    STATUS_OK = 0
+    ERASE_MAIN = 1
+    RST_RESET = 1 << 1
+    FREE_RUN = 0
+
+    def __init__(self, interface, dll=None):
+        if dll is None:
+            dll = {"win32": "MSP430.dll", "darwin": "libmsp430.dylib"}.get(sys.platform, "libmsp430.so")
+        self.lib = (ctypes.WinDLL if sys.platform == "win32" else ctypes.CDLL)(dll)
+        version = ctypes.c_int32()
+        # This is the slow part - finding the EZ-FET and checking its firmware. Once per server, not once per unit.
+        self._check(self.lib.MSP430_Initialize(interface.encode(), ctypes.byref(version)), "Initialize")
+        self._check(self.lib.MSP430_VCC(VCC_MILLIVOLTS), "VCC")
+
+    def _check(self, status, what):
+        if status != self.STATUS_OK:
+            self.lib.MSP430_Error_String.restype = ctypes.c_char_p
+            error = self.lib.MSP430_Error_String(self.lib.MSP430_Error_Number())
+            raise RuntimeError(f"MSP430_{what} failed: {error.decode(errors='replace')}")
+
+    def open(self):
+        self._check(self.lib.MSP430_OpenDevice(b"DEVICE_UNKNOWN", b"", 0, 0, 0), "OpenDevice")
+
+    def read(self, address, length):
+        buffer = (ctypes.c_uint8 * length)()
+        self._check(self.lib.MSP430_Read_Memory(address, buffer, length), "Read_Memory")
+        return bytes(buffer)
+
+    def erase(self):
+        self._check(self.lib.MSP430_Erase(self.ERASE_MAIN, 0xFFFE, 0), "Erase")
+
+    def write(self, address, data):
+        buffer = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+        self._check(self.lib.MSP430_Write_Memory(address, buffer, len(data)), "Write_Memory")
+
+    def verify(self, address, data):
+        # The target checksums the range itself (PSA), so this does not read the image back over SBW
+        buffer = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
+        self._check(self.lib.MSP430_VerifyMem(address, len(data), buffer), "VerifyMem")
+
+    def run(self, release=True):
+        self._check(self.lib.MSP430_Reset(self.RST_RESET, 0, 0), "Reset")
+        self._check(self.lib.MSP430_Run(self.FREE_RUN, int(release)), "Run")
+
+    def peek(self, address, length):
+        # Stop it where it is, read, and let it carry on. No reset, so it does not start its first boot over.
+        state, cycles = ctypes.c_int32(), ctypes.c_int32()
+        self._check(self.lib.MSP430_State(ctypes.byref(state), 1, ctypes.byref(cycles)), "State")
+        data = self.read(address, length)
+        self._check(self.lib.MSP430_Run(self.FREE_RUN, 0), "Run")
+        return data
+
+    def release(self):
+        self._check(self.lib.MSP430_Run(self.FREE_RUN, 1), "Run")
+
+    def close(self):
+        self.lib.MSP430_Close(0)                # 0 leaves VCC on
+
+
+class FakeBackend:
+    """Stand-in for tests. Takes FAKE_FLASHD_SETUP_SECONDS (default 3) to "find the EZ-FET" once at start, like a
+    MSP430Flasher run does every time, and then FAKE_FLASHD_OPEN_SECONDS (default 0.3) per unit. Each open() is a new
+    unit with its own random die position. Fails every request if FAKE_FLASHD_FAIL is set.
+
+    After run() the "unit" does what its first boot would for `image_crc` 0.2 seconds later. With FAKE_FLASHD_CORRUPT set,
+    one byte of every write is wrong, so that CRC will not match."""
+
+    BOOT_SECONDS = 0.2
+
+    def __init__(self, interface, dll=None):
+        time.sleep(float(os.environ.get("FAKE_FLASHD_SETUP_SECONDS", "3")))
+        self.memory = bytearray([0xFF]) * 0x10000
+        self.opened = False
+        self.booted_at = None
+
+    def _check(self):
+        if os.environ.get("FAKE_FLASHD_FAIL"):
+            raise RuntimeError("Could not find MSP-FET430UIF (fake)")
+        if not self.opened:
+            raise RuntimeError("No target open (fake)")
+
+    def open(self):
+        time.sleep(float(os.environ.get("FAKE_FLASHD_OPEN_SECONDS", "0.3")))
+        self.opened = True
+        self._check()
+        self.memory[DEVICE_DESCRIPTOR_ADDRESS:DEVICE_DESCRIPTOR_ADDRESS + 0x12] = (
+            bytes([0x06, 0x06, 0x00, 0x00, 0x40, 0x81, 0x21, 0x10, 0x00, 0x00]) + os.urandom(8))
+
+    def read(self, address, length):
+        self._check()
+        return bytes(self.memory[address:address + length])
+
+    def erase(self):
+        self._check()
+        self.memory[0xC400:0x10000] = bytes([0xFF]) * (0x10000 - 0xC400)
+
+    def write(self, address, data):
+        self._check()
+        self.memory[address:address + len(data)] = data
+        if os.environ.get("FAKE_FLASHD_CORRUPT"):
+            self.memory[address] ^= 0x01
+
+    def verify(self, address, data):
+        self._check()
+        if self.memory[address:address + len(data)] != data:
+            raise RuntimeError("Verify failed at 0x%04X (fake)" % address)
+
+    def run(self, release=True):
+        self._check()
+        self.booted_at = time.time()
+        self.opened = not release
+
+    def peek(self, address, length):
+        self._check()
+        if self.booted_at is not None and time.time() - self.booted_at > self.BOOT_SECONDS:
+            start = persistent_layout.PERSISTENT_IMAGE_CRC_START
+            crc = crc16(self.memory[start:start + persistent_layout.PERSISTENT_IMAGE_CRC_WORDS * 2], persistent_layout.PERSISTENT_IMAGE_CRC_SEED)
+            self.memory[IMAGE_CRC_ADDRESS:IMAGE_CRC_ADDRESS + 2] = crc.to_bytes(2, "little")
+            self.booted_at = None
+        return self.read(address, length)
+
+    def release(self):
+        self._check()
+        self.opened = False
+
+    def close(self):
+        pass
+
+
+BACKENDS = {"dll": Msp430DllBackend, "fake": FakeBackend}
+
+
+# ** Server
+
+class Handler(socketserver.StreamRequestHandler):
+
+    def handle(self):
+        for line in self.rfile:
+            try:
+                request = json.loads(line)
+                with self.server.lock:         # One EZ-FET, so one request at a time no matter how many clients
+                    reply = self.server.dispatch(request)
+                reply["ok"] = True
+            except Exception as e:
+                reply = {"ok": False, "error": str(e)}
+            self.wfile.write((json.dumps(reply) + "\n").encode())
+
+
+class FlasherServer(socketserver.ThreadingTCPServer):
+
+    daemon_threads = True
+    allow_reuse_address = True
+
+    def __init__(self, address, backend):
+        super().__init__(address, Handler)
+        self.backend = backend
+        self.lock = threading.Lock()
+
+    def dispatch(self, request):
+        op = request["op"]
+        b = self.backend
+        if op == "open":
+            b.open()
+        elif op == "read":
+            return {"data": b.read(request["address"], request["length"]).hex()}
+        elif op == "erase":
+            b.erase()
+        elif op == "write":
+            b.write(request["address"], bytes.fromhex(request["data"]))
+        elif op == "verify":
+            b.verify(request["address"], bytes.fromhex(request["data"]))
+        elif op == "run":
+            b.run(request.get("release", True))
+        elif op == "peek":
+            return {"data": b.peek(request["address"], request["length"]).hex()}
+        elif op == "release":
+            b.release()
+        else:
+            raise ValueError("Unknown op %r" % op)
+        return {}
+
+
+# ** Client
+
+class FlasherSession:
+    """A connection to a flashd server. `address` is "host:port" (or just the port)."""
+
+    def __init__(self, address, timeout=60):
+        host, _, port = address.rpartition(":")
+        self.sock = socket.create_connection((host or "localhost", int(port)), timeout=timeout)
+        self.file = self.sock.makefile("rwb")
+
+    def close(self):
+        self.file.close()
+        self.sock.close()
+
+    def _call(self, op, **args):
+        self.file.write((json.dumps(dict(op=op, **args)) + "\n").encode())
+        self.file.flush()
+        line = self.file.readline()
+        if not line:
+            raise RuntimeError("flashd closed the connection")
+        reply = json.loads(line)
+        if not reply["ok"]:
+            raise RuntimeError(reply["error"])
+        return reply
+
+    def open(self):
+        self._call("open")
+
+    def read(self, address, length):
+        return bytes.fromhex(self._call("read", address=address, length=length)["data"])
+
+    def erase(self):
+        self._call("erase")
+
+    def write(self, address, data):
+        self._call("write", address=address, data=bytes(data).hex())
+
+    def verify(self, address, data):
+        self._call("verify", address=address, data=bytes(data).hex())
+
+    def run(self, release=True):
+        self._call("run", release=release)
+
+    def peek(self, address, length):
+        return bytes.fromhex(self._call("peek", address=address, length=length)["data"])
+
+    def release(self):
+        self._call("release")
+
+    def program(self, image, crc=None):
+        """What program.py asks MSP430Flasher for: read the device descriptors, erase, write and verify the TI-TXT `image`,
+        and leave it running. Returns the device descriptor bytes.
+
+        With `crc` (FirmwareImage.crc), instead of verifying the image we let the unit boot and wait for it to put that CRC
+        of its program FRAM in `image_crc`. The image has to preset `image_crc` to the complement, like FirmwareImage does."""
+        segments = titxt.TiTxt(image).segments()
+        self.open()
+        descriptors = self.read(DEVICE_DESCRIPTOR_ADDRESS, DEVICE_DESCRIPTOR_LENGTH)
+        self.erase()
+        for address, data in segments:
+            self.write(address, data)
+        if crc is None:
+            for address, data in segments:
+                self.verify(address, data)
+            self.run()
+        else:
+            self.run(release=False)
+            try:
+                self.wait_for_image_crc(crc)
+            finally:
+                self.release()
+        return descriptors
+
+    def wait_for_image_crc(self, crc):
+        deadline = time.time() + IMAGE_CRC_TIMEOUT_SECONDS
+        while True:
+            time.sleep(IMAGE_CRC_POLL_SECONDS)
+            found = int.from_bytes(self.peek(IMAGE_CRC_ADDRESS, 2), "little")
+            if found == crc:
+                return
+            if found != crc ^ 0xFFFF:
+                raise RuntimeError(f"Image CRC is {found:04X} but should be {crc:04X}. Bad write?")
+            if time.time() > deadline:
+                raise RuntimeError(f"Unit did not put its image CRC in FRAM within {IMAGE_CRC_TIMEOUT_SECONDS} seconds")
+
+    def read_unit(self, address, length):
+        """Read from whatever unit is connected now and leave it running."""
+        self.open()
+        data = self.read(address, length)
+        self.run()
+        return data
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--interface", default="USB", help="EZ-FET to use, like MSP430Flasher's -i (default USB, the first one)")
+    ap.add_argument("--port", type=int, default=DEFAULT_PORT, help="TCP port on localhost (default %d)" % DEFAULT_PORT)
+    ap.add_argument("--backend", choices=sorted(BACKENDS), default="dll")
+    ap.add_argument("--dll", help="path to MSP430.dll / libmsp430.so if it is not on the library path")
+    args = ap.parse_args()
+
+    print(f"Opening {args.interface}...")
+    backend = BACKENDS[args.backend](args.interface, args.dll)
+    server = FlasherServer(("localhost", args.port), backend)
+    print(f"Serving {args.interface} on localhost:{args.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        backend.close()
+
+
+if __name__ == "__main__":
+    main()
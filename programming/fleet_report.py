@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+fleet_report.py - Summarize a whole directory of info FRAM dumps at once
+
+We keep the TI-TXT dump of 0x1800-0x18ff from every unit that comes back or gets read. This decodes all of them and
+reports on the fleet as a whole...
+
+  * Where each unit is in its life (fresh from programming, initialized, commissioned, launched)
+  * porsoltCount against the 39/65 limits that main() rejects a unit at on first battery insertion
+  * tsl_powerup_count, which is one per battery swap
+  * Days since launch, for the launched units
+  * Units whose time is stuck in the legacy fields with `update_flag` set, and units with a day rollover pending
+
+    python3 fleet_report.py dumps/              # Every *.txt under dumps/, spread over all cores
+    python3 fleet_report.py -l dumps/ more/     # Also list the files behind each finding
+
+The work is split into batches of files and each process builds a partial report for its batches, so nothing per file
+crosses between processes and it scales with the cores until the disk runs out. Each dump is overlaid with the
+generated persistent_layout structures rather than unpacked field by field.
+"""
+
+import argparse
+import collections
+import multiprocessing
+import os
+import sys
+import time
+
+import persistent_layout
+import titxt
+from persistent_time import newest_slot, time_since_launch, MINS_PER_DAY
+
+# The porsoltCount limits from the first battery insertion check in main(). Below is too much current, above is too little.
+PORSOLT_MIN = 39
+PORSOLT_MAX = 65
+
+BATCH_SIZE = 512                # Files per job
+PORSOLT_BUCKET = 5              # Width of the porsoltCount histogram bars
+DAYS_BUCKET = 365               # ...and days since launch
+HISTOGRAM_WIDTH = 50            # Characters in the longest bar
+
+UNWRITTEN = 0xFFFF              # What a flag or counter reads before the firmware ever wrote it
+
+
+def read_dump(path):
+    """The persistent data from a TI-TXT dump. Anything the dump does not cover reads as 0xFF, like erased FRAM."""
+    with open(path, "rb") as f:
+        image = titxt.TiTxt(f.read()).image(persistent_layout.BASE_ADDRESS, persistent_layout.SIZE)
+    return persistent_layout.PersistentData.from_buffer(image)
+
+
+def life_stage(data):
+    """The same checks main() makes of the flags at boot, in the same order."""
+    if data.initalized_flag != 0x01:
+        return "programmed, never booted"
+    if data.commisisoned_flag != 0x01:
+        return "initialized, no batteries yet"
+    if data.launched_flag != 0x01:
+        return "commissioned, ready to launch"
+    return "launched"
+
+
+class Report:
+    """Everything we count. Partial reports from each batch get merged into one."""
+
+    def __init__(self):
+        self.files = 0
+        self.stages = collections.Counter()
+        self.porsolt = collections.Counter()
+        self.powerups = collections.Counter()
+        self.days = collections.Counter()
+        self.sources = collections.Counter()
+        self.findings = collections.defaultdict(list)       # what: [path, ...]
+
+    def add(self, path, data):
+        self.files += 1
+        stage = life_stage(data)
+        self.stages[stage] += 1
+        if stage == "programmed, never booted":
+            return
+
+        # The power down test right after the first boot is what writes porsoltCount
+        self.porsolt[data.porsoltCount] += 1
+        if data.porsoltCount < PORSOLT_MIN:
+            self.findings["porsoltCount below %d (too much current)" % PORSOLT_MIN].append(path)
+        elif data.porsoltCount > PORSOLT_MAX:
+            self.findings["porsoltCount above %d (too little current)" % PORSOLT_MAX].append(path)
+
+        if data.tsl_powerup_count != UNWRITTEN:
+            self.powerups[data.tsl_powerup_count] += 1
+
+        if stage != "launched":
+            return
+
+        days, _, _ = time_since_launch(data)
+        self.days[days] += 1
+        newest = newest_slot(data)
+        if newest is None:
+            self.sources["legacy_update_flag set" if data.legacy_update_flag else "legacy fields"] += 1
+            if data.legacy_update_flag:
+                self.findings["stuck with legacy update_flag set"].append(path)
+        else:
+            self.sources["counter slots"] += 1
+            if data.counter_slots[newest].mins == MINS_PER_DAY:
+                self.findings["day rollover pending (mins == %d)" % MINS_PER_DAY].append(path)
+
+    def error(self, path, e):
+        self.files += 1
+        self.findings["unreadable dump"].append("%s (%s)" % (path, e))
+
+    def merge(self, other):
+        self.files += other.files
+        for mine, theirs in ((self.stages, other.stages), (self.porsolt, other.porsolt), (self.powerups, other.powerups),
+                             (self.days, other.days), (self.sources, other.sources)):
+            mine.update(theirs)
+        for what, paths in other.findings.items():
+            self.findings[what].extend(paths)
+
+
+def run_batch(paths):
+    report = Report()
+    for path in paths:
+        try:
+            data = read_dump(path)
+        except (OSError, ValueError) as e:
+            report.error(path, e)
+            continue
+        report.add(path, data)
+    return report
+
+
+def find_dumps(roots):
+    """Every *.txt under `roots`, streamed so we can start decoding before the walk is done."""
+    for root in roots:
+        if os.path.isfile(root):
+            yield root
+            continue
+        for dirpath, _, filenames in os.walk(root):
+            for name in filenames:
+                if name.lower().endswith(".txt"):
+                    yield os.path.join(dirpath, name)
+
+
+def _batches(paths, n):
+    batch = []
+    for path in paths:
+        batch.append(path)
+        if len(batch) == n:
+            yield batch
+            batch = []
+    if batch:
+        yield batch
+
+
+def _histogram(title, counts, bucket, label):
+    total = sum(counts.values())
+    print("\n%s (%d units)" % (title, total))
+    if not total:
+        return
+    bars = collections.Counter()
+    for v, n in counts.items():
+        bars[v // bucket * bucket] += n
+    tallest = max(bars.values())
+    for lo in range(min(bars), max(bars) + 1, bucket):
+        n = bars[lo]
+        print("  %-16s %7d %s" % (label(lo, lo + bucket - 1), n, "#" * -(-n * HISTOGRAM_WIDTH // tallest)))
+
+
+def _table(title, counts):
+    print("\n%s" % title)
+    for what, n in counts.most_common():
+        print("  %-36s %7d" % (what, n))
+
+
+def print_report(report, list_files):
+    print("Dumps:                   %d" % report.files)
+    _table("Life stage", report.stages)
+
+    total = sum(report.porsolt.values())
+    below = sum(n for v, n in report.porsolt.items() if v < PORSOLT_MIN)
+    above = sum(n for v, n in report.porsolt.items() if v > PORSOLT_MAX)
+    _histogram("porsoltCount", report.porsolt, PORSOLT_BUCKET, lambda lo, hi: "%d-%d" % (lo, hi))
+    if total:
+        print("  below %d: %d (%.1f%%), %d-%d: %d, above %d: %d (%.1f%%)" % (PORSOLT_MIN, below, 100.0 * below / total, PORSOLT_MIN, PORSOLT_MAX,
+                                                                          total - below - above, PORSOLT_MAX, above, 100.0 * above / total))
+
+    _table("tsl_powerup_count (1 = never had a battery swap)", collections.Counter({"%d" % v: n for v, n in report.powerups.items()}))
+    _histogram("Days since launch", report.days, DAYS_BUCKET, lambda lo, hi: "%d-%d" % (lo, hi))
+    _table("Where the time since launch is kept", report.sources)
+
+    if report.findings:
+        print("\nFindings")
+        for what, paths in sorted(report.findings.items()):
+            print("  %-48s %7d" % (what, len(paths)))
+            if list_files:
+                for path in sorted(paths):
+                    print("      %s" % path)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("paths", nargs="+", help="dump files, or directories to search for *.txt dumps")
+    ap.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="processes to spread it over (default all cores)")
+    ap.add_argument("-l", "--list", action="store_true", help="list the files behind each finding")
+    args = ap.parse_args()
+
+    start = time.time()
+    report = Report()
+    batches = _batches(find_dumps(args.paths), BATCH_SIZE)
+    if args.jobs == 1:
+        for batch in batches:
+            report.merge(run_batch(batch))
+    else:
+        with multiprocessing.Pool(args.jobs) as pool:
+            for partial in pool.imap_unordered(run_batch, batches):
+                report.merge(partial)
+
+    print_report(report, args.list)
+    print("\nDecoded in %.1f seconds." % (time.time() - start), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
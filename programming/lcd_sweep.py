@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+lcd_sweep.py - Split a current capture of a unit running the LCD drive sweep into one average per drive profile
+
+A unit programmed with `station.py --lcd-drive sweep` never commissions. It steps through the LCD drive profiles in
+tsl-calibre-msp.cpp forever, a minute each, and starts each one right after a tick with a marker: the CPU on at full
+current for (index+1) * 10ms. This finds the markers in a capture, works out which profile each one starts, and
+averages the current from a few seconds after the marker (so the glass and charge pump have settled) up to the next one.
+
+    python3 lcd_sweep.py capture.csv                    # EnergyTrace "Save raw data" CSV, or any CSV with time and current columns
+    python3 lcd_sweep.py capture.csv --settle 10        # Skip 10 seconds after each switch instead of 5
+    python3 lcd_sweep.py --synth fake.csv               # Make a made-up capture to try it on
+
+The CSV needs a header with a time column and a current column, with their units in brackets like EnergyTrace does
+("Time (ns)", "Current (nA)"). Any of s/ms/us/ns and A/mA/uA/nA work. The profile names come from the
+`lcd_drive_profile_index_t` enum in the firmware, so they stay in step with the table.
+"""
+
+import argparse
+import csv
+import os
+import random
+import re
+import sys
+
+FIRMWARE_SOURCE = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "CCS Project", "tsl-calibre-msp.cpp")
+
+MARKER_STEP_SECONDS = 0.010     # Each step of the marker. Has to match the __delay_cycles() in lcd_drive_sweep().
+MARKER_MIN_SECONDS = 0.005      # Anything shorter above the threshold is just a tick
+MARKER_GAP_SECONDS = 0.002      # Dips shorter than this inside a marker are sampling noise
+PROFILE_SECONDS = 60            # lcd_drive_sweep_seconds
+
+TIME_UNITS = {"s": 1.0, "ms": 1e-3, "us": 1e-6, "ns": 1e-9}
+CURRENT_UNITS = {"a": 1e6, "ma": 1e3, "ua": 1.0, "na": 1e-3}           # To uA
+
+
+def profile_names(path=FIRMWARE_SOURCE):
+    """(names in lcd_drive_profile_index_t in order, how many of them the sweep runs). ([], None) if we can not find the source."""
+    try:
+        with open(path, encoding="latin-1") as f:
+            text = f.read()
+    except OSError:
+        return [], None
+    m = re.search(r"enum\s+lcd_drive_profile_index_t\s*\{(.*?)\};", text, re.S)
+    if not m:
+        return [], None
+    body = re.sub(r"//[^\n]*", "", m.group(1))
+    names = [n for n in re.findall(r"\b(LCD_DRIVE_\w+)\s*,", body) if n != "LCD_DRIVE_PROFILE_COUNT"]
+    m = re.search(r"lcd_drive_sweep_count\s*=\s*(\w+)\s*;", text)
+    return names, (names.index(m.group(1)) if m and m.group(1) in names else None)
+
+
+def _column(header, words, units):
+    for i, name in enumerate(header):
+        m = re.match(r"\s*(\w+)[^(]*\(\s*(\w+)\s*\)", name)
+        if m and m.group(1).lower() in words and m.group(2).lower() in units:
+            return i, units[m.group(2).lower()]
+    raise SystemExit("no %s column with a unit in the header %s" % ("/".join(words), header))
+
+
+def read_capture(path):
+    """(seconds, uA) lists from a CSV capture"""
+    t, i = [], []
+    with open(path, newline="") as f:
+        rows = csv.reader(f)
+        header = next(rows)
+        tc, ts = _column(header, ("time", "timestamp"), TIME_UNITS)
+        ic, iscale = _column(header, ("current",), CURRENT_UNITS)
+        for row in rows:
+            if len(row) <= max(tc, ic):
+                continue
+            t.append(float(row[tc]) * ts)
+            i.append(float(row[ic]) * iscale)
+    if len(t) < 2:
+        raise SystemExit("%s has no samples" % path)
+    return t, i
+
+
+def find_markers(t, i, threshold_ua):
+    """[(start, end, index)] for each run above the threshold that is long enough to be a marker"""
+    markers = []
+    start = last = None
+    for ts, ua in zip(t, i):
+        if ua >= threshold_ua:
+            if start is None or ts - last > MARKER_GAP_SECONDS:
+                if start is not None:
+                    markers.append((start, last))
+                start = ts
+            last = ts
+    if start is not None:
+        markers.append((start, last))
+    period = (t[-1] - t[0]) / (len(t) - 1)         # The last sample above the threshold still counts for its whole period
+    out = []
+    for s, e in markers:
+        width = e - s + period
+        if width >= MARKER_MIN_SECONDS:
+            out.append((s, e, max(0, int(round(width / MARKER_STEP_SECONDS)) - 1)))
+    return out
+
+
+def average_ua(t, i, start, end):
+    """Time weighted average current over [start, end), and how many seconds of samples that was"""
+    q = 0.0
+    covered = 0.0
+    for k in range(len(t) - 1):
+        if t[k] < start or t[k] >= end:
+            continue
+        dt = min(t[k + 1], end) - t[k]
+        q += i[k] * dt
+        covered += dt
+    return (q / covered if covered else float("nan")), covered
+
+
+def split(t, i, threshold_ua, settle):
+    """One (index, start, average uA, seconds averaged, complete) per profile run in the capture"""
+    markers = find_markers(t, i, threshold_ua)
+    runs = []
+    for n, (s, e, index) in enumerate(markers):
+        if n + 1 < len(markers):
+            end, complete = markers[n + 1][0], True
+        else:
+            end, complete = t[-1], t[-1] - e >= PROFILE_SECONDS - 1
+        ua, covered = average_ua(t, i, e + settle, end)
+        if covered > 0:
+            runs.append((index, s, ua, covered, complete))
+    return runs
+
+
+def report(runs, names, out=sys.stdout):
+    def name(index):
+        return names[index] if index < len(names) else "profile %d?" % index
+
+    print("%10s  %-30s %10s %8s" % ("start s", "profile", "uA", "seconds"), file=out)
+    for index, start, ua, covered, complete in runs:
+        print("%10.1f  %-30s %10.3f %8.1f%s" % (start, name(index), ua, covered, "" if complete else "  (cut off)"), file=out)
+
+    print("", file=out)
+    print("%-34s %10s %6s" % ("profile", "uA", "runs"), file=out)
+    by_index = {}
+    for index, start, ua, covered, complete in runs:
+        if complete:
+            by_index.setdefault(index, []).append((ua, covered))
+    for index in sorted(by_index):
+        v = by_index[index]
+        avg = sum(ua * c for ua, c in v) / sum(c for ua, c in v)
+        print("%-34s %10.3f %6d" % ("%2d %s" % (index, name(index)), avg, len(v)), file=out)
+
+    # A marker width that does not come out to the next profile means we missed one or mis-measured a width
+    for (a, *_), (b, *_) in zip(runs, runs[1:]):
+        if b != a + 1 and b != 0:
+            print("\nWarning: profile %d came after %d. Check the threshold, or whether the capture dropped samples." % (b, a), file=out)
+            break
+
+
+def synth(path, profiles, passes=2, rate_hz=1000, seed=1):
+    """A made-up capture of the sweep: ~2uA per profile with some noise and a tick every second, with the markers in between"""
+    rnd = random.Random(seed)
+    levels = [2.0 - 0.1 * k for k in range(profiles)]
+    with open(path, "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["Time (ns)", "Current (nA)", "Voltage (mV)", "Energy (uJ)"])
+        t = 0.0
+        for _ in range(passes):
+            for k in range(profiles):
+                marker = (k + 1) * MARKER_STEP_SECONDS
+                for _ in range(int(round(marker * rate_hz))):
+                    w.writerow([int(t * 1e9), int(245000 + rnd.gauss(0, 2000)), 3500, 0])
+                    t += 1.0 / rate_hz
+                for n in range(int(PROFILE_SECONDS * rate_hz)):
+                    ua = levels[k] + rnd.gauss(0, 0.3)
+                    if n % rate_hz == 0:
+                        ua += 50                                # The tick, smeared over one sample
+                    w.writerow([int(t * 1e9), int(ua * 1000), 3500, 0])
+                    t += 1.0 / rate_hz
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("capture", nargs="?", help="CSV capture of a unit running the LCD drive sweep")
+    ap.add_argument("--threshold", type=float, default=100.0, metavar="UA", help="current that counts as the CPU being on (default 100uA)")
+    ap.add_argument("--settle", type=float, default=5.0, metavar="SECONDS", help="skip this long after each switch (default 5)")
+    ap.add_argument("--source", default=FIRMWARE_SOURCE, help="tsl-calibre-msp.cpp, for the profile names")
+    ap.add_argument("--synth", metavar="FILE", help="write a made-up capture of two passes to FILE and exit")
+    args = ap.parse_args()
+
+    names, sweep_count = profile_names(args.source)
+
+    if args.synth:
+        synth(args.synth, sweep_count or 8)
+        return
+
+    if not args.capture:
+        ap.error("need a capture")
+
+    t, i = read_capture(args.capture)
+    runs = split(t, i, args.threshold, args.settle)
+    if not runs:
+        raise SystemExit("no markers in %s. Is it a sweep unit, and is the capture fast enough to see a 10ms pulse?" % args.capture)
+    report(runs, names)
+
+
+if __name__ == "__main__":
+    main()
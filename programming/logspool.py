@@ -0,0 +1,155 @@
+"""
+logspool.py - Keep the commissioning log on disk first and send it to the google sheet in the background
+
+`append()` writes the record to the end of a local spool file and fsyncs it, and that is all the programming cycle waits
+for. A background thread sends whatever has not been sent yet to the app script in batches, and backs off and retries
+when the network or the app script is having a bad day. How far we got is kept in a second file, so nothing is lost or
+sent twice if the station crashes or gets closed with records still waiting - they just go out the next time it runs.
+
+    spool = LogSpool("log_spool.jsonl", logscript_url)
+    spool.start()
+    spool.append([device_uuid, firmware_hash, machine_uuid_string])     # Returns as soon as it is on disk
+    ...
+    spool.drain(10)                                                     # Give it a chance to catch up before we exit
+
+The spool itself is never trimmed, so it is also the local record of every unit we ever programmed (one JSON row per line,
+with the time it was programmed in front). With `url` set to "none" it is just that.
+
+You can point it at fake_appscript.py to try it without the network.
+"""
+
+import json
+import os
+import random
+import threading
+import time
+
+import addrow
+
+BATCH_SIZE = 50                 # Rows per request
+BACKOFF_FIRST_SECONDS = 1
+BACKOFF_MAX_SECONDS = 300
+
+
+def _timestamp():
+    # Same format the app script used to stamp rows with when they arrived. Now that they might arrive later, we stamp them here.
+    return time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime())
+
+
+class LogSpool:
+
+    def __init__(self, path, url):
+        self.path = path
+        self.sent_path = path + ".sent"
+        self.url = url
+        self.lock = threading.Lock()
+        self.wake = threading.Event()          # New rows to send. Only looked at while we are idle.
+        self.retry = threading.Event()         # Cuts a back off short. Only drain() sets it, not every append().
+        self.last_error = None
+        self.thread = None
+
+        self.fd = os.open(self.path, os.O_WRONLY | os.O_APPEND | os.O_CREAT, 0o644)
+        # If we crashed in the middle of an append, end that line so the next record does not get glued onto it
+        size = os.fstat(self.fd).st_size
+        if size:
+            with open(self.path, "rb") as f:
+                f.seek(size - 1)
+                if f.read(1) != b"\n":
+                    os.write(self.fd, b"\n")
+                    os.fsync(self.fd)
+
+    # ** Foreground
+
+    def append(self, values):
+        """Durably add a row. Returns once it is on disk, which is a few ms, not a network round trip."""
+        line = (json.dumps([_timestamp()] + list(values)) + "\n").encode("utf-8")
+        with self.lock:
+            os.write(self.fd, line)     # O_APPEND, so this is one write at the end of the file
+            os.fsync(self.fd)
+        self.wake.set()
+
+    def pending(self):
+        """How many rows have not been sent yet. Always 0 with no url, since they are not going anywhere."""
+        if self.url == "none":
+            return 0
+        rows, _ = self._unsent(None, warn=False)
+        return len(rows)
+
+    def start(self):
+        if self.url == "none":
+            return
+        self.thread = threading.Thread(target=self._run, name="log spool", daemon=True)
+        self.thread.start()
+
+    def drain(self, timeout):
+        """Wait up to `timeout` seconds for everything to be sent. Returns True if it all went. Anything left goes next time."""
+        if self.thread is None:
+            return True
+        deadline = time.time() + timeout
+        self.wake.set()
+        self.retry.set()
+        while self.pending():
+            if time.time() > deadline:
+                return False
+            time.sleep(0.1)
+        return True
+
+    # ** Background
+
+    def _sent_offset(self):
+        try:
+            with open(self.sent_path) as f:
+                return int(f.read().strip() or 0)
+        except FileNotFoundError:
+            return 0
+
+    def _set_sent_offset(self, offset):
+        # Write the new offset beside the old one and swap it in, so a crash leaves one or the other and never half of one
+        tmp = self.sent_path + ".tmp"
+        with open(tmp, "w") as f:
+            f.write("%d\n" % offset)
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(tmp, self.sent_path)
+
+    def _unsent(self, limit, warn=True):
+        """(rows, offset after them) for up to `limit` complete lines after the sent offset. Lines that are not JSON get skipped."""
+        offset = self._sent_offset()
+        rows = []
+        with open(self.path, "rb") as f:
+            f.seek(offset)
+            for line in f:
+                if not line.endswith(b"\n"):
+                    break                       # Still being written
+                offset += len(line)
+                try:
+                    rows.append(json.loads(line))
+                except ValueError:
+                    if warn:
+                        print(f"\nSkipping a damaged line in {self.path} at offset {offset - len(line)}")
+                    continue
+                if limit is not None and len(rows) == limit:
+                    break
+        return rows, offset
+
+    def _run(self):
+        backoff = BACKOFF_FIRST_SECONDS
+        while True:
+            rows, offset = self._unsent(BATCH_SIZE)
+            if offset == self._sent_offset():
+                self.wake.wait()
+                self.wake.clear()
+                continue
+            try:
+                if rows:
+                    addrow.send_rows(self.url, rows)
+                self._set_sent_offset(offset)
+                self.last_error = None
+                backoff = BACKOFF_FIRST_SECONDS
+            except Exception as e:
+                self.last_error = str(e)
+                # Back off with some jitter so a room full of stations does not all retry at the same moment. Units programmed meanwhile
+                # do not cut this short (they are safe in the spool and go with the next batch), so an outage does not get a retry per unit.
+                self.retry.wait(backoff * random.uniform(0.5, 1.0))
+                self.retry.clear()
+                backoff = min(backoff * 2, BACKOFF_MAX_SECONDS)
@@ -0,0 +1,135 @@
+// persistent_layout.hpp - persistent_data_t for host C++ tools
+//
+// GENERATED FROM persistent_schema.json BY gen_persistent.py. DO NOT EDIT.
+//
+// The structs are packed and the MSP430 is little endian, so on a little endian host a dump of the info FRAM *is* a
+// persistent_data_t. `view()` just points at it, so decoding a dump does not copy or unpack anything.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "persistent_layout.hpp overlays little endian dumps"
+#endif
+
+namespace persistent_layout {
+
+constexpr uint32_t PERSISTENT_BASE_ADDRESS = 0x1800;
+
+// persistent_counter_slot_t
+constexpr uint32_t PERSISTENT_COUNTER_SLOT_SIZE = 10;
+constexpr uint32_t PERSISTENT_COUNTER_SLOT_MINS_OFFSET = 0;
+constexpr uint32_t PERSISTENT_COUNTER_SLOT_DAYS_OFFSET = 2;
+constexpr uint32_t PERSISTENT_COUNTER_SLOT_CRC_OFFSET = 6;
+constexpr uint32_t PERSISTENT_COUNTER_SLOT_SEQ_OFFSET = 8;
+
+// persistent_data_t
+constexpr uint32_t PERSISTENT_DATA_SIZE = 64;
+constexpr uint32_t PERSISTENT_PROGRAMMED_TIME_OFFSET = 0;
+constexpr uint32_t PERSISTENT_LAUNCHED_TIME_OFFSET = 7;
+constexpr uint32_t PERSISTENT_INITALIZED_FLAG_OFFSET = 14;
+constexpr uint32_t PERSISTENT_COMMISISONED_FLAG_OFFSET = 16;
+constexpr uint32_t PERSISTENT_LAUNCHED_FLAG_OFFSET = 18;
+constexpr uint32_t PERSISTENT_PORSOLTCOUNT_OFFSET = 20;
+constexpr uint32_t PERSISTENT_TSL_POWERUP_COUNT_OFFSET = 22;
+constexpr uint32_t PERSISTENT_LEGACY_MINS_OFFSET = 24;
+constexpr uint32_t PERSISTENT_LEGACY_DAYS_OFFSET = 26;
+constexpr uint32_t PERSISTENT_LEGACY_UPDATE_FLAG_OFFSET = 30;
+constexpr uint32_t PERSISTENT_LEGACY_BACKUP_MINS_OFFSET = 32;
+constexpr uint32_t PERSISTENT_LEGACY_BACKUP_DAYS_OFFSET = 34;
+constexpr uint32_t PERSISTENT_COUNTER_SLOTS_OFFSET = 38;
+constexpr uint32_t PERSISTENT_COUNTER_SLOTS_COUNT = 2;
+constexpr uint32_t PERSISTENT_COUNTER_SLOTS_TOGGLE = 22;
+constexpr uint32_t PERSISTENT_IMAGE_CRC_OFFSET = 58;
+constexpr uint32_t PERSISTENT_RTC_PROFILE_CRC_OFFSET = 60;
+constexpr uint32_t PERSISTENT_LCD_DRIVE_PROFILE_OFFSET = 62;
+
+constexpr uint32_t PERSISTENT_SLOT_CRC_SEED = 0xFFFF;
+constexpr uint32_t PERSISTENT_IMAGE_CRC_START = 0xC400;
+constexpr uint32_t PERSISTENT_IMAGE_CRC_WORDS = 0x1E00;
+constexpr uint32_t PERSISTENT_IMAGE_CRC_SEED = 0xFFFF;
+constexpr uint32_t PERSISTENT_RTC_PROFILE_CRC_SEED = 0xFFFF;
+constexpr uint32_t PERSISTENT_LCD_DRIVE_KEY = 0xA500;
+constexpr uint32_t PERSISTENT_LCD_DRIVE_KEY_MASK = 0xFF00;
+constexpr uint32_t PERSISTENT_LCD_DRIVE_SWEEP = 0x00FF;
+constexpr uint32_t PERSISTENT_LCD_DRIVE_PROFILE_COUNT = 15;
+constexpr uint32_t PERSISTENT_LCD_DRIVE_EXTERNAL_VLCD_COUNT = 8;
+
+#pragma pack(push, 1)
+
+struct rv3032_time_block_t {
+    uint8_t sec_bcd;
+    uint8_t min_bcd;
+    uint8_t hour_bcd;
+    uint8_t weekday_bcd;
+    uint8_t date_bcd;
+    uint8_t month_bcd;
+    uint8_t year_bcd;
+};
+
+struct persistent_counter_slot_t {
+    uint16_t mins;
+    uint32_t days;
+    uint16_t crc;
+    uint16_t seq;
+};
+
+struct persistent_data_t {
+    rv3032_time_block_t programmed_time;
+    rv3032_time_block_t launched_time;
+    uint16_t initalized_flag;
+    uint16_t commisisoned_flag;
+    uint16_t launched_flag;
+    uint16_t porsoltCount;
+    uint16_t tsl_powerup_count;
+    uint16_t legacy_mins;
+    uint32_t legacy_days;
+    uint16_t legacy_update_flag;
+    uint16_t legacy_backup_mins;
+    uint32_t legacy_backup_days;
+    persistent_counter_slot_t counter_slots[2];
+    uint16_t image_crc;
+    uint16_t rtc_profile_crc;
+    uint16_t lcd_drive_profile;
+};
+
+#pragma pack(pop)
+
+static_assert( sizeof( rv3032_time_block_t ) == 7 , "layout" );
+static_assert( offsetof( rv3032_time_block_t , sec_bcd ) == 0 , "layout" );
+static_assert( offsetof( rv3032_time_block_t , min_bcd ) == 1 , "layout" );
+static_assert( offsetof( rv3032_time_block_t , hour_bcd ) == 2 , "layout" );
+static_assert( offsetof( rv3032_time_block_t , weekday_bcd ) == 3 , "layout" );
+static_assert( offsetof( rv3032_time_block_t , date_bcd ) == 4 , "layout" );
+static_assert( offsetof( rv3032_time_block_t , month_bcd ) == 5 , "layout" );
+static_assert( offsetof( rv3032_time_block_t , year_bcd ) == 6 , "layout" );
+static_assert( sizeof( persistent_counter_slot_t ) == 10 , "layout" );
+static_assert( offsetof( persistent_counter_slot_t , mins ) == 0 , "layout" );
+static_assert( offsetof( persistent_counter_slot_t , days ) == 2 , "layout" );
+static_assert( offsetof( persistent_counter_slot_t , crc ) == 6 , "layout" );
+static_assert( offsetof( persistent_counter_slot_t , seq ) == 8 , "layout" );
+static_assert( sizeof( persistent_data_t ) == 64 , "layout" );
+static_assert( offsetof( persistent_data_t , programmed_time ) == 0 , "layout" );
+static_assert( offsetof( persistent_data_t , launched_time ) == 7 , "layout" );
+static_assert( offsetof( persistent_data_t , initalized_flag ) == 14 , "layout" );
+static_assert( offsetof( persistent_data_t , commisisoned_flag ) == 16 , "layout" );
+static_assert( offsetof( persistent_data_t , launched_flag ) == 18 , "layout" );
+static_assert( offsetof( persistent_data_t , porsoltCount ) == 20 , "layout" );
+static_assert( offsetof( persistent_data_t , tsl_powerup_count ) == 22 , "layout" );
+static_assert( offsetof( persistent_data_t , legacy_mins ) == 24 , "layout" );
+static_assert( offsetof( persistent_data_t , legacy_days ) == 26 , "layout" );
+static_assert( offsetof( persistent_data_t , legacy_update_flag ) == 30 , "layout" );
+static_assert( offsetof( persistent_data_t , legacy_backup_mins ) == 32 , "layout" );
+static_assert( offsetof( persistent_data_t , legacy_backup_days ) == 34 , "layout" );
+static_assert( offsetof( persistent_data_t , counter_slots ) == 38 , "layout" );
+static_assert( offsetof( persistent_data_t , image_crc ) == 58 , "layout" );
+static_assert( offsetof( persistent_data_t , rtc_profile_crc ) == 60 , "layout" );
+static_assert( offsetof( persistent_data_t , lcd_drive_profile ) == 62 , "layout" );
+
+inline const persistent_data_t *view( const void *image ) {
+    return static_cast<const persistent_data_t *>( image );
+}
+
+}  // namespace persistent_layout
@@ -0,0 +1,136 @@
+"""
+persistent_layout.py - persistent_data_t as ctypes structures
+
+GENERATED FROM persistent_schema.json BY gen_persistent.py. DO NOT EDIT.
+
+Overlay these on a raw image of the info FRAM (starting at BASE_ADDRESS) to get at the fields in place, with no unpacking...
+
+    data = PersistentData.from_buffer(image)            # bytearray or mmap. Reads and writes go straight to the image.
+    data = PersistentData.from_buffer_copy(raw)         # Read only bytes
+    data.counter_slots[1].days
+
+For a whole file of back to back images, `(PersistentData * n).from_buffer(image)` maps them all at once.
+`FIELDS` has the offset and size of every field by its C name, like FIELDS["counter_slots[1].days"].
+"""
+
+import ctypes
+
+PERSISTENT_BASE_ADDRESS = 0x1800                        # Where the linker puts persistent_data (PERSISTANT in lnk_msp430fr4133.cmd)
+
+# persistent_counter_slot_t
+PERSISTENT_COUNTER_SLOT_SIZE = 10
+PERSISTENT_COUNTER_SLOT_MINS_OFFSET = 0
+PERSISTENT_COUNTER_SLOT_DAYS_OFFSET = 2
+PERSISTENT_COUNTER_SLOT_CRC_OFFSET = 6
+PERSISTENT_COUNTER_SLOT_SEQ_OFFSET = 8
+
+# persistent_data_t
+PERSISTENT_DATA_SIZE = 64
+PERSISTENT_PROGRAMMED_TIME_OFFSET = 0
+PERSISTENT_LAUNCHED_TIME_OFFSET = 7
+PERSISTENT_INITALIZED_FLAG_OFFSET = 14
+PERSISTENT_COMMISISONED_FLAG_OFFSET = 16
+PERSISTENT_LAUNCHED_FLAG_OFFSET = 18
+PERSISTENT_PORSOLTCOUNT_OFFSET = 20
+PERSISTENT_TSL_POWERUP_COUNT_OFFSET = 22
+PERSISTENT_LEGACY_MINS_OFFSET = 24
+PERSISTENT_LEGACY_DAYS_OFFSET = 26
+PERSISTENT_LEGACY_UPDATE_FLAG_OFFSET = 30
+PERSISTENT_LEGACY_BACKUP_MINS_OFFSET = 32
+PERSISTENT_LEGACY_BACKUP_DAYS_OFFSET = 34
+PERSISTENT_COUNTER_SLOTS_OFFSET = 38
+PERSISTENT_COUNTER_SLOTS_COUNT = 2
+PERSISTENT_COUNTER_SLOTS_TOGGLE = 22                    # XOR into the address of one of the counter_slots to get the other
+PERSISTENT_IMAGE_CRC_OFFSET = 58
+PERSISTENT_RTC_PROFILE_CRC_OFFSET = 60
+PERSISTENT_LCD_DRIVE_PROFILE_OFFSET = 62
+
+PERSISTENT_SLOT_CRC_SEED = 0xFFFF                       # Written to CRCINIRES before feeding a counter slot's days and seq into CRCDI. Same as CRC-CCITT, and free from the constant generator.
+PERSISTENT_IMAGE_CRC_START = 0xC400                     # Start of the program FRAM that `image_crc` covers (FRAM in lnk_msp430fr4133.cmd). It runs to the top of memory, so the vectors are in it too.
+PERSISTENT_IMAGE_CRC_WORDS = 0x1E00                     # 0xC400-0xFFFF, fed into CRCDI a word at a time
+PERSISTENT_IMAGE_CRC_SEED = 0xFFFF
+PERSISTENT_RTC_PROFILE_CRC_SEED = 0xFFFF                # Written to CRCINIRES before feeding the RV3032 EEPROM profile (address and value of each register) into CRCDI.
+PERSISTENT_LCD_DRIVE_KEY = 0xA500                       # High byte of `lcd_drive_profile` when it was really written. Anything else there (like a unit from before the field existed) means the production profile.
+PERSISTENT_LCD_DRIVE_KEY_MASK = 0xFF00
+PERSISTENT_LCD_DRIVE_SWEEP = 0x00FF                     # Low byte of `lcd_drive_profile` that runs the LCD drive characterization sweep at boot instead of the normal life cycle.
+PERSISTENT_LCD_DRIVE_PROFILE_COUNT = 15                 # How many entries `lcd_drive_profiles` has. A lower byte at or past this gets the production profile.
+PERSISTENT_LCD_DRIVE_EXTERNAL_VLCD_COUNT = 8            # Profiles below this take Vlcd from the TPS7A0228. The ones from here up make it on the chip and fight the regulator on a production board.
+BASE_ADDRESS = PERSISTENT_BASE_ADDRESS
+SIZE = PERSISTENT_DATA_SIZE
+
+
+class Rv3032TimeBlock(ctypes.LittleEndianStructure):
+    """rv3032_time_block_t"""
+    _pack_ = 1
+    _fields_ = [
+        ('sec_bcd', ctypes.c_uint8),
+        ('min_bcd', ctypes.c_uint8),
+        ('hour_bcd', ctypes.c_uint8),
+        ('weekday_bcd', ctypes.c_uint8),
+        ('date_bcd', ctypes.c_uint8),
+        ('month_bcd', ctypes.c_uint8),
+        ('year_bcd', ctypes.c_uint8),
+    ]
+
+
+class PersistentCounterSlot(ctypes.LittleEndianStructure):
+    """persistent_counter_slot_t"""
+    _pack_ = 1
+    _fields_ = [
+        ('mins', ctypes.c_uint16),
+        ('days', ctypes.c_uint32),
+        ('crc', ctypes.c_uint16),
+        ('seq', ctypes.c_uint16),
+    ]
+
+
+class PersistentData(ctypes.LittleEndianStructure):
+    """persistent_data_t"""
+    _pack_ = 1
+    _fields_ = [
+        ('programmed_time', Rv3032TimeBlock),
+        ('launched_time', Rv3032TimeBlock),
+        ('initalized_flag', ctypes.c_uint16),
+        ('commisisoned_flag', ctypes.c_uint16),
+        ('launched_flag', ctypes.c_uint16),
+        ('porsoltCount', ctypes.c_uint16),
+        ('tsl_powerup_count', ctypes.c_uint16),
+        ('legacy_mins', ctypes.c_uint16),
+        ('legacy_days', ctypes.c_uint32),
+        ('legacy_update_flag', ctypes.c_uint16),
+        ('legacy_backup_mins', ctypes.c_uint16),
+        ('legacy_backup_days', ctypes.c_uint32),
+        ('counter_slots', PersistentCounterSlot * 2),
+        ('image_crc', ctypes.c_uint16),
+        ('rtc_profile_crc', ctypes.c_uint16),
+        ('lcd_drive_profile', ctypes.c_uint16),
+    ]
+
+
+assert ctypes.sizeof(PersistentData) == SIZE
+
+FIELDS = {
+    'programmed_time':           (0, 7),
+    'launched_time':             (7, 7),
+    'initalized_flag':           (14, 2),
+    'commisisoned_flag':         (16, 2),
+    'launched_flag':             (18, 2),
+    'porsoltCount':              (20, 2),
+    'tsl_powerup_count':         (22, 2),
+    'legacy_mins':               (24, 2),
+    'legacy_days':               (26, 4),
+    'legacy_update_flag':        (30, 2),
+    'legacy_backup_mins':        (32, 2),
+    'legacy_backup_days':        (34, 4),
+    'counter_slots[0].mins':     (38, 2),
+    'counter_slots[0].days':     (40, 4),
+    'counter_slots[0].crc':      (44, 2),
+    'counter_slots[0].seq':      (46, 2),
+    'counter_slots[1].mins':     (48, 2),
+    'counter_slots[1].days':     (50, 4),
+    'counter_slots[1].crc':      (54, 2),
+    'counter_slots[1].seq':      (56, 2),
+    'image_crc':                 (58, 2),
+    'rtc_profile_crc':           (60, 2),
+    'lcd_drive_profile':         (62, 2),
+}
@@ -0,0 +1,95 @@
+"""
+persistent_time.py - Read and write the time since launch in a persistent_data image
+
+The same rules as persistent_newest_slot(), commit_persistent_time() and the boot code in main() (tsl-calibre-msp.cpp),
+for the tools that read or patch dumps. The layout comes from persistent_layout.py, so this only knows the logic.
+
+    data = persistent_layout.PersistentData.from_buffer(image)
+    days, mins, source = time_since_launch(data)        # What the unit would resume from if it booted now
+    commit_time(data, days, mins)                       # Patch the image like the firmware would
+
+It also has the CRC16 module's arithmetic, for the counter slots and for `image_crc` (program_fram_crc()).
+"""
+
+import struct
+
+import persistent_layout
+
+MINS_PER_DAY = 24 * 60
+
+# The MSP430 CRC16 module polynomial (CRC-CCITT)
+CRC_POLY = 0x1021
+
+
+def _crc_table():
+    """The CRC register after shifting in each possible top byte, for going a byte at a time instead of a bit."""
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ (CRC_POLY if crc & 0x8000 else 0)) & 0xFFFF
+        table.append(crc)
+    return table
+
+
+CRC_TABLE = _crc_table()
+BIT_REVERSED = [int("{:08b}".format(b)[::-1], 2) for b in range(256)]
+
+
+def crc16(data, seed):
+    """What the CRC module makes of `data` written to CRCDI a word at a time, starting from `seed`.
+    It takes each word low byte first (memory order) and each byte LSB first, so we bit reverse the bytes and do a normal CRC-CCITT."""
+    crc = seed
+    for b in data:
+        crc = ((crc << 8) & 0xFFFF) ^ CRC_TABLE[(crc >> 8) ^ BIT_REVERSED[b]]
+    return crc
+
+
+def slot_crc(days, seq):
+    """persistent_slot_crc() - days (low word first) and then seq."""
+    return crc16(struct.pack("<IH", days, seq), persistent_layout.PERSISTENT_SLOT_CRC_SEED)
+
+
+def image_crc(image):
+    """program_fram_crc() for a titxt.TiTxt firmware image, as it will be in FRAM after ERASE_MAIN and writing it (0xFF where it says nothing)."""
+    start = persistent_layout.PERSISTENT_IMAGE_CRC_START
+    return crc16(image.image(start, persistent_layout.PERSISTENT_IMAGE_CRC_WORDS * 2), persistent_layout.PERSISTENT_IMAGE_CRC_SEED)
+
+
+def newest_slot(data):
+    """Index of the counter slot that holds the current time, or None if neither is valid (never launched, or launched by legacy firmware)."""
+    newest = None
+    for i, slot in enumerate(data.counter_slots):
+        if slot.crc == slot_crc(slot.days, slot.seq):
+            if newest is None or 0 < (slot.seq - data.counter_slots[newest].seq) & 0xFFFF < 0x8000:
+                newest = i
+    return newest
+
+
+def time_since_launch(data):
+    """(days, mins, source) the way main() would find them at boot. `source` says where they came from."""
+    newest = newest_slot(data)
+    if newest is not None:
+        slot = data.counter_slots[newest]
+        days, mins, source = slot.days, slot.mins, "counter_slots[%d]" % newest
+    elif data.legacy_update_flag:
+        days, mins, source = data.legacy_backup_days, data.legacy_backup_mins, "legacy_backup (update_flag set)"
+    else:
+        days, mins, source = data.legacy_days, data.legacy_mins, "legacy"
+    if mins == MINS_PER_DAY:
+        days, mins = days + 1, 0
+    return days, mins, source
+
+
+def commit_time(data, days, mins):
+    """commit_persistent_time() - write the slot that is not the newest and make it the newest."""
+    newest = newest_slot(data)
+    if newest is None:
+        i, seq = 0, 0
+    else:
+        i, seq = 1 - newest, (data.counter_slots[newest].seq + 1) & 0xFFFF
+    slot = data.counter_slots[i]
+    slot.mins = mins
+    slot.days = days
+    slot.crc = slot_crc(days, seq)
+    slot.seq = seq
@@ -7,85 +7,37 @@ import sys
 import subprocess
 import time
 import datetime
+import ctypes
 
-from dataclasses import dataclass, fields
-from typing import Any
-
-from typing import List
+import persistent_layout
+import titxt
+from persistent_time import time_since_launch
 
 #MSPFlasher executable name
 mspflasher_name = "MSP430Flasher"
 
-#locate executable
-mspflasher_exec = shutil.which( mspflasher_name )
-#check that it was found
-if mspflasher_exec is None:
-    raise Exception("MSPFlasher executable must be in search path")
-
-
-@dataclass
-class RV3032TimeBlock:
-    sec_bcd: int
-    min_bcd: int
-    hour_bcd: int
-    weekday_bcd: int
-    date_bcd: int
-    month_bcd: int
-    year_bcd: int
-
-@dataclass
-class PersistentData:
-    programmed_time: RV3032TimeBlock
-    launched_time: RV3032TimeBlock
-    initalized_flag: int
-    commisisoned_flag: int
-    launched_flag: int
-    porsoltCount: int
-    tsl_powerup_count: int
-    mins: int
-    days: int
-    update_flag: int
-    backup_mins: int
-    backup_days: int
-
-def parse_persistent_data(byte_array: List[int]) -> PersistentData:
-    def parse_rv3032_time_block(offset: int) -> RV3032TimeBlock:
-        return RV3032TimeBlock(
-            sec_bcd=byte_array[offset],
-            min_bcd=byte_array[offset + 1],
-            hour_bcd=byte_array[offset + 2],
-            weekday_bcd=byte_array[offset + 3],
-            date_bcd=byte_array[offset + 4],
-            month_bcd=byte_array[offset + 5],
-            year_bcd=byte_array[offset + 6]
-        )
-
-    def parse_uint(offset: int) -> int:
-        return int.from_bytes(byte_array[offset:offset + 2], byteorder='little', signed=False)
-
-    def parse_ulong(offset: int) -> int:
-        return int.from_bytes(byte_array[offset:offset + 4], byteorder='little', signed=False)
-
-    return PersistentData(
-        programmed_time=parse_rv3032_time_block(0),
-        launched_time=parse_rv3032_time_block(7),
-        initalized_flag=parse_uint(14),
-        commisisoned_flag=parse_uint(16),
-        launched_flag=parse_uint(18),
-        porsoltCount=parse_uint(20),
-        tsl_powerup_count=parse_uint(22),
-        mins=parse_uint(24),
-        days=parse_ulong(26),
-        update_flag=parse_uint(30),
-        backup_mins=parse_uint(32),
-        backup_days=parse_ulong(34)
-    )
+# read through flashd.py instead if `tsl_flashd` is set (like "localhost:7430")
+flashd_address = os.environ.get( "tsl_flashd" )
+
+if flashd_address:
+    from flashd import FlasherSession
+else:
+    #locate executable
+    mspflasher_exec = shutil.which( mspflasher_name )
+    #check that it was found
+    if mspflasher_exec is None:
+        raise Exception("MSPFlasher executable must be in search path")
+
+
+# The layout is generated from persistent_schema.json, so this just overlays it on the dump
+def parse_persistent_data(byte_array: bytes) -> persistent_layout.PersistentData:
+    return persistent_layout.PersistentData.from_buffer_copy(byte_array[:persistent_layout.SIZE])
 
 def bcd_to_int(bcd_value: int) -> int:
     """Convert BCD (Binary Coded Decimal) to integer"""
     return ((bcd_value >> 4) * 10) + (bcd_value & 0x0F)
 
-def timeblock_to_datetime(timeblock: RV3032TimeBlock) -> datetime:
+def timeblock_to_datetime(timeblock: persistent_layout.Rv3032TimeBlock) -> datetime:
     return datetime.datetime(
         year=2000+bcd_to_int(timeblock.year_bcd),
         month=bcd_to_int(timeblock.month_bcd),
@@ -95,42 +47,21 @@ def timeblock_to_datetime(timeblock: RV3032TimeBlock) -> datetime:
         second=bcd_to_int(timeblock.sec_bcd)
     )
 
-def decode_titxt(titxt_data):
-
-    #lines = titxt_data.decode('utf-8')    
-
-    lines = titxt_data.splitlines()
-
-    # Remove any leading or trailing whitespace from each line
-    lines = [line.strip() for line in lines]
-
-    # Remove empty lines and comments
-    lines = [line for line in lines if line and not line.startswith('@') and not line.startswith('q')]
-
-    # Concatenate the data fields into a single string
-    data_string = ''.join(lines)
-
-    # Convert the hexadecimal string to a byte array
-    data_bytes = bytes.fromhex(data_string)
-
-    return data_bytes   
+def print_struct(obj, indent: int = 0):
 
+    for name, _ in obj._fields_:
 
-def print_dataclass(obj: Any, indent: int = 0):
-    
-    if not hasattr(obj, '__dataclass_fields__'):
-        print(f"{' ' * indent}{obj}")
-        return
-
-    for field in fields(obj):
-
-        value = getattr(obj, field.name)
+        value = getattr(obj, name)
 
-        if isinstance(value, (int, float, str, bool, type(None))):
-            print(f"{' ' * (indent + 2)}{field.name:<18}={value:>8} [{hex(value):>10}]")
+        if isinstance(value, int):
+            print(f"{' ' * (indent + 2)}{name:<18}={value:>8} [{hex(value):>10}]")
+        elif isinstance(value, ctypes.Array):
+            for i, element in enumerate(value):
+                print(f"{' ' * indent}*{name}[{i}]:")
+                print_struct(element, indent + 2)
         else:
-            print(f"{' ' * indent}*{field.name}:")
-            print_dataclass(value, indent + 2)
+            print(f"{' ' * indent}*{name}:")
+            print_struct(value, indent + 2)
 
     # add a blank line after each class type
     print( " " )
@@ -148,34 +79,45 @@ def dump():
         # 2. Decode and print the device info.
         # 3. Try look up device info in airtable. 
     
-        # start with executable
-        call_line = [mspflasher_exec]
+        user_file_name = os.path.join( tempdir , 'user.txt')
+
+        if flashd_address:
+
+            # flashd.py already has the EZ-FET open, so just ask it and write the same file MSP430Flasher would have
+            session = FlasherSession( flashd_address )
+            with open( user_file_name , 'wb' ) as file:
+                file.write( titxt.encode( [ ( 0x1800 , session.read_unit( 0x1800 , 0x100 ) ) ] ) )
+            session.close()
 
-        # -j fast means use the fastest clock speed so programming will go as quickly as possible (it still takes a couple seconds)
-        call_line +=[ "-j" , "fast" ]
+        else:
+
+            # start with executable
+            call_line = [mspflasher_exec]
+
+            # -j fast means use the fastest clock speed so programming will go as quickly as possible (it still takes a couple seconds)
+            call_line +=[ "-j" , "fast" ]
 
-        # dump the whole device descriptor table
-        # note that it would be nice to just dump the two parts we need (device_id & uuid), but there is an undocumented limitation
-        # in MSP430Flasher where if you try to do consecutive read operations, it just siliently ignores the second one. So instead
-        # we dump the whole table and will parse out the parts we care about later. 
-        # device desciptor table is in the MSP430FR4133 datasheet section 9.1
+            # dump the whole device descriptor table
+            # note that it would be nice to just dump the two parts we need (device_id & uuid), but there is an undocumented limitation
+            # in MSP430Flasher where if you try to do consecutive read operations, it just siliently ignores the second one. So instead
+            # we dump the whole table and will parse out the parts we care about later. 
+            # device desciptor table is in the MSP430FR4133 datasheet section 9.1
         
-        # Dump the device descirtor data from the MSP430 to a file named `dd.txt` in the temp directory. 
-        user_file_name = os.path.join( tempdir , 'user.txt')
-        call_line += [ "-r" , f"[{user_file_name},0x1800-0x18ff]" ]
+            # Dump the device descirtor data from the MSP430 to a file named `dd.txt` in the temp directory. 
+            call_line += [ "-r" , f"[{user_file_name},0x1800-0x18ff]" ]
                
-        # -z [VCC] leaves the device powered up via the EZ-FET programmer VCC pin (You should see the "First Start" message on the LCD display)
-        # call_line += ["-z" , "[VCC]"]
+            # -z [VCC] leaves the device powered up via the EZ-FET programmer VCC pin (You should see the "First Start" message on the LCD display)
+            # call_line += ["-z" , "[VCC]"]
         
-        print("STARING COMMAND:")
-        print(call_line)
+            print("STARING COMMAND:")
+            print(call_line)
 
-        result = subprocess.run( call_line , capture_output=False)
+            result = subprocess.run( call_line , capture_output=False)
 
-        # Check the return code and print the output
-        if result.returncode != 0:
-            print("MSPFlasher failed!")
-            exit(1)
+            # Check the return code and print the output
+            if result.returncode != 0:
+                print("MSPFlasher failed!")
+                exit(1)
 
         # Open the user data file for reading
         with open( user_file_name ,'rt') as file:
@@ -186,14 +128,15 @@ def dump():
             print(titxt_data)
 
             # Read the binary data from the file
-            data = decode_titxt(   titxt_data )
-
-            print("decoded user data:")            
-            print(  parse_persistent_data(data) )
+            data = titxt.TiTxt( titxt_data.encode() ).image( persistent_layout.BASE_ADDRESS , persistent_layout.SIZE )
 
             parsed_data = parse_persistent_data(data)
 
-            print_dataclass(  parsed_data )
+            print("decoded user data:")
+            print_struct(  parsed_data )
+
+            days, minutes, source = time_since_launch(parsed_data)
+            print(f"Persistent time since launch: {days} days {minutes} mins (from {source})")
 
             # Note that we handle all datetimes as naive UTC, so we don't need to worry about timezones
 
@@ -13,8 +13,14 @@ import uuid
 # we use this to make it possible to portably read a single keypress
 import getch
 
-# for logging to the google sheet
-import addrow
+# for logging to the google sheet (in the background, see logspool.py)
+from logspool import LogSpool
+
+# for the local database of every unit we program
+import unitdb
+
+# the per-unit image and reading the device descriptors are shared with station.py, which does several fixtures at once
+from station import FirmwareImage, get_ddid_from_file
 
 #MSPFlasher executable name
 mspflasher_name = "MSP430Flasher"
@@ -37,6 +43,25 @@ relay_enabled = False
 print( f"Relay port: {relay_port_name}" )
 print( f"Logscript url: {logscript_url}" )  
 
+# log records go to this file first and get sent to the google sheet in the background, so a slow or down network
+# never holds up the next unit. anything not sent when we exit goes out the next time we run.
+logspool_file_name = os.environ.get( "tsl_logspool" , "log_spool.jsonl" )
+log_spool = LogSpool( logspool_file_name , logscript_url )
+log_spool.start()
+print( f"Log spool: {logspool_file_name} ({log_spool.pending()} records waiting to be sent)" )
+
+# every unit also goes in the local database, so we can look it up later without the google sheet (see unitdb.py)
+unit_db = unitdb.UnitDB()
+print( f"Unit database: {unit_db.path}" )
+
+# give the log a few seconds to catch up before we go
+def exit_after_log( code ):
+    if ( logscript_enabled ):
+        print( "Sending any waiting log records..." )
+        if not log_spool.drain( 10 ):
+            print( f"{log_spool.pending()} log records not sent yet ({log_spool.last_error}). They will be sent next time." )
+    exit( code )
+
 if (relay_port_name != "none"):
 
     import serial
@@ -70,13 +95,27 @@ if (relay_port_name != "none"):
     # remeber that we are configured to measure power
     relay_enabled = True
 
-#locate MSP430Flasher executable
-mspflasher_exec = shutil.which( mspflasher_name )
-#check that it was found
-if mspflasher_exec is None:
-    raise Exception("MSPFlasher executable must be in search path")  
+# if `tsl_flashd` is set (like "localhost:7430"), we program through flashd.py, which keeps the EZ-FET open between units,
+# instead of starting MSP430Flasher for each one
+flashd_address = os.environ.get( "tsl_flashd" )
+flashd_session = None
+
+if flashd_address:
+
+    from flashd import FlasherSession
+
+    print( f"Connecting to flashd at {flashd_address}..." )
+    flashd_session = FlasherSession( flashd_address )
+
+else:
+
+    #locate MSP430Flasher executable
+    mspflasher_exec = shutil.which( mspflasher_name )
+    #check that it was found
+    if mspflasher_exec is None:
+        raise Exception("MSPFlasher executable must be in search path")  
 
-print( f"Using MSPFlasher executable at {mspflasher_exec}" )
+    print( f"Using MSPFlasher executable at {mspflasher_exec}" )
 
 machine_uuid_string = str(uuid.UUID(int=uuid.getnode()))
 print( f"Machine UUID: {machine_uuid_string}" )
@@ -88,66 +127,6 @@ def print_bytes_as_table(data):
         hex_line = ' '.join(f'{b:02X}' for b in line)
         print(f'{i:04X}: {hex_line}')
 
-""" Read in a firmware image file in TI txt format and return a byte array """
-def decode_titxt(titxt_data):
-
-    #lines = titxt_data.decode('utf-8')    
-
-    lines = titxt_data.splitlines()
-
-    # Remove any leading or trailing whitespace from each line
-    lines = [line.strip() for line in lines]
-
-    # Remove empty lines and comments
-    lines = [line for line in lines if line and not line.startswith('@') and not line.startswith('q')]
-
-    # Concatenate the data fields into a single string
-    data_string = ''.join(lines)
-
-    # Convert the hexadecimal string to a byte array
-    data_bytes = bytes.fromhex(data_string)
-
-    return data_bytes   
-
-
-    # Lets grab the UUID and device info from the device descripto dump and make them into a serial number
-    # these are in TI HEX format so we have to throw away the first line and then strip out all whitespace from the second line to get a clean hex digit string
-
-def get_ddid_from_file( dd_file_name ):
-    with open(dd_file_name,"r") as f:
-        # throw away the address line
-        f.readline()
-                
-        # grab first and second line and strip all whitespace
-        line1 = f.readline()
-        line2 = f.readline()
-        
-        # now line1 is bytes 0x1a00-0x1a0f of the device desriptor table as ascii hex digits
-        # now line2 is bytes 0x1a10-0x1a11 of the device desriptor table as ascii hex digits
-        
-        # make all the read bytes into a single linear array
-        dd_hex_bytes = (line1+line2).split()
-
-        # note in all the extractions below that in Python string slices, the end index is one past the index               
-                                        
-        # device info is 0x1a04-0x1a07 (4 bytes)
-        device_info =  dd_hex_bytes[ 0x04 : 0x08 ]
-
-        # Lot waffer ID 0x1a0a-0x1a0d
-        lot_waffer = dd_hex_bytes[ 0x0a : 0x0e ]
-        
-        # Die X pos 0x1a0e-0x1a0f               
-        die_x_pos =  dd_hex_bytes[ 0x0e : 0x10 ]
-        
-        # Die Y pos 0x1a10-0x1a11
-        die_y_pos = dd_hex_bytes[ 0x10 : 0x12 ]
-        
-        # I know this is ugly, but seems to be the phythonic way to join these all into a string with no seporator.
-        # Do you know a better way? 
-        device_uuid = "".join(device_info+lot_waffer+die_x_pos+die_y_pos)
-
-        return device_uuid
-
 # enter interactive TSL programming loop
 def program_loop():
 
@@ -160,10 +139,14 @@ def program_loop():
     with open(firmware_file_name, 'rb') as file:
         data = file.read()
 
+    # Every unit gets the same image except for the programmed_time timestamp, so we make the image once here and then just
+    # patch the 7 timestamp bytes in place for each unit.
+    image = FirmwareImage( data )
+
     # cacluate the hash of the firmware file
-    firmware_hash = hashlib.md5(data).hexdigest()
+    firmware_hash = image.hash
 
-    print( f"Firmware hash is {firmware_hash}\n")
+    print( f"Firmware hash is {firmware_hash}, CRC is {image.crc:04X}\n")
 
     # repeat programming cycle until user quits or error
     while True: 
@@ -191,7 +174,7 @@ def program_loop():
 
         if key != ' ':
             print(f"Exited by user, key = {key}")
-            exit(0)
+            exit_after_log(0)
 
         print("Programming cycle started.")
 
@@ -211,15 +194,10 @@ def program_loop():
                 # get the current GMT time
                 t = time.gmtime()                
 
-                # prepend a time stamp (in TI HEX format)
+                # stamp it into the image (as BCD, like the RV3032 time registers)
                 # 1800 is the begining of "information memory" FRAM.
-                wfd.write("@1800\n".encode())
-                wfd.write(f"{t.tm_sec:02d} {t.tm_min:02d} {t.tm_hour:02d} {t.tm_wday:02d} {t.tm_mday:02d} {t.tm_mon:02d} {t.tm_year%100:02d}\n".encode())
-                    
-                # ...and append firmware file into the image file
-                # note that the firmware comes last becuase the TI tools add a "q" to the end of this file.
-                with open('tsl-calibre-msp.txt','rb') as rfd:
-                    shutil.copyfileobj(rfd, wfd)
+                image_text = image.stamp( t )
+                wfd.write( image_text )
 
                 # If you ever need to read the commisioned time out of a unit, you can use the command...
                 # MSP430Flasher.exe -j fast -r [commisioned_time.txt,0x1800-0x1806] -z [VCC]
@@ -232,49 +210,62 @@ def program_loop():
             # 2. Erase the FRAM. 
             # 3. Burn the combined image into the unit.
         
-            # start with executable
-            call_line = [mspflasher_exec]
-
-            # -j fast means use the fastest clock speed so programming will go as quickly as possible (it still takes a couple seconds)
-            call_line +=[ "-j" , "fast" ]
-
-            # dump the whole device descriptor table
-            # note that it would be nice to just dump the two parts we need (device_id & uuid), but there is an undocumented limitation
-            # in MSP430Flasher where if you try to do consecutive read operations, it just siliently ignores the second one. So instead
-            # we dump the whole table and will parse out the parts we care about later. 
-            # device desciptor table is in the MSP430FR4133 datasheet section 9.1
+            if ( flashd_session is not None ):
+
+                # same steps through the EZ-FET session that flashd.py keeps open, so no MSP430Flasher start up for every unit
+                print("Reading device ID and UUID, erasing FRAM, and writing firmware image through flashd...")
+                try:
+                    # verified by reading back the CRC the unit computes of itself on its first boot, instead of reading back the whole image
+                    device_uuid = unitdb.device_uuid( flashd_session.program( image_text , image.crc ) )
+                except ( RuntimeError , OSError ) as e:
+                    print( f"flashd failed! {e}" )
+                    exit_after_log(1)
+
+            else:
+
+                # start with executable
+                call_line = [mspflasher_exec]
+
+                # -j fast means use the fastest clock speed so programming will go as quickly as possible (it still takes a couple seconds)
+                call_line +=[ "-j" , "fast" ]
+
+                # dump the whole device descriptor table
+                # note that it would be nice to just dump the two parts we need (device_id & uuid), but there is an undocumented limitation
+                # in MSP430Flasher where if you try to do consecutive read operations, it just siliently ignores the second one. So instead
+                # we dump the whole table and will parse out the parts we care about later. 
+                # device desciptor table is in the MSP430FR4133 datasheet section 9.1
             
-            # Dump the device descirtor data from the MSP430 to a file named `dd.txt` in the temp directory. 
-            dd_file_name = os.path.join( tempdir , 'dd.txt')
-            call_line += [ "-r" , f"[{dd_file_name},0x1a00-0x1a12]" ]
+                # Dump the device descirtor data from the MSP430 to a file named `dd.txt` in the temp directory. 
+                dd_file_name = os.path.join( tempdir , 'dd.txt')
+                call_line += [ "-r" , f"[{dd_file_name},0x1a00-0x1a12]" ]
             
-            # -e ERASE_MAIN prepares the FRAM to recieve the firmware download
-            call_line += ["-e","ERASE_MAIN"]
+                # -e ERASE_MAIN prepares the FRAM to recieve the firmware download
+                call_line += ["-e","ERASE_MAIN"]
             
-            #program in the firmware image we created earlier
-            call_line += ["-w" , image_file_name ]
+                #program in the firmware image we created earlier
+                call_line += ["-w" , image_file_name ]
             
-            # -v verifies the contents of the FRAM match the firmware image file
-            call_line += ["-v"]
+                # -v verifies the contents of the FRAM match the firmware image file
+                call_line += ["-v"]
             
 
-            # TODO TEMP
-            # -z [VCC] leaves the device powered up via the EZ-FET programmer VCC pin (You should see the "First Start" message on the LCD display)
-            call_line += ["-z" , "[VCC]"]
+                # TODO TEMP
+                # -z [VCC] leaves the device powered up via the EZ-FET programmer VCC pin (You should see the "First Start" message on the LCD display)
+                call_line += ["-z" , "[VCC]"]
             
-            print("Powering up TSL, reading device ID and UUID, erasing FRAM, and writing firmware image...")
-            print("STARING COMMAND:")
-            print(call_line)
+                print("Powering up TSL, reading device ID and UUID, erasing FRAM, and writing firmware image...")
+                print("STARING COMMAND:")
+                print(call_line)
 
-            result = subprocess.run( call_line , capture_output=False)
+                result = subprocess.run( call_line , capture_output=False)
 
-            # Check the return code and print the output
-            if result.returncode != 0:
-                print("MSPFlasher failed!")
-                exit(1)
+                # Check the return code and print the output
+                if result.returncode != 0:
+                    print("MSPFlasher failed!")
+                    exit_after_log(1)
         
-            # Lets grab the UUID and device info from the device descriptor dump we just grabbed above and make them into a serial number
-            device_uuid = get_ddid_from_file( dd_file_name )
+                # Lets grab the UUID and device info from the device descriptor dump we just grabbed above and make them into a serial number
+                device_uuid = get_ddid_from_file( dd_file_name )
                         
             print( f"Device UUID is {device_uuid}")
 
@@ -288,10 +279,11 @@ def program_loop():
                 print("Powering down device and fixture...")
                 relay_open()
 
-            if ( logscript_enabled ):
-                print( "Adding record to log...")
-                addrow.send_data_to_sheet(logscript_url,[device_uuid,firmware_hash,machine_uuid_string])
-                print("Success!")  
+            unit_db.add_programmed( device_uuid , unitdb.iso_time( t ) , firmware_hash , machine_uuid_string )
+
+            # on disk when this returns, the google sheet gets it in the background
+            log_spool.append( [device_uuid,firmware_hash,machine_uuid_string] )
+            print( f"Added record to log ({log_spool.pending()} waiting to be sent)." )
 
             
 # If we started from command line and there is a argument
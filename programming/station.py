@@ -0,0 +1,421 @@
+#!/usr/bin/env python3
+"""
+station.py - Program TSLs on several fixtures at once
+
+program.py does one board at a time, and most of each cycle is waiting - for MSP430Flasher, for the LEDs to flash, for
+the relay. Here each fixture (its own EZ-FET and its own relay) is an independent pipeline in its own thread, so while
+one fixture is flashing another can be waiting for its LEDs, and the log goes out in the background (logspool.py).
+If one fixture fails, it shows FAILED and the others keep going.
+
+The fixtures are described in a JSON file...
+
+    {
+        "flasher": ["MSP430Flasher"],
+        "fixtures": [
+            { "name": "A", "interface": "COM5", "relay": "COM7" },
+            { "name": "B", "interface": "COM6", "relay": "none" }
+        ]
+    }
+
+`interface` is what MSP430Flasher takes after -i to pick the EZ-FET (listports.py can help find it). `relay` is the
+serial port of that fixture's relay, or `none`, or `fake` to just print what the relay would do. A fixture with
+`"flashd": "localhost:7430"` programs through that flashd.py instead of starting MSP430Flasher for every unit.
+
+    python3 station.py fixtures.json                # Press 1-9 to start that fixture, 'a' for all idle ones, 'q' to quit
+    python3 station.py fixtures.json --units 5      # No keyboard. Program 5 units on every fixture and exit.
+
+To try it without hardware, point `flasher` at the stand-in and use fake relays...
+
+    { "flasher": ["python3", "fake_msp430flasher.py"], "fixtures": [ { "name": "A", "interface": "FAKE1", "relay": "fake" }, ... ] }
+
+The google sheet log uses the `tsl_logscript` environment variable, and the spool file `tsl_logspool`, like program.py.
+Every unit also goes in the local database (`tsl_unitdb`, see unitdb.py).
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import queue
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import uuid
+
+import titxt
+from logspool import LogSpool
+from unitdb import UnitDB, iso_time, device_uuid as device_uuid_from_descriptors
+from flashd import FlasherSession
+import persistent_layout
+from persistent_time import image_crc
+
+FIRMWARE_FILE_NAME = "tsl-calibre-msp.txt"
+
+RELAY_SETTLE_SECONDS = 0.2      # Give the relay a little bit of time to close or open
+FLASH_WAIT_SECONDS = 2          # Allow a moment for the LEDs to flash and the 1uF capacitor to charge before we pull the power
+
+STATUS_INTERVAL_SECONDS = 0.5
+LOG_DRAIN_SECONDS = 10          # How long we wait at exit for the log to be sent. Whatever is left goes next time.
+
+
+def bcd(v):
+    return ((v // 10) << 4) | (v % 10)
+
+
+# Lets grab the UUID and device info from the device descriptor dump and make them into a serial number
+# these are in TI HEX format so we have to throw away the first line and then strip out all whitespace from the second line to get a clean hex digit string
+
+def get_ddid_from_file(dd_file_name):
+    with open(dd_file_name, "r") as f:
+        # throw away the address line
+        f.readline()
+
+        # grab first and second line and strip all whitespace
+        line1 = f.readline()
+        line2 = f.readline()
+
+        # now line1 is bytes 0x1a00-0x1a0f of the device desriptor table as ascii hex digits
+        # now line2 is bytes 0x1a10-0x1a11 of the device desriptor table as ascii hex digits
+
+        # make all the read bytes into a single linear array
+        dd_hex_bytes = (line1 + line2).split()
+
+        # note in all the extractions below that in Python string slices, the end index is one past the index
+
+        # device info is 0x1a04-0x1a07 (4 bytes)
+        device_info = dd_hex_bytes[0x04:0x08]
+
+        # Lot waffer ID 0x1a0a-0x1a0d
+        lot_waffer = dd_hex_bytes[0x0a:0x0e]
+
+        # Die X pos 0x1a0e-0x1a0f
+        die_x_pos = dd_hex_bytes[0x0e:0x10]
+
+        # Die Y pos 0x1a10-0x1a11
+        die_y_pos = dd_hex_bytes[0x10:0x12]
+
+        return "".join(device_info + lot_waffer + die_x_pos + die_y_pos)
+
+
+class FirmwareImage:
+    """The firmware with a programmed_time section in front of it. Every unit gets the same image except for those 7 bytes,
+    so we build it once and then just patch the timestamp in place for each unit.
+
+    It also presets `image_crc` to the complement of `crc`, the CRC the unit should find for its program FRAM on its first
+    boot. Reading `crc` back from there afterwards (FlasherSession.program()) verifies the write without reading it all back.
+
+    `lcd_drive` is the LCD drive profile index for `lcd_drive_profile` (0 is production), or "sweep" for the characterization
+    sweep. We always write it, so a bench unit that was sweeping goes back to production when it gets programmed again."""
+
+    PROGRAMMED_TIME_ADDRESS = persistent_layout.BASE_ADDRESS + persistent_layout.PERSISTENT_PROGRAMMED_TIME_OFFSET
+    IMAGE_CRC_ADDRESS = persistent_layout.BASE_ADDRESS + persistent_layout.PERSISTENT_IMAGE_CRC_OFFSET
+    LCD_DRIVE_PROFILE_ADDRESS = persistent_layout.BASE_ADDRESS + persistent_layout.PERSISTENT_LCD_DRIVE_PROFILE_OFFSET
+
+    def __init__(self, firmware, lcd_drive=0):
+        self.hash = hashlib.md5(firmware).hexdigest()
+        self.crc = image_crc(titxt.TiTxt(firmware))
+        lcd_drive = persistent_layout.PERSISTENT_LCD_DRIVE_KEY | (persistent_layout.PERSISTENT_LCD_DRIVE_SWEEP if lcd_drive == "sweep" else lcd_drive)
+        # Note that the firmware comes last becuase the TI tools add a "q" to the end of this file.
+        info = [(self.PROGRAMMED_TIME_ADDRESS, bytes(7)), (self.IMAGE_CRC_ADDRESS, (self.crc ^ 0xFFFF).to_bytes(2, "little")),
+                (self.LCD_DRIVE_PROFILE_ADDRESS, lcd_drive.to_bytes(2, "little"))]
+        self.image = titxt.TiTxt(bytearray(titxt.encode(info, last=False) + firmware))
+
+    def stamp(self, t):
+        """The image, with `t` (a time.gmtime()) as the programmed_time. BCD, like the RV3032 time registers."""
+        self.image.patch(self.PROGRAMMED_TIME_ADDRESS, bytes(bcd(v) for v in (t.tm_sec, t.tm_min, t.tm_hour, t.tm_wday, t.tm_mday, t.tm_mon, t.tm_year % 100)))
+        return self.image.text
+
+
+# ** Relays
+
+class SerialRelay:
+
+    def __init__(self, port_name):
+        import serial
+        self.port = serial.Serial(port=port_name, timeout=1)
+
+    # this silly protocol is defined at http://www.chinalctech.com/cpzx/Programmer/Relay_Module/115.html
+    def set(self, relay_index, relay_state):
+        self.port.write(bytearray([0xa0, relay_index, relay_state, (0xa0 + relay_index + relay_state)]))
+        self.port.flush()
+
+    def close(self):
+        self.set(1, 1)
+        time.sleep(RELAY_SETTLE_SECONDS)
+
+    def open(self):
+        self.set(1, 0)
+        time.sleep(RELAY_SETTLE_SECONDS)
+
+
+class FakeRelay:
+    """Stands in for a relay so the station can run without one. Keeps track of the state so a test can check it."""
+
+    def __init__(self, name):
+        self.name = name
+        self.closed = False
+
+    def close(self):
+        self.closed = True
+        time.sleep(RELAY_SETTLE_SECONDS)
+
+    def open(self):
+        self.closed = False
+        time.sleep(RELAY_SETTLE_SECONDS)
+
+
+class NoRelay:
+
+    def close(self):
+        pass
+
+    def open(self):
+        pass
+
+
+def open_relay(port_name):
+    if port_name == "none":
+        return NoRelay()
+    if port_name == "fake":
+        return FakeRelay(port_name)
+    return SerialRelay(port_name)
+
+
+# ** Fixtures
+
+class Fixture(threading.Thread):
+    """One fixture, programming one unit each time it is started."""
+
+    def __init__(self, index, config, flasher, firmware, log, lcd_drive=0):
+        super().__init__(name="fixture %s" % config["name"], daemon=True)
+        self.index = index
+        self.fixture_name = config["name"]
+        self.interface = config.get("interface")
+        self.relay = open_relay(config.get("relay", "none"))
+        self.flasher = flasher
+        self.flashd = config.get("flashd")              # "host:port" of a flashd.py for this fixture's EZ-FET, instead of MSP430Flasher
+        self.session = None
+        self.image = FirmwareImage(firmware, lcd_drive) # Each fixture patches its own copy
+        self.log = log
+
+        self.state = "idle"
+        self.last = ""                                  # The device UUID or error from the last unit
+        self.passed = 0
+        self.failed = 0
+        self.starts = queue.Queue()
+
+        # default relay is open, only close it if we are actually programming
+        # this keeps the pins disconnected from power when we are inserting and removing the TSL from the fixture
+        self.relay.open()
+
+    def start_unit(self):
+        """Program the unit that is in the fixture now. Ignored if we are already busy."""
+        if self.state in ("idle", "done", "FAILED"):
+            self.state = "starting"
+            self.starts.put(True)
+            return True
+        return False
+
+    def run(self):
+        while self.starts.get():
+            try:
+                self.last = self.program_unit()
+                self.passed += 1
+                self.state = "done"
+            except Exception as e:
+                self.failed += 1
+                self.last = str(e)
+                self.state = "FAILED"
+                try:
+                    self.relay.open()
+                except Exception:
+                    pass
+
+    def stop(self):
+        self.starts.put(False)
+
+    def program_unit(self):
+        self.state = "power on"
+        self.relay.close()
+
+        self.state = "flashing"
+        programmed_time = time.gmtime()
+        if self.flashd:
+            device_uuid = self.flash_with_flashd(programmed_time)
+        else:
+            device_uuid = self.flash_with_msp430flasher(programmed_time)
+
+        # Let the LEDs flash. The other fixtures carry on meanwhile.
+        self.state = "flash wait"
+        time.sleep(FLASH_WAIT_SECONDS)
+
+        self.state = "power off"
+        self.relay.open()
+
+        self.log(device_uuid, iso_time(programmed_time), self.image.hash, self.fixture_name)
+        return device_uuid
+
+    def flash_with_msp430flasher(self, programmed_time):
+        # Create a temp directory for the files we are creating (will auto delete everything when pass finished)
+        with tempfile.TemporaryDirectory() as tempdir:
+
+            image_file_name = os.path.join(tempdir, "image.txt")
+            with open(image_file_name, "wb") as wfd:
+                wfd.write(self.image.stamp(programmed_time))
+
+            # Same steps as program.py: read the device descriptors, erase, write, verify, and leave the unit powered
+            dd_file_name = os.path.join(tempdir, "dd.txt")
+            call_line = list(self.flasher) + ["-j", "fast"]
+            if self.interface:
+                call_line += ["-i", self.interface]
+            call_line += ["-r", f"[{dd_file_name},0x1a00-0x1a12]", "-e", "ERASE_MAIN", "-w", image_file_name, "-v", "-z", "[VCC]"]
+
+            result = subprocess.run(call_line, stdout=subprocess.DEVNULL, stderr=subprocess.STDOUT)
+            if result.returncode != 0:
+                raise RuntimeError(f"MSPFlasher failed (return {result.returncode})")
+
+            return get_ddid_from_file(dd_file_name)
+
+    def flash_with_flashd(self, programmed_time):
+        # Same steps, through the EZ-FET session flashd.py keeps open, so no per-unit MSP430Flasher start up
+        if self.session is None:
+            self.session = FlasherSession(self.flashd)
+        try:
+            return device_uuid_from_descriptors(self.session.program(self.image.stamp(programmed_time), self.image.crc))
+        except OSError:
+            self.session = None                         # Reconnect next time in case flashd was restarted
+            raise
+
+
+# ** Station
+
+def status_line(fixtures, spool):
+    parts = [f"{f.index}:{f.fixture_name} {f.state:<10} ok={f.passed} bad={f.failed}" for f in fixtures]
+    return " | ".join(parts) + f" | log waiting {spool.pending()}"
+
+
+def run_interactive(fixtures, spool):
+    import getch
+
+    print("Press 1-9 to start that fixture, 'a' to start every idle fixture, any other key to exit...")
+    last_printed = None
+    while True:
+        if getch.key_available():
+            key = getch.getch()
+            if key is None:
+                continue
+            if key.lower() == "a":
+                for f in fixtures:
+                    f.start_unit()
+            elif key.isdigit() and 1 <= int(key) <= len(fixtures):
+                if not fixtures[int(key) - 1].start_unit():
+                    print(f"\nFixture {key} is busy.")
+            else:
+                print(f"\nExited by user, key = {key}")
+                return
+        line = status_line(fixtures, spool)
+        if line != last_printed:
+            print("\r" + line, end="", flush=True)
+            last_printed = line
+        time.sleep(0.05)
+
+
+def run_units(fixtures, spool, units):
+    """Program `units` units on every fixture with no operator, like a burn in. Each fixture starts its next unit as soon as it is done."""
+    remaining = {f: units for f in fixtures}
+    for f in fixtures:
+        f.start_unit()
+        remaining[f] -= 1
+    while True:
+        for f in fixtures:
+            if remaining[f] and f.state in ("done", "FAILED"):
+                f.start_unit()
+                remaining[f] -= 1
+        if not any(remaining.values()) and all(f.state in ("done", "FAILED") for f in fixtures):
+            return
+        print("\r" + status_line(fixtures, spool), end="", flush=True)
+        time.sleep(STATUS_INTERVAL_SECONDS)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("config", help="JSON file describing the fixtures")
+    ap.add_argument("--units", type=int, help="program this many units on every fixture without waiting for keys, then exit")
+    ap.add_argument("--firmware", default=FIRMWARE_FILE_NAME, help="firmware in TI-TXT format (default %s)" % FIRMWARE_FILE_NAME)
+    ap.add_argument("--lcd-drive", default="0", metavar="N|sweep",
+                    help="LCD drive profile index (default 0, production), or `sweep` to make bench units for lcd_sweep.py")
+    ap.add_argument("--lcd-drive-unsafe", action="store_true",
+                    help="allow the LCD drive profiles that make Vlcd on the chip. They fight the regulator on a production board.")
+    args = ap.parse_args()
+
+    if args.units is not None and args.units < 1:
+        ap.error("--units must be at least 1")
+
+    if args.lcd_drive == "sweep":
+        lcd_drive = args.lcd_drive
+    else:
+        try:
+            lcd_drive = int(args.lcd_drive, 0)
+        except ValueError:
+            ap.error("--lcd-drive must be a profile index or `sweep`, not %r" % args.lcd_drive)
+        if not 0 <= lcd_drive < persistent_layout.PERSISTENT_LCD_DRIVE_PROFILE_COUNT:
+            ap.error("--lcd-drive %d is not a profile. There are %d." % (lcd_drive, persistent_layout.PERSISTENT_LCD_DRIVE_PROFILE_COUNT))
+        if lcd_drive >= persistent_layout.PERSISTENT_LCD_DRIVE_EXTERNAL_VLCD_COUNT and not args.lcd_drive_unsafe:
+            ap.error("--lcd-drive %d makes Vlcd on the chip, which fights the TPS7A0228 on a production board. Add --lcd-drive-unsafe if this board does not have one."
+                     % lcd_drive)
+
+    with open(args.config) as f:
+        config = json.load(f)
+
+    logscript_url = os.environ.get("tsl_logscript")
+    if logscript_url is None:
+        print("Please set the `tsl_logscript` environment variable. It can be set to `none` if not needed.")
+        sys.exit(1)
+
+    print(f"Loading {args.firmware} into memory...")
+    with open(args.firmware, "rb") as f:
+        firmware = f.read()
+
+    machine_uuid_string = str(uuid.UUID(int=uuid.getnode()))
+    spool = LogSpool(os.environ.get("tsl_logspool", "log_spool.jsonl"), logscript_url)
+    spool.start()
+
+    unit_db = UnitDB()
+    print(f"Unit database is {unit_db.path}")
+
+    def log(device_uuid, programmed_time, firmware_hash, fixture_name):
+        unit_db.add_programmed(device_uuid, programmed_time, firmware_hash, machine_uuid_string, fixture_name)
+        spool.append([device_uuid, firmware_hash, machine_uuid_string])
+
+    flasher = config.get("flasher", ["MSP430Flasher"])
+    fixtures = [Fixture(i + 1, c, flasher, firmware, log, lcd_drive) for i, c in enumerate(config["fixtures"])]
+    print(f"Firmware hash is {fixtures[0].image.hash}")
+    for f in fixtures:
+        f.start()
+
+    start = time.time()
+    try:
+        if args.units is None:
+            run_interactive(fixtures, spool)
+        else:
+            run_units(fixtures, spool, args.units)
+    finally:
+        for f in fixtures:
+            f.stop()
+        print("\nWaiting for the log to catch up...")
+        if not spool.drain(LOG_DRAIN_SECONDS):
+            print(f"{spool.pending()} log records not sent yet ({spool.last_error}). They will be sent next time.")
+
+    print(status_line(fixtures, spool))
+    passed = sum(f.passed for f in fixtures)
+    print(f"{passed} units programmed in {time.time() - start:.1f} seconds.")
+    for f in fixtures:
+        if f.failed:
+            print(f"Fixture {f.fixture_name}: last failure was {f.last}")
+    sys.exit(1 if any(f.failed for f in fixtures) else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+"""
+titxt.py - Read, patch, and write TI-TXT images (the format of tsl-calibre-msp.txt and the MSP430Flasher dumps)
+
+A TI-TXT file is sections of hex bytes, each starting with an `@address` line, and ending with a `q`...
+
+    @1800
+    30 15 10 01 14 10 26
+    @c400
+    01 DF 30 06 18 18 00 00 09 01 01 03 01 00 FF F0
+    q
+
+`TiTxt` keeps the text as it is (bytes, bytearray, or an mmap of the file) and just indexes where the sections are, so
+opening a file does not parse any hex. Reading a section is one `bytes.fromhex()` over its text, and `patch()`
+overwrites the hex digits of a few bytes in place without touching the rest of the text...
+
+    image = TiTxt.open("dump.txt")                      # mmap'ed, read only
+    image.read(0x1800, 58)                              # bytes at 0x1800-0x1839
+
+    image = TiTxt(bytearray(text))                      # Writable copy
+    image.patch(0x1800, b"\\x30\\x15\\x10\\x01\\x14\\x10\\x26")   # Same length, in place
+    out.write(image.text)
+
+`encode()` goes the other way, from (address, bytes) segments to TI-TXT.
+"""
+
+import mmap
+import re
+
+# An `@address` line or the `q` at the end. Everything else that is not blank is hex bytes.
+_MARKER = re.compile(rb"^[ \t]*(?:@([0-9A-Fa-f]+)|[qQ])", re.M)
+_HEX_BYTE = re.compile(rb"[0-9A-Fa-f]{2}")
+_WHITESPACE = b" \t\r\n"
+
+BYTES_PER_LINE = 16             # Like the TI tools
+
+
+class Section:
+    """One `@address` section. `start` and `end` are where its hex is in the text."""
+
+    def __init__(self, address, start, end, length):
+        self.address = address
+        self.start = start
+        self.end = end
+        self.length = length
+
+    def __repr__(self):
+        return "Section(0x%04X, %d bytes)" % (self.address, self.length)
+
+
+class TiTxt:
+
+    def __init__(self, text):
+        self.text = text
+        self.sections = []
+        markers = list(_MARKER.finditer(text))
+        for m, after in zip(markers, markers[1:] + [None]):
+            if m.group(1) is None:
+                break                                       # q
+            start = m.end()
+            end = after.start() if after is not None else len(text)
+            length = len(bytes(text[start:end]).translate(None, _WHITESPACE)) // 2
+            self.sections.append(Section(int(m.group(1), 16), start, end, length))
+
+    @classmethod
+    def open(cls, path, writable=False):
+        """Map the file instead of reading it. With `writable`, patch() writes straight through to the file."""
+        with open(path, "r+b" if writable else "rb") as f:
+            return cls(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_WRITE if writable else mmap.ACCESS_READ))
+
+    def data(self, section):
+        return bytes.fromhex(bytes(self.text[section.start:section.end]).decode("ascii"))
+
+    def segments(self):
+        """(address, bytes) for every section, in file order."""
+        return [(s.address, self.data(s)) for s in self.sections]
+
+    def _covering(self, address, length):
+        for s in self.sections:
+            if s.address <= address and address + length <= s.address + s.length:
+                return s
+        raise ValueError("0x%04X-0x%04X is not all in one section" % (address, address + length - 1))
+
+    def read(self, address, length):
+        s = self._covering(address, length)
+        return self.data(s)[address - s.address:address - s.address + length]
+
+    def image(self, base, size, fill=0xFF):
+        """The bytes at base..base+size-1 as a bytearray, with `fill` wherever the file does not say (like erased FRAM)."""
+        out = bytearray([fill]) * size
+        for s in self.sections:
+            lo, hi = max(s.address, base), min(s.address + s.length, base + size)
+            if lo < hi:
+                out[lo - base:hi - base] = self.data(s)[lo - s.address:hi - s.address]
+        return out
+
+    def patch(self, address, data):
+        """Overwrite `data` at `address` in place. It has to land inside an existing section, so the text does not move."""
+        s = self._covering(address, len(data))
+        digits = _HEX_BYTE.finditer(self.text, s.start, s.end)
+        for _ in range(address - s.address):
+            next(digits)
+        for b in data:
+            m = next(digits)
+            self.text[m.start():m.end()] = b"%02X" % b
+
+
+def encode(segments, newline=b"\n", last=True):
+    """TI-TXT for (address, bytes) segments, with the `q` at the end unless more sections are going to follow (`last=False`)."""
+    out = []
+    for address, data in segments:
+        out.append(b"@%04X" % address)
+        for i in range(0, len(data), BYTES_PER_LINE):
+            out.append(b" ".join(b"%02X" % b for b in data[i:i + BYTES_PER_LINE]))
+    if last:
+        out.append(b"q")
+    return newline.join(out) + newline
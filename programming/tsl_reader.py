@@ -6,34 +6,22 @@ read_tsl_fram.py – Dump and interpret the “information FRAM” of a TSL.
 ▪ Tested with Python 3.8+ on macOS, Linux and Windows.
 """
 
-import subprocess, tempfile, os, time, datetime, struct, sys
+import subprocess, tempfile, os, time, datetime, sys
 from pathlib import Path
 
+import persistent_layout
+import titxt
+import unitdb
+from flashd import FlasherSession
+from persistent_time import newest_slot, time_since_launch
+
 # ---------------------------------------------------------------------------
-# Helpers ­– TI-TXT decode & BCD ↔ int
+# Helpers ­– BCD ↔ int
 # ---------------------------------------------------------------------------
 
-def decode_titxt(txt: str) -> bytes:
-    """Convert the data fields of a TI-TXT file into raw bytes."""
-    data_bytes = bytearray()
-    for line in txt.splitlines():
-        line = line.strip()
-        if not line or line.startswith('@') or line.startswith('q'):
-            continue
-        # each 'word' is one byte in hex
-        for token in line.split():
-            data_bytes.append(int(token, 16))
-    return bytes(data_bytes)
-
 def bcd_to_int(b: int) -> int:
     return ((b >> 4) * 10) + (b & 0x0F)
 
-def unpack_u16_le(buf, off):   # little-endian 16-bit
-    return struct.unpack_from('<H', buf, off)[0]
-
-def unpack_u32_le(buf, off):   # little-endian 32-bit
-    return struct.unpack_from('<I', buf, off)[0]
-
 # ---------------------------------------------------------------------------
 # Low-level FRAM read
 # ---------------------------------------------------------------------------
@@ -41,8 +29,16 @@ def unpack_u32_le(buf, off):   # little-endian 32-bit
 def read_fram(start: int, end: int, mspflasher='MSP430Flasher') -> bytes:
     """
     Read FRAM from start..end (inclusive) and return it as bytes.
-    Uses a temporary TI-TXT file produced by MSP430Flasher.
+    Uses a temporary TI-TXT file produced by MSP430Flasher, or flashd.py if `tsl_flashd` is set.
     """
+    flashd_address = os.getenv('tsl_flashd')
+    if flashd_address:
+        session = FlasherSession(flashd_address)
+        try:
+            return session.read_unit(start, end - start + 1)
+        finally:
+            session.close()
+
     with tempfile.TemporaryDirectory() as tmp:
         dump = Path(tmp) / 'fram.txt'
         cmd = [
@@ -52,40 +48,17 @@ def read_fram(start: int, end: int, mspflasher='MSP430Flasher') -> bytes:
         ]
         print('→ Running:', ' '.join(cmd))
         subprocess.run(cmd, check=True)
-        data = decode_titxt(dump.read_text())
-        if len(data) < (end - start + 1):
+        try:
+            return bytes(titxt.TiTxt(dump.read_bytes()).read(start, end - start + 1))
+        except ValueError:
             raise RuntimeError('FRAM read shorter than requested range')
-        return data
-
-# ---------------------------------------------------------------------------
-# Data-structure offsets  (all relative to 0x1800)
-# ---------------------------------------------------------------------------
-
-OFF_COMMISSION  = 0              # 7 bytes   rv3032_time_block_t
-OFF_PERSIST     = 7              # struct persistent_data_t begins here
-
-# field offsets inside persistent_data
-OFF_MINS            = OFF_PERSIST + 0                       # uint16
-OFF_DAYS            = OFF_PERSIST + 2                       # uint32
-OFF_BACKUP_MINS     = OFF_PERSIST + 6                       # uint16
-OFF_BACKUP_DAYS     = OFF_PERSIST + 8                       # uint32
-OFF_UPDATE_FLAG     = OFF_PERSIST + 12                      # uint8
-OFF_LAUNCHED_FLAG   = OFF_PERSIST + 13                      # uint8
-OFF_COMMISSIONED    = OFF_PERSIST + 14                      # uint8
-OFF_INITIALIZED     = OFF_PERSIST + 15                      # uint8
-OFF_LAUNCHED_TIME   = OFF_PERSIST + 16                      # 7 bytes
-OFF_PROGRAM_TIME    = OFF_PERSIST + 23                      # 7 bytes
-OFF_POWERUPS        = OFF_PERSIST + 30                      # uint16
-OFF_PORSOLT         = OFF_PERSIST + 32                      # uint16
-
-STRUCT_SIZE = 34   # we’ll read a bit beyond for safety
 
 # ---------------------------------------------------------------------------
 # High-level decode
 # ---------------------------------------------------------------------------
 
-def parse_time_block(buf, off):
-    sec, minute, hour, wday, mday, mon, year = [bcd_to_int(x) for x in buf[off:off+7]]
+def parse_time_block(tb):
+    sec, minute, hour, wday, mday, mon, year = [bcd_to_int(x) for x in bytes(tb)]
     year += 2000
     return datetime.datetime(year, mon, mday, hour, minute, sec)
 
@@ -93,52 +66,45 @@ def main():
     # Allow MSP430Flasher override
     flasher = os.getenv('MSP430FLASHER', 'MSP430Flasher')
 
-    fram = read_fram(0x1800, 0x184F, flasher)
+    base = persistent_layout.BASE_ADDRESS
+    fram = read_fram(base, base + 0x4F, flasher)
+    # The device descriptors, for the same UUID program.py logged this unit under
+    device_uuid = unitdb.device_uuid(read_fram(0x1a00, 0x1a11, flasher))
+    print(f'Device UUID is {device_uuid}')
 
-    print('\n=== RAW FRAM HEX DUMP (0x1800-0x184F) ===')
+    print(f'\n=== RAW FRAM HEX DUMP (0x{base:04X}-0x{base + 0x4F:04X}) ===')
     for i in range(0, len(fram), 16):
         chunk = fram[i:i+16]
-        print(f'0x{0x1800+i:04X}:', ' '.join(f'{b:02X}' for b in chunk))
+        print(f'0x{base+i:04X}:', ' '.join(f'{b:02X}' for b in chunk))
 
     print('\n=== DECODED DATA ===')
 
-    # Commissioning timestamp
-    commission_dt = parse_time_block(fram, OFF_COMMISSION)
-    print('Commissioned (factory program time):', commission_dt.isoformat())
-
-    # Persistent vars
-    mins            = unpack_u16_le(fram, OFF_MINS)
-    days            = unpack_u32_le(fram, OFF_DAYS)
-    backup_mins     = unpack_u16_le(fram, OFF_BACKUP_MINS)
-    backup_days     = unpack_u32_le(fram, OFF_BACKUP_DAYS)
-    update_flag     = fram[OFF_UPDATE_FLAG]
-    launched_flag   = fram[OFF_LAUNCHED_FLAG]
-    commissioned_f  = fram[OFF_COMMISSIONED]
-    initialized_f   = fram[OFF_INITIALIZED]
-    launched_time   = parse_time_block(fram, OFF_LAUNCHED_TIME)
-    programmed_time = parse_time_block(fram, OFF_PROGRAM_TIME)
-    powerups        = unpack_u16_le(fram, OFF_POWERUPS)
-    porsolt         = unpack_u16_le(fram, OFF_PORSOLT)
-
-    print(f'\nPersistent fields @0x1807:')
-    print(f'  mins                = {mins}')
-    print(f'  days                = {days}')
-    print(f'  backup_mins         = {backup_mins}')
-    print(f'  backup_days         = {backup_days}')
-    print(f'  update_flag         = 0x{update_flag:02X}')
-    print(f'  launched_flag       = 0x{launched_flag:02X}')
-    print(f'  commissioned_flag   = 0x{commissioned_f:02X}')
-    print(f'  initialized_flag    = 0x{initialized_f:02X}')
-    print(f'  launched_time       = {launched_time.isoformat()}')
-    print(f'  programmed_time     = {programmed_time.isoformat()}')
-    print(f'  tsl_powerup_count   = {powerups}')
-    print(f'  porsoltCount        = {porsolt}')
+    # Overlay the layout generated from persistent_schema.json straight onto the dump
+    data = persistent_layout.PersistentData.from_buffer_copy(fram[:persistent_layout.SIZE])
+
+    programmed_time = parse_time_block(data.programmed_time)
+    print('Commissioned (factory program time):', programmed_time.isoformat())
+
+    launched_flag   = data.launched_flag
+    # Only set once the trigger is pulled. Before that it is whatever was in the FRAM and might not even be a date.
+    launched_time   = parse_time_block(data.launched_time) if launched_flag == 0x01 else None
+    days, mins, source = time_since_launch(data)
+    newest          = newest_slot(data)
+
+    print(f'\nPersistent fields @0x{base:04X}:')
+    for name, (off, size) in persistent_layout.FIELDS.items():
+        if size <= 4:
+            value = int.from_bytes(fram[off:off + size], 'little')
+            print(f'  {name:<24}= {value:<10} [0x{value:0{size * 2}X}]')
+    print(f'  launched_time           = {launched_time.isoformat() if launched_time else "not launched"}')
+    print(f'  newest counter slot     = {newest}')
+    print(f'  time since launch       = {days} days {mins} mins (from {source})')
 
     # -------------------------------------------------------------------
     # Extra calculations when already triggered
     # -------------------------------------------------------------------
     if launched_flag == 0x01:
-        now = datetime.datetime.now(datetime.timezone.utc).astimezone()
+        now = datetime.datetime.now(datetime.timezone.utc).replace(tzinfo=None)    # The time blocks are naive UTC
         elapsed = now - launched_time
 
         total_minutes = int(elapsed.total_seconds() // 60)
@@ -159,9 +125,27 @@ def main():
     else:
         print('\n*** This TSL has NOT been triggered yet ***')
 
+    # -------------------------------------------------------------------
+    # Keep what we read in the local unit database (see unitdb.py)
+    # -------------------------------------------------------------------
+    db = unitdb.UnitDB()
+    db.add_readback(device_uuid, fram[:persistent_layout.SIZE],
+                    programmed_time   = unitdb.iso_time(programmed_time),
+                    launched_time     = unitdb.iso_time(launched_time) if launched_time else None,
+                    commissioned_flag = data.commisisoned_flag,
+                    launched_flag     = launched_flag,
+                    porsolt_count     = data.porsoltCount,
+                    powerup_count     = data.tsl_powerup_count,
+                    days              = days,
+                    mins              = mins)
+    print(f'\nRecorded in {db.path}. `python3 unitdb.py unit {device_uuid}` shows its history.')
+
 if __name__ == '__main__':
     try:
         main()
     except subprocess.CalledProcessError as e:
         sys.stderr.write(f'\nERROR: MSP430Flasher failed (return {e.returncode}).\n')
         sys.exit(1)
+    except (RuntimeError, OSError) as e:
+        sys.stderr.write(f'\nERROR: {e}\n')
+        sys.exit(1)
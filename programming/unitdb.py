@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""
+unitdb.py - Local database of every unit we programmed and everything we read back from it
+
+The google sheet is the shared log, but looking a unit up there means scrolling a spreadsheet and needs the network.
+This keeps the same history in an SQLite file on the station (units.db, or set `tsl_unitdb`), indexed so the usual
+questions take milliseconds even with 100k units in it...
+
+    python3 unitdb.py unit 0606408121100000A3F1        # Everything about this unit (a prefix of the UUID is fine)
+    python3 unitdb.py firmware 5d41402a                 # Every unit programmed with this firmware (hash or prefix)
+    python3 unitdb.py date 2026-10-01 2026-10-16        # Every unit programmed between these days (UTC, inclusive)
+    python3 unitdb.py stats                             # How many of what
+    python3 unitdb.py import-spool log_spool.jsonl      # Add the programming records from a log spool (see logspool.py)
+
+There are two tables...
+
+  * `programmed` - one row each time program.py or station.py programs a unit: the device UUID (get_ddid_from_file()),
+    the programmed_time that was stamped into it, the firmware hash, and the station and fixture that did it.
+  * `readbacks` - one row each time tsl_reader.py reads a unit: the decoded persistent_data fields (porsoltCount and
+    friends), the time since launch, and the raw bytes so they can be decoded again later.
+
+Both are indexed by UUID and time, and `programmed` by firmware hash and time. Times are ISO 8601 UTC strings, so they
+sort and compare as text.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import sqlite3
+import sys
+import threading
+import time
+
+DEFAULT_PATH = "units.db"
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS programmed (
+    id              INTEGER PRIMARY KEY,
+    uuid            TEXT NOT NULL,
+    programmed_time TEXT NOT NULL,          -- The timestamp stamped into the unit's FRAM
+    firmware_hash   TEXT NOT NULL,
+    station         TEXT,                   -- Machine UUID of the station, like the google sheet
+    fixture         TEXT,
+    UNIQUE (uuid, programmed_time)          -- So importing the same spool twice does not double up
+);
+CREATE INDEX IF NOT EXISTS programmed_firmware ON programmed (firmware_hash, programmed_time);
+CREATE INDEX IF NOT EXISTS programmed_time ON programmed (programmed_time);
+
+CREATE TABLE IF NOT EXISTS readbacks (
+    id                  INTEGER PRIMARY KEY,
+    uuid                TEXT NOT NULL,
+    read_time           TEXT NOT NULL,
+    programmed_time     TEXT,               -- As read back from the unit, which should match its `programmed` row
+    launched_time       TEXT,
+    commissioned_flag   INTEGER,
+    launched_flag       INTEGER,
+    porsolt_count       INTEGER,
+    powerup_count       INTEGER,
+    days                INTEGER,            -- Time since launch, from persistent_time.time_since_launch()
+    mins                INTEGER,
+    fram                BLOB                -- persistent_data as read
+);
+CREATE INDEX IF NOT EXISTS readbacks_uuid ON readbacks (uuid, read_time);
+CREATE INDEX IF NOT EXISTS readbacks_time ON readbacks (read_time);
+"""
+
+READBACK_COLUMNS = ("read_time", "programmed_time", "launched_time", "commissioned_flag", "launched_flag", "porsolt_count",
+                    "powerup_count", "days", "mins")
+
+
+def default_path():
+    return os.environ.get("tsl_unitdb", DEFAULT_PATH)
+
+
+def iso_time(t):
+    """ISO 8601 UTC for a time.gmtime() or a naive UTC datetime."""
+    if isinstance(t, time.struct_time):
+        return time.strftime("%Y-%m-%dT%H:%M:%SZ", t)
+    return t.strftime("%Y-%m-%dT%H:%M:%SZ")
+
+
+def device_uuid(descriptors):
+    """The same serial number get_ddid_from_file() makes, from the raw device descriptor bytes at 0x1a00-0x1a11."""
+    return descriptors[0x04:0x08].hex().upper() + descriptors[0x0a:0x12].hex().upper()
+
+
+def _prefix_range(column, prefix):
+    # A range instead of LIKE so the index gets used. UUIDs and hashes are hex, which always sorts below "~".
+    return f"{column} >= ? AND {column} < ?", (prefix, prefix + "~")
+
+
+class UnitDB:
+    """The database. Safe to share between threads (station.py has one per fixture) - writes take turns."""
+
+    def __init__(self, path=None):
+        self.path = path or default_path()
+        self.lock = threading.Lock()
+        self.db = sqlite3.connect(self.path, timeout=10, check_same_thread=False)
+        self.db.row_factory = sqlite3.Row
+        # WAL lets the CLI read while a station is writing, and makes each commit one append instead of two syncs
+        self.db.execute("PRAGMA journal_mode=WAL")
+        self.db.executescript(SCHEMA)
+
+    def close(self):
+        self.db.close()
+
+    # ** Writing
+
+    def add_programmed(self, uuid, programmed_time, firmware_hash, station=None, fixture=None):
+        with self.lock, self.db:
+            self.db.execute("INSERT OR IGNORE INTO programmed (uuid, programmed_time, firmware_hash, station, fixture) VALUES (?, ?, ?, ?, ?)",
+                            (uuid, programmed_time, firmware_hash, station, fixture))
+
+    def add_readback(self, uuid, fram, **fields):
+        """`fields` are READBACK_COLUMNS. Anything not given is NULL."""
+        unknown = set(fields) - set(READBACK_COLUMNS)
+        if unknown:
+            raise ValueError("Unknown readback fields: %s" % ", ".join(sorted(unknown)))
+        fields.setdefault("read_time", iso_time(time.gmtime()))
+        columns = ["uuid", "fram"] + list(fields)
+        with self.lock, self.db:
+            self.db.execute("INSERT INTO readbacks (%s) VALUES (%s)" % (", ".join(columns), ", ".join("?" * len(columns))),
+                            [uuid, bytes(fram)] + list(fields.values()))
+
+    def import_spool(self, path):
+        """Add the [timestamp, uuid, hash, station] rows from a log spool. Returns how many were new. The spool's timestamp is
+        when the record was logged, a few seconds after the programmed_time, so these will not line up with rows we added ourselves."""
+        rows = []
+        with open(path, "rb") as f:
+            for line in f:
+                try:
+                    row = json.loads(line)
+                except ValueError:
+                    continue
+                if isinstance(row, list) and len(row) == 4:
+                    rows.append((row[1], row[0], row[2], row[3]))
+        with self.lock, self.db:
+            before = self.db.total_changes
+            self.db.executemany("INSERT OR IGNORE INTO programmed (uuid, programmed_time, firmware_hash, station) VALUES (?, ?, ?, ?)", rows)
+            return self.db.total_changes - before
+
+    # ** Queries
+
+    def unit_history(self, uuid_prefix):
+        """(programmed rows, readback rows) for every unit whose UUID starts with `uuid_prefix`, oldest first."""
+        where, args = _prefix_range("uuid", uuid_prefix)
+        programmed = self.db.execute(f"SELECT * FROM programmed WHERE {where} ORDER BY uuid, programmed_time", args).fetchall()
+        readbacks = self.db.execute(f"SELECT * FROM readbacks WHERE {where} ORDER BY uuid, read_time", args).fetchall()
+        return programmed, readbacks
+
+    def units_on_firmware(self, hash_prefix, since=None, until=None):
+        where, args = _prefix_range("firmware_hash", hash_prefix)
+        return self._programmed(where, args, since, until)
+
+    def units_between(self, since, until):
+        return self._programmed("1", (), since, until)
+
+    def _programmed(self, where, args, since, until):
+        if since:
+            where, args = where + " AND programmed_time >= ?", args + (since,)
+        if until:
+            where, args = where + " AND programmed_time < ?", args + (until,)
+        return self.db.execute(f"SELECT * FROM programmed WHERE {where} ORDER BY programmed_time", args).fetchall()
+
+    def stats(self):
+        count = lambda sql: self.db.execute(sql).fetchone()[0]
+        firmware = self.db.execute("SELECT firmware_hash, COUNT(*), MIN(programmed_time), MAX(programmed_time) FROM programmed "
+                                   "GROUP BY firmware_hash ORDER BY MIN(programmed_time)").fetchall()
+        return {
+            "programmed": count("SELECT COUNT(*) FROM programmed"),
+            "units": count("SELECT COUNT(DISTINCT uuid) FROM programmed"),
+            "readbacks": count("SELECT COUNT(*) FROM readbacks"),
+            "firmware": firmware,
+        }
+
+
+# ** Command line
+
+def _day_start(day):
+    return day + "T00:00:00Z" if day and len(day) == 10 else day
+
+
+def _day_end(day):
+    # Until the end of that day, so `date 2026-10-16 2026-10-16` is the whole day
+    if day and len(day) == 10:
+        return (datetime.date.fromisoformat(day) + datetime.timedelta(days=1)).isoformat() + "T00:00:00Z"
+    return day
+
+
+def _print_programmed(rows):
+    for r in rows:
+        print(f"{r['programmed_time']}  {r['uuid']}  {r['firmware_hash']}  {r['station'] or ''}  {r['fixture'] or ''}".rstrip())
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--db", default=default_path(), help="database file (default $tsl_unitdb or %s)" % DEFAULT_PATH)
+    ap.add_argument("--time", action="store_true", help="say how long the query took")
+    sub = ap.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("unit", help="history of one unit")
+    p.add_argument("uuid", help="device UUID or the start of it")
+    p = sub.add_parser("firmware", help="units programmed with a firmware")
+    p.add_argument("hash", help="firmware hash or the start of it")
+    p.add_argument("--since", help="YYYY-MM-DD")
+    p.add_argument("--until", help="YYYY-MM-DD (inclusive)")
+    p = sub.add_parser("date", help="units programmed between two days")
+    p.add_argument("since", help="YYYY-MM-DD")
+    p.add_argument("until", nargs="?", help="YYYY-MM-DD (inclusive, default same day)")
+    sub.add_parser("stats", help="counts by firmware")
+    p = sub.add_parser("import-spool", help="add programming records from a log spool file")
+    p.add_argument("spool")
+    args = ap.parse_args()
+
+    db = UnitDB(args.db)
+    start = time.perf_counter()
+
+    if args.command == "unit":
+        programmed, readbacks = db.unit_history(args.uuid.upper())
+        if not programmed and not readbacks:
+            print(f"No unit {args.uuid}")
+        _print_programmed(programmed)
+        for r in readbacks:
+            print(f"{r['read_time']}  {r['uuid']}  read back: programmed {r['programmed_time']}, launched {r['launched_time'] or 'no'}, "
+                  f"porsoltCount {r['porsolt_count']}, powerups {r['powerup_count']}, {r['days']} days {r['mins']} mins")
+    elif args.command == "firmware":
+        rows = db.units_on_firmware(args.hash.lower(), _day_start(args.since), _day_end(args.until))
+        _print_programmed(rows)
+        print(f"{len(rows)} units")
+    elif args.command == "date":
+        rows = db.units_between(_day_start(args.since), _day_end(args.until or args.since))
+        _print_programmed(rows)
+        print(f"{len(rows)} units")
+    elif args.command == "stats":
+        s = db.stats()
+        print(f"{s['programmed']} programmings of {s['units']} units, {s['readbacks']} readbacks")
+        for hash, n, first, last in s["firmware"]:
+            print(f"  {hash}  {n:>7} units  {first} - {last}")
+    elif args.command == "import-spool":
+        print(f"{db.import_spool(args.spool)} new records from {args.spool}")
+
+    if args.time:
+        print(f"{(time.perf_counter() - start) * 1000:.1f} ms", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,756 @@
+"""
+asm430.py - A small two-pass assembler for the subset of TI MSP430 assembler syntax used in tsl_asm.asm
+
+This is not a general replacement for the TI assembler. It knows just enough to turn our ISR source into the same
+machine words that CCS would generate so the simulator can run them and count cycles. It supports...
+
+  * labels (with or without the colon, the TI rule is that they start in column 1)
+  * the MSP430 (non-X) instruction set, including the emulated instructions and the constant generator
+  * `.cdecls` - #defines are pulled out of the project headers, `msp430.h` comes from msp430fr4133_symbols.py
+  * `.text`, `.sect`, `.short`/`.word`, `.byte`, `.align`, `.space`, `.set`/`.equ`
+  * `.if`/`.elseif`/`.else`/`.endif` and `.loop`/`.endloop`
+
+Anything the asm refers to that is not defined here (the C variables and functions) must be passed in as `externs`
+since there is no linker. If the TI assembler would reject something, this one probably will too.
+"""
+
+import os
+import re
+
+
+class AsmError(Exception):
+    pass
+
+
+class Undefined(Exception):
+    """Raised when an expression uses a symbol that is not (yet) defined. Forward refs are normal in pass 1."""
+    pass
+
+
+# *** Expressions
+
+_TOKEN_RE = re.compile(r"""
+    \s*(?:
+        (?P<num>0[xX][0-9a-fA-F]+|0[bB][01]+|[0-9][0-9a-fA-F]*[hH]\b|[0-9]+)[uUlL]*
+      | (?P<id>[A-Za-z_$.][\w$.]*)
+      | (?P<op><<|>>|<=|>=|==|!=|&&|\|\||[-+*/%&|^~!()<>])
+    )""", re.VERBOSE)
+
+
+def _tokenize(text):
+    tokens = []
+    pos = 0
+    text = text.strip()
+    while pos < len(text):
+        m = _TOKEN_RE.match(text, pos)
+        if not m or m.end() == pos:
+            raise AsmError("can not parse expression `%s`" % text)
+        pos = m.end()
+        if m.group("num"):
+            s = m.group("num")
+            if s[:2] in ("0x", "0X"):
+                tokens.append(("num", int(s[2:], 16)))
+            elif s[:2] in ("0b", "0B"):
+                tokens.append(("num", int(s[2:], 2)))
+            elif s[-1] in "hH":
+                tokens.append(("num", int(s[:-1], 16)))
+            else:
+                tokens.append(("num", int(s, 10)))
+        elif m.group("id"):
+            tokens.append(("id", m.group("id")))
+        else:
+            tokens.append(("op", m.group("op")))
+        while pos < len(text) and text[pos].isspace():
+            pos += 1
+    return tokens
+
+
+_BINARY_PRECEDENCE = [
+    ("||",),
+    ("&&",),
+    ("|",),
+    ("^",),
+    ("&",),
+    ("==", "!="),
+    ("<", ">", "<=", ">="),
+    ("<<", ">>"),
+    ("+", "-"),
+    ("*", "/", "%"),
+]
+
+
+def _apply(op, a, b):
+    if op == "+":   return a + b
+    if op == "-":   return a - b
+    if op == "*":   return a * b
+    if op == "/":   return int(a / b)
+    if op == "%":   return a % b
+    if op == "<<":  return a << b
+    if op == ">>":  return a >> b
+    if op == "&":   return a & b
+    if op == "|":   return a | b
+    if op == "^":   return a ^ b
+    if op == "==":  return int(a == b)
+    if op == "!=":  return int(a != b)
+    if op == "<":   return int(a < b)
+    if op == ">":   return int(a > b)
+    if op == "<=":  return int(a <= b)
+    if op == ">=":  return int(a >= b)
+    if op == "&&":  return int(bool(a) and bool(b))
+    if op == "||":  return int(bool(a) or bool(b))
+    raise AsmError("bad operator %s" % op)
+
+
+def evaluate(text, resolve):
+    """Evaluate a C-ish integer expression. `resolve(name)` returns the value of a symbol or raises Undefined."""
+
+    tokens = _tokenize(text)
+    pos = [0]
+
+    def peek():
+        return tokens[pos[0]] if pos[0] < len(tokens) else (None, None)
+
+    def take():
+        t = peek()
+        pos[0] += 1
+        return t
+
+    def primary():
+        kind, val = take()
+        if kind == "num":
+            return val
+        if kind == "id":
+            if val == "defined":
+                # Only used by the header preprocessor
+                paren = peek() == ("op", "(")
+                if paren:
+                    take()
+                kind, name = take()
+                if paren:
+                    take()
+                try:
+                    resolve(name)
+                    return 1
+                except Undefined:
+                    return 0
+            return resolve(val)
+        if (kind, val) == ("op", "("):
+            v = binary(0)
+            if take() != ("op", ")"):
+                raise AsmError("missing `)` in `%s`" % text)
+            return v
+        if (kind, val) == ("op", "-"):
+            return -primary()
+        if (kind, val) == ("op", "+"):
+            return primary()
+        if (kind, val) == ("op", "~"):
+            return ~primary()
+        if (kind, val) == ("op", "!"):
+            return int(not primary())
+        raise AsmError("unexpected `%s` in `%s`" % (val, text))
+
+    def binary(level):
+        if level == len(_BINARY_PRECEDENCE):
+            return primary()
+        v = binary(level + 1)
+        while True:
+            kind, op = peek()
+            if kind == "op" and op in _BINARY_PRECEDENCE[level]:
+                take()
+                v = _apply(op, v, binary(level + 1))
+            else:
+                return v
+
+    v = binary(0)
+    if pos[0] != len(tokens):
+        raise AsmError("junk at end of expression `%s`" % text)
+    return v
+
+
+# *** C header scanning for .cdecls
+
+def scan_header(path, defines, include_dirs, seen=None):
+    """Pull the object-like #defines out of a C header into `defines` (name -> replacement text).
+    Handles #include "..." of local headers and the simple #if/#ifdef/#ifndef/#else/#elif/#endif nesting we use.
+    Everything else in the header (declarations, structs, prototypes) is ignored, like .cdecls does for asm purposes."""
+
+    if seen is None:
+        seen = set()
+    if path in seen:
+        return
+    seen.add(path)
+
+    with open(path, encoding="utf-8", errors="replace") as f:
+        text = f.read()
+
+    text = re.sub(r"/\*.*?\*/", " ", text, flags=re.S)      # Block comments
+    text = text.replace("\\\n", " ")                        # Line continuations
+
+    def resolve(name):
+        if name in defines:
+            return evaluate(defines[name], resolve)
+        raise Undefined(name)
+
+    # Stack of (this_branch_active, some_branch_taken)
+    stack = []
+
+    def active():
+        return all(s[0] for s in stack)
+
+    for line in text.splitlines():
+        line = re.sub(r"//.*", "", line).strip()
+        if not line.startswith("#"):
+            continue
+        m = re.match(r"#\s*(\w+)\s*(.*)", line)
+        if not m:
+            continue
+        directive, rest = m.group(1), m.group(2).strip()
+
+        if directive in ("ifdef", "ifndef"):
+            present = rest.split()[0] in defines
+            cond = present if directive == "ifdef" else not present
+            stack.append([active() and cond, cond])
+        elif directive == "if":
+            try:
+                cond = bool(evaluate(rest, resolve)) if active() else False
+            except (Undefined, AsmError):
+                cond = False
+            stack.append([active() and cond, cond])
+        elif directive == "elif":
+            top = stack[-1]
+            stack.pop()
+            try:
+                cond = (not top[1]) and active() and bool(evaluate(rest, resolve))
+            except (Undefined, AsmError):
+                cond = False
+            stack.append([active() and cond, top[1] or cond])
+        elif directive == "else":
+            top = stack.pop()
+            stack.append([active() and not top[1], True])
+        elif directive == "endif":
+            stack.pop()
+        elif not active():
+            continue
+        elif directive == "define":
+            dm = re.match(r"([A-Za-z_]\w*)(\(?)\s*(.*)", rest)
+            if dm and not dm.group(2):          # Skip function-like macros
+                name, value = dm.group(1), dm.group(3).strip()
+                if name not in defines:         # Command line -D overrides win, like `-D` on the real compiler
+                    defines[name] = value if value else "1"
+        elif directive == "undef":
+            defines.pop(rest.split()[0], None)
+        elif directive == "include":
+            im = re.match(r'"([^"]+)"', rest)
+            if im:
+                for d in include_dirs:
+                    p = os.path.join(d, im.group(1))
+                    if os.path.exists(p):
+                        scan_header(p, defines, include_dirs, seen)
+                        break
+
+
+# *** Instruction set
+
+FORMAT_I = {
+    "MOV": 0x4, "ADD": 0x5, "ADDC": 0x6, "SUBC": 0x7, "SUB": 0x8, "CMP": 0x9,
+    "DADD": 0xA, "BIT": 0xB, "BIC": 0xC, "BIS": 0xD, "XOR": 0xE, "AND": 0xF,
+    "OR": 0xD,      # The TI assembler takes OR as another name for BIS
+}
+
+FORMAT_II = {
+    "RRC": 0, "SWPB": 1, "RRA": 2, "SXT": 3, "PUSH": 4, "CALL": 5,
+}
+
+JUMPS = {
+    "JNE": 0, "JNZ": 0, "JEQ": 1, "JZ": 1, "JNC": 2, "JLO": 2, "JC": 3, "JHS": 3,
+    "JN": 4, "JGE": 5, "JL": 6, "JMP": 7,
+}
+
+# Emulated instructions. `{d}` is the destination operand, `{s}` the source.
+EMULATED = {
+    "ADC":  ("ADDC", "#0,{d}"),
+    "DADC": ("DADD", "#0,{d}"),
+    "DEC":  ("SUB", "#1,{d}"),
+    "DECD": ("SUB", "#2,{d}"),
+    "INC":  ("ADD", "#1,{d}"),
+    "INCD": ("ADD", "#2,{d}"),
+    "SBC":  ("SUBC", "#0,{d}"),
+    "INV":  ("XOR", "#-1,{d}"),
+    "RLA":  ("ADD", "{d},{d}"),
+    "RLC":  ("ADDC", "{d},{d}"),
+    "CLR":  ("MOV", "#0,{d}"),
+    "TST":  ("CMP", "#0,{d}"),
+    "POP":  ("MOV", "@SP+,{d}"),
+    "BR":   ("MOV", "{d},PC"),
+    "RET":  ("MOV", "@SP+,PC"),
+    "NOP":  ("MOV", "#0,R3"),
+    "CLRC": ("BIC", "#1,SR"),
+    "SETC": ("BIS", "#1,SR"),
+    "CLRZ": ("BIC", "#2,SR"),
+    "SETZ": ("BIS", "#2,SR"),
+    "CLRN": ("BIC", "#4,SR"),
+    "SETN": ("BIS", "#4,SR"),
+    "DINT": ("BIC", "#8,SR"),
+    "EINT": ("BIS", "#8,SR"),
+}
+
+REGISTER_NAMES = {"PC": 0, "SP": 1, "SR": 2, "CG": 3}
+for _r in range(16):
+    REGISTER_NAMES["R%d" % _r] = _r
+
+
+def parse_register(text):
+    return REGISTER_NAMES.get(text.strip().upper())
+
+
+def split_operands(text):
+    """Split on commas that are not inside parentheses or quotes."""
+    parts, depth, cur, quote = [], 0, "", False
+    for ch in text:
+        if ch == '"':
+            quote = not quote
+        if ch == "(" and not quote:
+            depth += 1
+        elif ch == ")" and not quote:
+            depth -= 1
+        if ch == "," and depth == 0 and not quote:
+            parts.append(cur.strip())
+            cur = ""
+        else:
+            cur += ch
+    if cur.strip():
+        parts.append(cur.strip())
+    return parts
+
+
+def strip_comment(line):
+    out, quote = "", False
+    for ch in line:
+        if ch == '"':
+            quote = not quote
+        if ch == ";" and not quote:
+            break
+        out += ch
+    return out.rstrip()
+
+
+class Operand:
+    """A parsed operand. `mode` is one of reg, ind, inc, imm, idx, sym, abs."""
+
+    def __init__(self, mode, reg=None, expr=None):
+        self.mode = mode
+        self.reg = reg
+        self.expr = expr
+
+    @staticmethod
+    def parse(text):
+        text = text.strip()
+        r = parse_register(text)
+        if r is not None:
+            return Operand("reg", r)
+        if text.startswith("@"):
+            inc = text.endswith("+")
+            r = parse_register(text[1:-1] if inc else text[1:])
+            if r is None:
+                raise AsmError("bad indirect operand `%s`" % text)
+            return Operand("inc" if inc else "ind", r)
+        if text.startswith("#"):
+            return Operand("imm", expr=text[1:])
+        if text.startswith("&"):
+            return Operand("abs", expr=text[1:])
+        m = re.match(r"^(.+)\(\s*(\w+)\s*\)$", text)
+        if m and parse_register(m.group(2)) is not None:
+            return Operand("idx", parse_register(m.group(2)), expr=m.group(1))
+        return Operand("sym", expr=text)
+
+
+class Section:
+    def __init__(self, name, origin):
+        self.name = name
+        self.origin = origin
+        self.pc = origin
+        self.data = {}          # address -> byte
+
+
+class Image:
+    """The result of assembling: the bytes to load and the symbols we defined."""
+
+    def __init__(self):
+        self.sections = {}
+        self.symbols = {}
+        self.lines = {}         # Address of each instruction -> (line number, source text) for traces
+        self.value = None       # value(expr) evaluates an expression with the labels and #defines the asm saw, ie `image.value("TSL_SLEEP_IN_ISR")`
+
+    def segments(self):
+        for s in self.sections.values():
+            for addr, b in sorted(s.data.items()):
+                yield addr, b
+
+    def load_into(self, mem):
+        for addr, b in self.segments():
+            mem[addr] = b
+
+
+class Assembler:
+
+    def __init__(self, include_dirs, device_symbols, vector_sections, externs=None, defines=None, text_origin=0xC400):
+        self.include_dirs = include_dirs
+        self.device_symbols = device_symbols
+        self.vector_sections = vector_sections
+        self.externs = dict(externs or {})
+        self.cmdline_defines = dict(defines or {})
+        self.text_origin = text_origin
+
+    # ** Symbols
+
+    def resolve(self, name):
+        if name in self.labels:
+            return self.labels[name]
+        if name in self.defines:
+            if name in self._resolving:
+                raise AsmError("recursive define `%s`" % name)
+            self._resolving.add(name)
+            try:
+                return evaluate(self.defines[name], self.resolve)
+            finally:
+                self._resolving.discard(name)
+        if name in self.device_symbols and self.use_device:
+            return self.device_symbols[name]
+        if name in self.externs:
+            return self.externs[name]
+        raise Undefined(name)
+
+    def value(self, expr):
+        return evaluate(expr, self.resolve)
+
+    # ** Top level
+
+    def assemble(self, path):
+        with open(path, encoding="utf-8", errors="replace") as f:
+            source = f.read().splitlines()
+
+        # Constant generator choices get fixed the first time we see each immediate so instruction sizes can not change
+        # between passes. Forward references are never constant generator candidates, same as the TI assembler.
+        self.cg_choices = {}
+        self.labels = {}
+
+        # Keep running passes until the labels stop moving. Later passes see the label values from the previous
+        # pass for forward references.
+        for _ in range(8):
+            before = dict(self.labels)
+            self._pass(source, final=False)
+            if self.labels == before:
+                break
+        else:
+            raise AsmError("labels did not converge")
+
+        return self._pass(source, final=True)
+
+    def _pass(self, source, final):
+        self.final = final
+        self.defines = dict(self.cmdline_defines)
+        self._resolving = set()
+        self.use_device = False
+        self.insn_index = 0
+        self.image = Image()
+        self.section = self._switch_section(".text")
+        self.cond_stack = []
+        self._run_lines(list(enumerate(source, 1)))
+        if self.cond_stack:
+            raise AsmError("missing .endif")
+        self.image.symbols = dict(self.labels)
+        self.image.value = self.value
+        return self.image
+
+    def _switch_section(self, name):
+        if name not in self.image.sections:
+            if name == ".text":
+                origin = self.text_origin
+            elif name in self.vector_sections:
+                origin = self.vector_sections[name]
+            else:
+                raise AsmError("do not know where to put section `%s`" % name)
+            self.image.sections[name] = Section(name, origin)
+        return self.image.sections[name]
+
+    def _cond_active(self):
+        return all(c[0] for c in self.cond_stack)
+
+    def _run_lines(self, lines):
+        i = 0
+        while i < len(lines):
+            lineno, raw = lines[i]
+            i += 1
+            self.lineno = lineno
+            try:
+                if raw[:1] == "*":
+                    continue                            # Column 1 `*` is a comment line
+                line = strip_comment(raw.expandtabs(4))
+                if not line.strip():
+                    continue
+
+                label = None
+                body = line
+                if not line[0].isspace():
+                    m = re.match(r"([A-Za-z_$.][\w$.]*):?(.*)", line)
+                    if not m:
+                        raise AsmError("bad label")
+                    label, body = m.group(1), m.group(2)
+
+                parts = body.strip().split(None, 1)
+                op = parts[0].lower() if parts else ""
+                args = parts[1].strip() if len(parts) > 1 else ""
+
+                # Conditional assembly is handled even when inactive so we can track nesting
+                if op in (".if", ".elseif", ".else", ".endif"):
+                    self._conditional(op, args)
+                    continue
+                if not self._cond_active():
+                    continue
+
+                if op == ".loop":
+                    # Collect the body and run it `count` times
+                    depth, body_lines = 1, []
+                    while i < len(lines):
+                        t = strip_comment(lines[i][1]).strip().lower()
+                        i += 1
+                        first = t.split(None, 1)[0] if t else ""
+                        if first == ".loop":
+                            depth += 1
+                        elif first == ".endloop":
+                            depth -= 1
+                            if depth == 0:
+                                break
+                        body_lines.append(lines[i - 1])
+                    count = self.value(args) if args else 1024
+                    for _ in range(count):
+                        self._run_lines(body_lines)
+                    continue
+
+                if op in (".set", ".equ"):
+                    if label is None:
+                        raise AsmError("%s needs a symbol" % op)
+                    try:
+                        self.labels[label] = self.value(args) & 0xFFFF
+                    except Undefined:
+                        if self.final:
+                            raise
+                    continue
+
+                if label is not None:
+                    self.labels[label] = self.section.pc
+
+                if op:
+                    if op.startswith("."):
+                        self._directive(op, args)
+                    else:
+                        self._instruction(op, args, raw.strip())
+
+            except Undefined as e:
+                raise AsmError("line %d: undefined symbol `%s`" % (lineno, e.args[0]))
+            except AsmError as e:
+                if str(e).startswith("line "):
+                    raise
+                raise AsmError("line %d: %s\n    %s" % (lineno, e, raw.strip()))
+
+    def _conditional(self, op, args):
+        if op == ".if":
+            cond = bool(self.value(args)) if self._cond_active() else False
+            self.cond_stack.append([cond, cond])
+        elif op == ".elseif":
+            top = self.cond_stack.pop()
+            outer = self._cond_active()
+            cond = outer and not top[1] and bool(self.value(args))
+            self.cond_stack.append([cond, top[1] or cond])
+        elif op == ".else":
+            top = self.cond_stack.pop()
+            self.cond_stack.append([not top[1], True])
+        elif op == ".endif":
+            self.cond_stack.pop()
+
+    # ** Directives
+
+    def _directive(self, op, args):
+        if op == ".cdecls":
+            for f in re.findall(r'"([^"]+)"', args):
+                if f == "msp430.h":
+                    self.use_device = True
+                    continue
+                for d in self.include_dirs:
+                    p = os.path.join(d, f)
+                    if os.path.exists(p):
+                        scan_header(p, self.defines, self.include_dirs)
+                        break
+                else:
+                    raise AsmError("can not find header `%s`" % f)
+        elif op in (".ref", ".def", ".global", ".globl", ".retain", ".retainrefs", ".end", ".newblock", ".align2", ".even"):
+            if op in (".align2", ".even"):
+                self._align(2)
+        elif op == ".text":
+            self.section = self._switch_section(".text")
+        elif op == ".sect":
+            name = args.strip().strip('"')
+            self.section = self._switch_section(name)
+        elif op in (".short", ".word", ".int", ".half"):
+            self._align(2)
+            for e in split_operands(args):
+                self._emit_word(self._value_or_zero(e))
+        elif op in (".byte", ".char", ".ubyte"):
+            for e in split_operands(args):
+                self._emit_byte(self._value_or_zero(e))
+        elif op == ".space":
+            for _ in range(self.value(args)):
+                self._emit_byte(0)
+        elif op == ".align":
+            self._align(self.value(args) if args else 2)
+        else:
+            raise AsmError("unsupported directive `%s`" % op)
+
+    def _align(self, n):
+        while self.section.pc % n:
+            self._emit_byte(0)
+
+    def _value_or_zero(self, expr):
+        try:
+            return self.value(expr)
+        except Undefined:
+            if self.final:
+                raise
+            return 0
+
+    def _emit_byte(self, b):
+        self.section.data[self.section.pc] = b & 0xFF
+        self.section.pc += 1
+
+    def _emit_word(self, w):
+        if self.section.pc & 1:
+            raise AsmError("word at odd address")
+        self._emit_byte(w)
+        self._emit_byte(w >> 8)
+
+    # ** Instructions
+
+    def _instruction(self, mnemonic, args, source_text):
+        self._align(2)
+        self.insn_index += 1
+        self.image.lines[self.section.pc] = (self.lineno, source_text)
+
+        name = mnemonic.upper()
+        byte = False
+        if "." in name:
+            name, suffix = name.split(".", 1)
+            if suffix == "B":
+                byte = True
+            elif suffix not in ("W",):
+                raise AsmError("unsupported size suffix `.%s`" % suffix)
+
+        if name in EMULATED:
+            real, template = EMULATED[name]
+            args = template.format(d=args)
+            name = real
+
+        operands = split_operands(args)
+
+        if name == "RETI":
+            self._emit_word(0x1300)
+            return
+
+        if name in JUMPS:
+            if len(operands) != 1:
+                raise AsmError("jump takes one operand")
+            here = self.section.pc
+            target = self._value_or_zero(operands[0]) if not self.final else self.value(operands[0])
+            offset = (target - (here + 2)) // 2 if (target - here) % 2 == 0 else 0
+            if self.final and not -512 <= offset <= 511:
+                raise AsmError("jump out of range")
+            self._emit_word(0x2000 | (JUMPS[name] << 10) | (offset & 0x3FF))
+            return
+
+        if name in FORMAT_II:
+            if len(operands) != 1:
+                raise AsmError("%s takes one operand" % name)
+            src = Operand.parse(operands[0])
+            opnum = 0
+            if name == "CALL" and byte:
+                raise AsmError("CALL.B is not a thing")
+            as_bits, reg, ext = self._encode_src(src, byte, opnum, self.section.pc + 2)
+            self._emit_word(0x1000 | (FORMAT_II[name] << 7) | (int(byte) << 6) | (as_bits << 4) | reg)
+            if ext is not None:
+                self._emit_word(ext)
+            return
+
+        if name in FORMAT_I:
+            if len(operands) != 2:
+                raise AsmError("%s takes two operands" % name)
+            src = Operand.parse(operands[0])
+            dst = Operand.parse(operands[1])
+            as_bits, sreg, sext = self._encode_src(src, byte, 0, self.section.pc + 2)
+            dst_ext_addr = self.section.pc + 2 + (2 if sext is not None else 0)
+            ad_bit, dreg, dext = self._encode_dst(dst, dst_ext_addr)
+            self._emit_word((FORMAT_I[name] << 12) | (sreg << 8) | (ad_bit << 7) | (int(byte) << 6) | (as_bits << 4) | dreg)
+            if sext is not None:
+                self._emit_word(sext)
+            if dext is not None:
+                self._emit_word(dext)
+            return
+
+        raise AsmError("unknown instruction `%s`" % mnemonic)
+
+    def _cg(self, value, byte):
+        v = value & (0xFF if byte else 0xFFFF)
+        table = {0: (3, 0), 1: (3, 1), 2: (3, 2), 4: (2, 2), 8: (2, 3)}
+        if v in table:
+            return table[v]
+        if v == (0xFF if byte else 0xFFFF):
+            return (3, 3)
+        return None
+
+    def _encode_src(self, op, byte, opnum, ext_addr):
+        """Returns (As, register, extension word or None)."""
+        if op.mode == "reg":
+            return 0, op.reg, None
+        if op.mode == "ind":
+            return 2, op.reg, None
+        if op.mode == "inc":
+            return 3, op.reg, None
+        if op.mode == "imm":
+            key = (self.insn_index, opnum)
+            if key not in self.cg_choices:
+                try:
+                    self.cg_choices[key] = self._cg(self.value(op.expr), byte)
+                except Undefined:
+                    self.cg_choices[key] = None     # Unknown in pass 1, so it gets a full extension word forever
+            cg = self.cg_choices[key]
+            if cg is not None:
+                reg, as_bits = cg
+                return as_bits, reg, None
+            return 3, 0, self._value_or_zero(op.expr) & 0xFFFF
+        if op.mode == "idx":
+            return 1, op.reg, self._value_or_zero(op.expr) & 0xFFFF
+        if op.mode == "abs":
+            return 1, 2, self._value_or_zero(op.expr) & 0xFFFF
+        if op.mode == "sym":
+            return 1, 0, (self._value_or_zero(op.expr) - ext_addr) & 0xFFFF
+        raise AsmError("bad source operand")
+
+    def _encode_dst(self, op, ext_addr):
+        """Returns (Ad, register, extension word or None)."""
+        if op.mode == "reg":
+            return 0, op.reg, None
+        if op.mode == "idx":
+            return 1, op.reg, self._value_or_zero(op.expr) & 0xFFFF
+        if op.mode == "abs":
+            return 1, 2, self._value_or_zero(op.expr) & 0xFFFF
+        if op.mode == "sym":
+            return 1, 0, (self._value_or_zero(op.expr) - ext_addr) & 0xFFFF
+        raise AsmError("destination can not be `%s` mode" % op.mode)
+
+
+def assemble(path, externs=None, defines=None, include_dirs=None):
+    """Assemble the file at `path`. Returns an Image."""
+    from msp430fr4133_symbols import SYMBOLS, VECTOR_SECTIONS
+
+    if include_dirs is None:
+        include_dirs = [os.path.dirname(os.path.abspath(path))]
+    a = Assembler(include_dirs, SYMBOLS, VECTOR_SECTIONS, externs=externs, defines=defines)
+    return a.assemble(path)
@@ -0,0 +1,490 @@
+"""
+cpu430.py - Cycle counting MSP430 CPU model
+
+Executes MSP430 machine code out of a flat 64KB memory and counts CPU cycles using the MSP430FR4xx (CPUX core running
+MSP430 instructions) timing tables from SLAU445I section 4.5.1.5. There is no pipeline or wait state modeling since
+at 1MHz the FR4133 FRAM runs with zero wait states.
+
+The peripherals we care about are modeled only as far as the ISRs can see them...
+
+  * SYSCFG0 PFWP/DFWP - writes to program or info FRAM while protected are recorded as violations (and dropped, like the real part)
+  * SYSCTL.SYSRIVECT  - selects the RAM or FRAM interrupt vector table
+  * Port 1 IFG/IE     - `interrupt()` wakes the CPU through the PORT1 vector and we check that the ISR cleared its flag
+  * CRC module        - word writes to CRCDI update the CRC-CCITT in CRCINIRES, low byte first and each byte LSB first (CRC16 chapter of SLAU445I)
+  * everything else   - plain memory. Use `watch()` to see writes to a range (LCDMEM, the I2C pins, etc) and `input()`
+                        to make reads of a register come from a model (P1IN with something on the I2C bus)
+
+Calls to addresses registered with `hook()` run a Python function instead of code, which is how we stand in for the C side.
+"""
+
+from msp430fr4133_symbols import SYMBOLS, RAM_VECTOR_OFFSET, INFO_START, INFO_END, FRAM_START, FRAM_END
+
+PC, SP, SR, CG = 0, 1, 2, 3
+
+FLAG_C      = 0x0001
+FLAG_Z      = 0x0002
+FLAG_N      = 0x0004
+FLAG_GIE    = 0x0008
+FLAG_CPUOFF = 0x0010
+FLAG_SCG0   = 0x0040
+FLAG_V      = 0x0100
+
+SYSCFG0 = SYMBOLS["SYSCFG0"]
+SYSCTL = SYMBOLS["SYSCTL"]
+PFWP = SYMBOLS["PFWP"]
+DFWP = SYMBOLS["DFWP"]
+SYSRIVECT = SYMBOLS["SYSRIVECT"]
+CRCDI = SYMBOLS["CRCDI"]
+CRCINIRES = SYMBOLS["CRCINIRES"]
+CRC_POLY = 0x1021
+
+# *** Timing (SLAU445I Table 4-10, 4-11, 4-12 - MSP430 instructions executed on the CPUX)
+
+# Format I, indexed by [source mode][destination mode]
+# Source modes: reg (includes constant generator), ind (@Rn), inc (@Rn+), imm (#N), idx (x(Rn), EDE, &EDE)
+# Destination modes: reg, pc, mem
+FORMAT_I_CYCLES = {
+    "reg": {"reg": 1, "pc": 3, "mem": 4},
+    "ind": {"reg": 2, "pc": 4, "mem": 5},
+    "inc": {"reg": 2, "pc": 4, "mem": 5},
+    "imm": {"reg": 2, "pc": 3, "mem": 5},
+    "idx": {"reg": 3, "pc": 5, "mem": 6},
+}
+
+# MOV, BIT, and CMP do not write back their destination so are one cycle shorter when it is in memory
+NO_WRITEBACK = (0x4, 0x9, 0xB)
+
+# Format II, indexed by [instruction][source mode]
+FORMAT_II_CYCLES = {
+    "shift": {"reg": 1, "ind": 3, "inc": 3, "imm": 3, "idx": 4},     # RRA, RRC, SWPB, SXT
+    "push":  {"reg": 3, "ind": 3, "inc": 3, "imm": 3, "idx": 4},
+    "call":  {"reg": 4, "ind": 4, "inc": 4, "imm": 4, "idx": 4},
+}
+
+JUMP_CYCLES = 2
+RETI_CYCLES = 5
+INTERRUPT_CYCLES = 6        # From interrupt accepted to first instruction of the ISR
+
+OPNAMES_I = {0x4: "MOV", 0x5: "ADD", 0x6: "ADDC", 0x7: "SUBC", 0x8: "SUB", 0x9: "CMP", 0xA: "DADD",
+             0xB: "BIT", 0xC: "BIC", 0xD: "BIS", 0xE: "XOR", 0xF: "AND"}
+OPNAMES_II = {0: "RRC", 1: "SWPB", 2: "RRA", 3: "SXT", 4: "PUSH", 5: "CALL", 6: "RETI"}
+
+
+def crc_di(crc, v):
+    """What writing word `v` to CRCDI does to the CRC in CRCINIRES."""
+    for i in range(16):
+        feedback = (crc >> 15) ^ ((v >> i) & 1)
+        crc = (crc << 1) & 0xFFFF
+        if feedback:
+            crc ^= CRC_POLY
+    return crc
+
+
+class CpuError(Exception):
+    pass
+
+
+class Cpu:
+
+    def __init__(self):
+        self.mem = bytearray(0x10000)
+        self.r = [0] * 16
+        self.cycles = 0                 # Cycles executed by simulated instructions (including interrupt entry)
+        self.insn_start = 0             # `cycles` when the current instruction started. Its reads and writes happen between this and `cycles`.
+        self.hook_cycles = 0            # Cycles that Python hooks claim to have used (C code we do not simulate)
+        self.hook_calls = 0
+        self.instructions = 0
+        self.hooks = {}
+        self.watches = []
+        self.inputs = {}
+        self.violations = []
+        self.trace = None               # Set to a callable(pc, cpu) to see every instruction
+        self._decoded = {}
+
+        self.mem[SYSCFG0] = PFWP | DFWP     # Power up state - both FRAM regions locked
+
+    # ** Memory
+
+    def read8(self, a):
+        a &= 0xFFFF
+        if self.inputs and a in self.inputs:
+            return self.inputs[a](self) & 0xFF
+        return self.mem[a]
+
+    def read16(self, a):
+        a &= 0xFFFE
+        return self.mem[a] | (self.mem[a + 1] << 8)
+
+    def _protected(self, a):
+        cfg = self.mem[SYSCFG0]
+        if INFO_START <= a < INFO_END and cfg & DFWP:
+            return True
+        if FRAM_START <= a < FRAM_END and cfg & PFWP:
+            return True
+        return False
+
+    def write8(self, a, v):
+        a &= 0xFFFF
+        v &= 0xFF
+        if self._protected(a):
+            self.violations.append((self.r[PC], a, v))
+            return
+        self.mem[a] = v
+        if a >= FRAM_START:
+            self._decoded.clear()
+        for lo, hi, fn in self.watches:
+            if lo <= a < hi:
+                fn(a, v, 1)
+
+    def write16(self, a, v):
+        a &= 0xFFFE
+        v &= 0xFFFF
+        if self._protected(a):
+            self.violations.append((self.r[PC], a, v))
+            return
+        if a == CRCDI:
+            a, v = CRCINIRES, crc_di(self.read16(CRCINIRES), v)
+        self.mem[a] = v & 0xFF
+        self.mem[a + 1] = v >> 8
+        if a >= FRAM_START:
+            self._decoded.clear()
+        for lo, hi, fn in self.watches:
+            if lo <= a < hi:
+                fn(a, v, 2)
+
+    def watch(self, lo, hi, fn):
+        """Call fn(address, value, size) on every CPU write into [lo,hi)."""
+        self.watches.append((lo, hi, fn))
+
+    def input(self, addr, fn):
+        """Byte reads of `addr` return fn(cpu) instead of what is in memory."""
+        self.inputs[addr] = fn
+
+    def hook(self, addr, fn):
+        """When the CPU CALLs `addr`, run fn(cpu) instead and then return. fn may return a cycle count to charge to hook_cycles."""
+        self.hooks[addr] = fn
+
+    # ** Stack
+
+    def push(self, v):
+        self.r[SP] = (self.r[SP] - 2) & 0xFFFF
+        self.write16(self.r[SP], v)
+
+    def pop(self):
+        v = self.read16(self.r[SP])
+        self.r[SP] = (self.r[SP] + 2) & 0xFFFF
+        return v
+
+    # ** Interrupts
+
+    @property
+    def sleeping(self):
+        return bool(self.r[SR] & FLAG_CPUOFF)
+
+    def vector_address(self, fram_vector):
+        if self.mem[SYSCTL] & SYSRIVECT:
+            return fram_vector - RAM_VECTOR_OFFSET
+        return fram_vector
+
+    def interrupt(self, fram_vector):
+        """Accept an interrupt through the given vector (the FRAM address of the vector, ie 0xFFE6 for PORT1)."""
+        if not self.r[SR] & FLAG_GIE:
+            raise CpuError("interrupt with GIE clear")
+        self.push(self.r[PC])
+        self.push(self.r[SR])
+        self.r[SR] &= FLAG_SCG0
+        self.r[PC] = self.read16(self.vector_address(fram_vector))
+        self.cycles += INTERRUPT_CYCLES
+
+    def run(self, max_instructions=1000000):
+        """Execute until the CPU goes to sleep (CPUOFF set). Returns the cycles used."""
+        start = self.cycles
+        n = 0
+        while not self.r[SR] & FLAG_CPUOFF:
+            self.step()
+            n += 1
+            if n > max_instructions:
+                raise CpuError("did not go to sleep after %d instructions (pc=%04x)" % (n, self.r[PC]))
+        return self.cycles - start
+
+    # ** Operand helpers
+
+    def _src_value(self, mode, reg, ext, byte):
+        """Returns (value, address or None). Applies @Rn+ post increment."""
+        r = self.r
+        if mode == "reg":
+            v = r[reg]
+            return (v & 0xFF if byte else v), None
+        if mode == "cg":
+            v = ext & 0xFFFF
+            return (v & 0xFF if byte else v), None
+        if mode == "imm":
+            return (ext & 0xFF if byte else ext), None
+        if mode == "ind":
+            a = r[reg]
+        elif mode == "inc":
+            a = r[reg]
+            r[reg] = (a + (1 if byte and reg != SP else 2)) & 0xFFFF
+        elif mode == "idx":
+            a = (r[reg] + ext) & 0xFFFF if reg is not None else ext
+        elif mode == "sym":
+            a = ext
+        else:
+            raise CpuError("bad mode")
+        return (self.read8(a) if byte else self.read16(a)), a
+
+    # ** Decode
+
+    def _decode_src(self, as_bits, reg, pc):
+        """Returns (mode, reg, ext, timing class, words used)."""
+        if reg == CG or (reg == SR and as_bits >= 2):
+            if reg == SR:
+                return "cg", None, (4 if as_bits == 2 else 8), "reg", 0
+            return "cg", None, (0, 1, 2, 0xFFFF)[as_bits], "reg", 0
+        if as_bits == 0:
+            return "reg", reg, None, "reg", 0
+        if as_bits == 1:
+            x = self.read16(pc)
+            if reg == SR:
+                return "sym", None, x, "idx", 1
+            if reg == PC:
+                return "sym", None, (pc + x) & 0xFFFF, "idx", 1
+            return "idx", reg, x, "idx", 1
+        if as_bits == 2:
+            return "ind", reg, None, "ind", 0
+        if reg == PC:
+            return "imm", None, self.read16(pc), "imm", 1
+        return "inc", reg, None, "inc", 0
+
+    def _decode(self, pc):
+        w = self.read16(pc)
+        nxt = (pc + 2) & 0xFFFF
+
+        if w & 0xE000 == 0x2000:
+            cond = (w >> 10) & 7
+            off = w & 0x3FF
+            if off & 0x200:
+                off -= 0x400
+            return ("jmp", cond, (pc + 2 + off * 2) & 0xFFFF, nxt, JUMP_CYCLES)
+
+        if w & 0xF000 == 0x1000:
+            opc = (w >> 7) & 7
+            if opc == 6:
+                return ("reti", nxt, RETI_CYCLES)
+            if opc == 7:
+                raise CpuError("MSP430X instruction %04x at %04x not supported" % (w, pc))
+            byte = bool(w & 0x40)
+            as_bits = (w >> 4) & 3
+            reg = w & 0xF
+            mode, sreg, ext, tclass, words = self._decode_src(as_bits, reg, nxt)
+            nxt = (nxt + 2 * words) & 0xFFFF
+            kind = "push" if opc == 4 else "call" if opc == 5 else "shift"
+            cycles = FORMAT_II_CYCLES[kind][tclass]
+            return ("fmt2", opc, byte, mode, sreg, ext, nxt, cycles)
+
+        op = w >> 12
+        if op < 4:
+            raise CpuError("illegal or MSP430X instruction %04x at %04x" % (w, pc))
+        sreg = (w >> 8) & 0xF
+        ad = (w >> 7) & 1
+        byte = bool(w & 0x40)
+        as_bits = (w >> 4) & 3
+        dreg = w & 0xF
+        smode, sreg, sext, tclass, words = self._decode_src(as_bits, sreg, nxt)
+        nxt = (nxt + 2 * words) & 0xFFFF
+        if ad == 0:
+            dmode, dext = "reg", None
+            dclass = "pc" if dreg == PC else "reg"
+        else:
+            x = self.read16(nxt)
+            if dreg == SR:
+                dmode, dext, dreg = "sym", x, None
+            elif dreg == PC:
+                dmode, dext, dreg = "sym", (nxt + x) & 0xFFFF, None
+            else:
+                dmode, dext = "idx", x
+            nxt = (nxt + 2) & 0xFFFF
+            dclass = "mem"
+        cycles = FORMAT_I_CYCLES[tclass][dclass]
+        if dclass == "mem" and op in NO_WRITEBACK:
+            cycles -= 1
+        return ("fmt1", op, byte, smode, sreg, sext, dmode, dreg, dext, nxt, cycles)
+
+    # ** Execute
+
+    def _set_nz(self, v, byte):
+        sr = self.r[SR] & ~(FLAG_N | FLAG_Z)
+        if v == 0:
+            sr |= FLAG_Z
+        if v & (0x80 if byte else 0x8000):
+            sr |= FLAG_N
+        self.r[SR] = sr
+
+    def _set_flag(self, flag, on):
+        if on:
+            self.r[SR] |= flag
+        else:
+            self.r[SR] &= ~flag
+
+    def step(self):
+        r = self.r
+        pc = r[PC]
+
+        if pc in self.hooks:
+            # Stand in for a C function. The CALL already pushed the return address.
+            used = self.hooks[pc](self)
+            self.hook_calls += 1
+            self.hook_cycles += used or 0
+            r[PC] = self.pop()
+            return
+
+        d = self._decoded.get(pc)
+        if d is None:
+            d = self._decode(pc)
+            self._decoded[pc] = d
+
+        if self.trace:
+            self.trace(pc, self)
+
+        self.instructions += 1
+        self.insn_start = self.cycles
+        kind = d[0]
+
+        if kind == "jmp":
+            _, cond, target, nxt, cycles = d
+            sr = r[SR]
+            n = bool(sr & FLAG_N)
+            v = bool(sr & FLAG_V)
+            take = (
+                not sr & FLAG_Z, sr & FLAG_Z, not sr & FLAG_C, sr & FLAG_C,
+                n, n == v, n != v, True,
+            )[cond]
+            r[PC] = target if take else nxt
+            self.cycles += cycles
+            return
+
+        if kind == "reti":
+            _, nxt, cycles = d
+            r[SR] = self.pop()
+            r[PC] = self.pop()
+            self.cycles += cycles
+            return
+
+        if kind == "fmt2":
+            _, opc, byte, mode, sreg, ext, nxt, cycles = d
+            r[PC] = nxt
+            self.cycles += cycles
+            val, addr = self._src_value(mode, sreg, ext, byte)
+
+            if opc == 4:        # PUSH
+                self.push(val)
+                return
+            if opc == 5:        # CALL
+                self.push(nxt)
+                r[PC] = val
+                return
+
+            mask = 0xFF if byte else 0xFFFF
+            msb = 0x80 if byte else 0x8000
+            if opc == 0:        # RRC
+                res = (val >> 1) | (msb if r[SR] & FLAG_C else 0)
+                self._set_flag(FLAG_C, val & 1)
+                self._set_flag(FLAG_V, False)
+            elif opc == 2:      # RRA
+                res = (val >> 1) | (val & msb)
+                self._set_flag(FLAG_C, val & 1)
+                self._set_flag(FLAG_V, False)
+            elif opc == 1:      # SWPB
+                res = ((val << 8) | (val >> 8)) & 0xFFFF
+            else:               # SXT
+                res = (val | 0xFF00) if val & 0x80 else (val & 0xFF)
+                self._set_flag(FLAG_C, res != 0)
+                self._set_flag(FLAG_V, False)
+            res &= mask
+            if opc != 1:
+                self._set_nz(res, byte and opc != 3)
+            if mode == "reg":
+                r[sreg] = res
+            else:
+                (self.write8 if byte else self.write16)(addr, res)
+            return
+
+        _, op, byte, smode, sreg, sext, dmode, dreg, dext, nxt, cycles = d
+        r[PC] = nxt
+        self.cycles += cycles
+
+        src, _ = self._src_value(smode, sreg, sext, byte)
+
+        mask = 0xFF if byte else 0xFFFF
+        msb = 0x80 if byte else 0x8000
+
+        if dmode == "reg":
+            daddr = None
+            dst = r[dreg] & mask
+        else:
+            daddr = dext if dmode == "sym" else (r[dreg] + dext) & 0xFFFF
+            dst = None if op == 0x4 else (self.read8(daddr) if byte else self.read16(daddr))
+
+        write = True
+        if op == 0x4:                           # MOV
+            res = src
+        elif op in (0x5, 0x6, 0x7, 0x8, 0x9):   # ADD, ADDC, SUBC, SUB, CMP
+            if op in (0x7, 0x8, 0x9):
+                s = (~src) & mask
+                carry = 1 if op in (0x8, 0x9) else (r[SR] & FLAG_C)
+            else:
+                s = src
+                carry = (r[SR] & FLAG_C) if op == 0x6 else 0
+            total = dst + s + carry
+            res = total & mask
+            self._set_flag(FLAG_C, total > mask)
+            self._set_flag(FLAG_V, (~(dst ^ s) & (dst ^ res)) & msb)
+            self._set_nz(res, byte)
+            write = op != 0x9
+        elif op == 0xA:                         # DADD
+            carry = r[SR] & FLAG_C
+            res = 0
+            for shift in range(0, 8 if byte else 16, 4):
+                digit = ((src >> shift) & 0xF) + ((dst >> shift) & 0xF) + carry
+                carry = 1 if digit > 9 else 0
+                if carry:
+                    digit -= 10
+                res |= (digit & 0xF) << shift
+            self._set_flag(FLAG_C, carry)
+            self._set_nz(res, byte)
+        elif op in (0xB, 0xF):                  # BIT, AND
+            res = src & dst
+            self._set_nz(res, byte)
+            self._set_flag(FLAG_C, res != 0)
+            self._set_flag(FLAG_V, False)
+            write = op == 0xF
+        elif op == 0xC:                         # BIC
+            res = dst & ~src & mask
+        elif op == 0xD:                         # BIS
+            res = dst | src
+        else:                                   # XOR
+            res = (src ^ dst) & mask
+            self._set_nz(res, byte)
+            self._set_flag(FLAG_C, res != 0)
+            self._set_flag(FLAG_V, (src & msb) and (dst & msb))
+
+        if not write:
+            return
+
+        if daddr is None:
+            if dreg == CG:
+                return                          # NOP and friends
+            # Byte operations on registers clear the upper byte
+            r[dreg] = res & mask if dreg != SR else res & 0xFFFF
+            if dreg == PC:
+                r[PC] &= 0xFFFE
+        elif byte:
+            self.write8(daddr, res)
+        else:
+            self.write16(daddr, res)
+
+    # ** Disassembly for traces
+
+    def disassemble(self, pc):
+        d = self._decode(pc)
+        return d[0] if d[0] in ("jmp", "reti") else (OPNAMES_I.get(d[1]) if d[0] == "fmt1" else OPNAMES_II.get(d[1]))
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+energy_budget.py - Turn ISR cycle counts into average current and battery life
+
+Runs the same simulation as tsl_bench.py to get the cycles for each kind of tick, combines them with the static
+current model in power_model.json, and prints for each mode and Vcc...
+
+  * how much each static load and each code path contributes to the average current
+  * how many years of battery life we lose to each one (the number that tells you if an optimization matters)
+  * the projected life on a set of batteries
+
+    python3 energy_budget.py                          # Current asm
+    python3 energy_budget.py -D TSL_SOME_FLAG=1       # With a build option
+    python3 energy_budget.py --bench before.json      # Use saved `tsl_bench.py --json` output instead of running the sim
+    python3 energy_budget.py --cycles tsl_second=15   # What if a plain second took 15 cycles?
+"""
+
+import argparse
+import json
+import math
+import os
+import sys
+
+import tsl_bench
+
+HOURS_PER_YEAR = 24 * 365.25
+SECONDS_PER_DAY = 24 * 60 * 60
+
+DEFAULT_MODEL = os.path.join(os.path.dirname(os.path.abspath(__file__)), "power_model.json")
+
+
+def life_years(avg_ua, battery, one_time_mah=0.0):
+    """Years until the battery is empty at a constant load, with self discharge proportional to what is left.
+    dC/dt = -L - rC  =>  t = ln(1 + C0*r/L) / r"""
+    c0 = battery["capacity_mah"] * battery["usable_fraction"] - one_time_mah
+    load = avg_ua / 1000.0 * HOURS_PER_YEAR           # mAh per year
+    r = -math.log(1.0 - battery["self_discharge_pct_per_year"] / 100.0)
+    if load <= 0:
+        return float("inf")
+    if r == 0:
+        return c0 / load
+    return math.log(1.0 + c0 * r / load) / r
+
+
+def event_charge_nc(cycles, vcc_model):
+    """Charge for one wake up that runs `cycles` CPU cycles."""
+    return cycles * vcc_model["active_ua_per_mhz"] / 1000.0 + vcc_model["wake_nc"]
+
+
+def budget(model, events, mode_name, vcc_name):
+    """Returns (rows, total uA, one time mAh) where rows are (name, description, uA)."""
+    mode = model["modes"][mode_name]
+    vcc = model["vcc"][vcc_name]
+    rows = []
+
+    for name in mode["static"]:
+        rows.append((name, "static: " + name, vcc["static_ua"][name]))
+
+    for name, per_day in mode["events_per_day"].items():
+        e = events[name]
+        rows.append((name, e["description"], event_charge_nc(e["cycles"], vcc) * per_day / SECONDS_PER_DAY / 1000.0))
+        c = e.get("c_cycles", 0)
+        if c is None:
+            c = model["c_estimates"].get(name)
+            if c is None:
+                raise SystemExit("event `%s` calls C that the sim can not count and there is no estimate in the model" % name)
+            rows.append((name + "_c", "  C called from " + e["description"] + " (estimate)",
+                         c * vcc["active_ua_per_mhz"] / 1000.0 * per_day / SECONDS_PER_DAY / 1000.0))
+        elif c:
+            rows.append((name + "_c", "  C called from " + e["description"],
+                         c * vcc["active_ua_per_mhz"] / 1000.0 * per_day / SECONDS_PER_DAY / 1000.0))
+
+    for name, x in model.get("extras", {}).get(mode_name, {}).items():
+        nc = x["extra_ua"] * x["seconds"] * 1000.0
+        rows.append((name, x["description"], nc / (x["every_days"] * SECONDS_PER_DAY) / 1000.0))
+
+    one_time_mah = 0.0
+    for x in model.get("one_time", {}).values():
+        one_time_mah += event_charge_nc(x["cycles"], vcc) / 1e9 / 3.6       # nC -> mAh
+
+    total = sum(r[2] for r in rows)
+    return rows, total, one_time_mah
+
+
+def report(model, events, out=sys.stdout):
+    battery = model["battery"]
+    print("Battery: %s, %dmAh x %.0f%% usable, %.1f%%/year self discharge" % (
+        battery["name"], battery["capacity_mah"], battery["usable_fraction"] * 100,
+        battery["self_discharge_pct_per_year"]), file=out)
+
+    for mode_name, mode in model["modes"].items():
+        blended = 0.0
+        weights = 0.0
+        for vcc_name, vcc in model["vcc"].items():
+            rows, total, one_time_mah = budget(model, events, mode_name, vcc_name)
+            life = life_years(total, battery, one_time_mah)
+            print("", file=out)
+            print("== %s (%s) at Vcc=%sV" % (mode["description"], mode_name, vcc_name), file=out)
+            print("", file=out)
+            print("%-50s %10s %7s %12s" % ("", "nA", "share", "life cost"), file=out)
+            for name, desc, ua in rows:
+                cost = life_years(total - ua, battery, one_time_mah) - life
+                print("%-50s %10.3f %6.2f%% %9.2f yr" % (desc, ua * 1000, 100 * ua / total, cost), file=out)
+            print("%-50s %10.3f" % ("total", total * 1000), file=out)
+            measured = vcc.get("measured_ua", {}).get(mode_name)
+            if measured:
+                print("%-50s %10.3f" % ("measured (README)", measured * 1000), file=out)
+                print("%-50s %10.3f" % ("unexplained (measured - model)", (measured - total) * 1000), file=out)
+            print("", file=out)
+            print("Average %.3fuA -> %.1f years (%.1f without self discharge). One time costs %.2gmAh." % (
+                total, life, life_years(total, dict(battery, self_discharge_pct_per_year=0), one_time_mah), one_time_mah), file=out)
+            blended += vcc["life_weight"] * life
+            weights += vcc["life_weight"]
+        print("", file=out)
+        print(">> %s: %.1f years, weighted across Vcc by how long the batteries spend there" % (mode["description"], blended / weights), file=out)
+
+    print("", file=out)
+    print("`life cost` is how many more years we would get if that line were zero.", file=out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--model", default=DEFAULT_MODEL, help="power model JSON (default power_model.json)")
+    ap.add_argument("--bench", metavar="FILE", help="use saved `tsl_bench.py --json` output rather than running the sim")
+    ap.add_argument("-D", dest="defines", action="append", metavar="NAME=VALUE", help="override a header #define")
+    ap.add_argument("--cycles", action="append", metavar="EVENT=N", help="pretend an event takes N cycles")
+    args = ap.parse_args()
+
+    with open(args.model) as f:
+        model = json.load(f)
+
+    if args.bench:
+        with open(args.bench) as f:
+            events = json.load(f)["events"]
+    else:
+        events = tsl_bench.run(tsl_bench.parse_defines(args.defines))
+
+    for c in args.cycles or []:
+        name, _, n = c.partition("=")
+        if name not in events:
+            raise SystemExit("unknown event `%s`, try one of %s" % (name, ", ".join(events)))
+        events[name]["cycles"] = int(n)
+
+    report(model, events)
+
+
+if __name__ == "__main__":
+    main()
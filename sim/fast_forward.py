@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+fast_forward.py - Run the whole 1,000,000 day time-since-launch lifetime on the host
+
+Runs the real `tsl_asm.asm` from launch all the way to the Long Now, checking the display and persistent data at every day rollover, every centesimus dies message, and the final
+transition to all 9's. The full lifetime is ~86 billion ticks, so we do not step through them all...
+
+  1. Verify. Step through a couple of whole days one tick at a time, check every frame against the decoder, and
+     record every byte the ISR writes between one midnight and the next (and the registers at the end). If that
+     delta comes out the same no matter what day we start on, and it never touches the day digits, anything in the
+     counter slots but the current slot's mins, or the registers that hold the day count, then a day of non-rollover
+     ticks does the same thing to the machine on every day. The current slot changes every day, so its mins goes in
+     the delta relative to the slot pointer.
+  2. Fast forward. For each day, apply the delta (jumping from 00:00:00 to 23:59:59 in one step), then run the
+     midnight tick through the simulated CPU for real, since that is where the day logic lives.
+
+Since the time digits and the day digits live in different LCDMEM bytes, every frame we skip is the verified
+time-of-day frame with that day's digits next to it, and those get checked at 23:59:59 every day.
+
+    python3 fast_forward.py                       # Launch to Long Now, takes a few minutes
+    python3 fast_forward.py --days 1000           # Just the first 1000 days
+    python3 fast_forward.py --start-day 999000    # Just the end
+    python3 fast_forward.py -D TSL_SOME_FLAG=1    # With a build option
+"""
+
+import argparse
+import sys
+import time
+
+import lcd_model
+from tsl_bench import parse_defines
+from tsl_sim import TslFirmware, LongNow, LCDMEM, LCDMEMCTL, LCDDISP, LCDBLKCTL, SLOT_ADDRESSES, SLOT_SIZE, MINS_PER_DAY, LONG_NOW_DAYS, STACK_TOP, DAY_REGISTERS
+
+SECS_PER_DAY = MINS_PER_DAY * 60
+CENTESIMUS_DAYS = 128
+
+# LCDMEM bytes that hold the day digits. The ISRs must never write these.
+DAY_DIGIT_ADDRESSES = sorted({LCDMEM + lcd_model.lpin_lcdmem_offset(lpin)
+                              for pos in range(6, lcd_model.DIGITPLACE_COUNT)
+                              for lpin in lcd_model.DIGITPLACE_LPINS[pos]})
+
+# The counter slots. Between midnights the ISR may only write the mins of the one it is counting in (R11).
+SLOT_BYTE_ADDRESSES = sorted(a + i for a in SLOT_ADDRESSES for i in range(SLOT_SIZE))
+SLOT_REGISTER = 11
+
+
+class DayDelta:
+    """What one day of ticks after midnight does to the machine."""
+
+    def __init__(self, mem, regs, slot_mins, cycles):
+        self.mem = mem              # {address: byte} for every byte written, except the counter slots, with its value at 23:59:59
+        self.regs = regs            # All 16 registers at 23:59:59 (asleep), with the DAY_REGISTERS as None
+        self.slot_mins = slot_mins  # The mins in the current counter slot at 23:59:59
+        self.cycles = cycles        # Sum of the 86399 non-midnight ticks
+
+    def __eq__(self, other):
+        return (self.mem, self.regs, self.slot_mins, self.cycles) == (other.mem, other.regs, other.slot_mins, other.cycles)
+
+    def apply(self, fw):
+        mem = fw.cpu.mem
+        for a, v in self.mem.items():
+            mem[a] = v
+        for reg, v in enumerate(self.regs):
+            if v is not None:
+                fw.cpu.r[reg] = v
+        fw.poke16(fw.cpu.r[SLOT_REGISTER], self.slot_mins)
+        fw.lcddisp = fw.peek16(LCDMEMCTL) & LCDDISP     # The sim's copy of what the LCD is showing, which the poke above went around
+
+
+def _check(what, actual, expected):
+    if actual != expected:
+        raise AssertionError("%s is `%s`, expected `%s`" % (what, actual, expected))
+
+
+def _check_midnight(fw, days):
+    _check("display after day %d rollover" % days, fw.display(), lcd_model.tsl_text(days, 0, 0, 0))
+    newest = fw.newest_slot()
+    old = [slot for slot in fw.counter_slots() if slot["address"] != newest["address"]][0]
+    _check("persistent days", newest["days"], days)
+    _check("persistent mins", newest["mins"], 0)
+    _check("slot the ISR counts in", fw.cpu.r[SLOT_REGISTER], newest["address"])
+    _check("previous slot", (old["valid"], old["days"], old["mins"], (newest["seq"] - old["seq"]) & 0xFFFF), (True, days - 1, MINS_PER_DAY, 1))
+
+
+def _start_at_midnight(defines, day):
+    """A TslFirmware sitting at 23:59:59 on `day`, having come up through TSL_MODE_BEGIN."""
+    fw = TslFirmware(defines)
+    fw.start_tsl(day, 23, 59, 58)
+    fw.tick()
+    _check("display", fw.display(), lcd_model.tsl_text(day, 23, 59, 59))
+    return fw
+
+
+def record_day(defines, day):
+    """Step tick by tick from midnight at the start of `day` + 1 to 23:59:59, checking every frame.
+    Returns the DayDelta."""
+    fw = _start_at_midnight(defines, day)
+    day += 1
+    fw.tick()
+    _check_midnight(fw, day)
+
+    written = set()
+
+    def on_write(a, v, size):
+        written.update(range(a, a + size))
+
+    fw.cpu.watch(0, 0x10000, on_write)
+    day_regs = [fw.cpu.r[reg] for reg in DAY_REGISTERS]
+    calls = fw.cpu.hook_calls
+    mins_addr = fw.cpu.r[SLOT_REGISTER]
+    hourly_checkpoint = fw.image.value("TSL_RTC_RECOVERY")     # Then the persistent mins only move once an hour
+    cycles = 0
+    for t in range(1, SECS_PER_DAY):
+        cycles += fw.tick()
+        h, m, s = t // 3600, t // 60 % 60, t % 60
+        _check("display", fw.display(), lcd_model.tsl_text(day, h, m, s))
+        if s == 0:
+            _check("persistent mins at %02d:%02d" % (h, m), fw.peek16(mins_addr), h * 60 + (0 if hourly_checkpoint else m))
+    _check("calls into C during the day", fw.cpu.hook_calls, calls)
+    _check("day count registers at 23:59:59", [fw.cpu.r[reg] for reg in DAY_REGISTERS], day_regs)
+    _check("LCDBMEM bank showing at 23:59:59", fw.lcddisp, 0)
+    _check("LCDBLKCTL at 23:59:59", fw.peek16(LCDBLKCTL), fw.image.value("TSL_LCD_BLINK_CTL") if fw.image.value("TSL_LCD_BLINK") else 0)
+
+    written -= {mins_addr, mins_addr + 1}
+    for what, addresses in (("day digits in LCDMEM", DAY_DIGIT_ADDRESSES), ("counter slots", SLOT_BYTE_ADDRESSES)):
+        hit = written.intersection(addresses)
+        if hit:
+            raise AssertionError("the ISR wrote the %s (%s) between midnights" % (what, ", ".join("%04x" % a for a in sorted(hit))))
+
+    regs = [None if reg in DAY_REGISTERS else v for reg, v in enumerate(fw.cpu.r)]
+    delta = DayDelta({a: fw.cpu.mem[a] for a in sorted(written)}, regs, fw.peek16(mins_addr), cycles)
+    delta.stack_bytes = STACK_TOP - fw.stack_low
+    return delta
+
+
+def verify(defines, days, progress=None):
+    """record_day() for each of `days` and check they all match. Returns the DayDelta."""
+    delta = None
+    for day in days:
+        if progress:
+            progress("verifying day %d tick by tick" % (day + 1))
+        d = record_day(defines, day)
+        if delta is None:
+            delta = d
+        elif d != delta:
+            raise AssertionError("a day starting at %d does not do the same thing as one starting at %d" % (day, days[0]))
+    return delta
+
+
+def fast_forward(defines, delta, start_day, count, progress=None):
+    """Run `count` day rollovers starting from 23:59:59 on `start_day`. Returns a dict of totals."""
+    fw = _start_at_midnight(defines, start_day)
+    cycles_before = fw.cpu.cycles
+    centesimus = 0
+    long_now = False
+    day = start_day
+    last_progress = time.time()
+
+    while day < start_day + count:
+        try:
+            fw.tick()
+        except LongNow:
+            _check("day at Long Now", day + 1, LONG_NOW_DAYS)
+            _check("display at Long Now", fw.display(), "9" * lcd_model.DIGITPLACE_COUNT)
+            long_now = True
+            break
+        day += 1
+        _check_midnight(fw, day)
+
+        if fw.events:
+            event = fw.events.pop()
+            _check("event on day %d" % day, event[:2], ("centesimus", day))
+            _check("centesimus dies message", event[2], lcd_model.CENTESIMUS_DIES_MESSAGE)
+            centesimus += 1
+        elif day % CENTESIMUS_DAYS == 0:
+            raise AssertionError("no centesimus dies message on day %d" % day)
+
+        delta.apply(fw)
+        _check("display", fw.display(), lcd_model.tsl_text(day, 23, 59, 59))
+
+        if progress and time.time() - last_progress > 5:
+            progress("day %d" % day)
+            last_progress = time.time()
+
+    # Only the midnight ticks actually ran. This includes the last one, into long_now_mode(), if we got there.
+    midnight_cycles = fw.cpu.cycles - cycles_before
+    days = day - start_day
+    return {
+        "days": days,
+        "ticks": days * SECS_PER_DAY,
+        "cycles": midnight_cycles + days * delta.cycles,
+        "midnight_cycles": midnight_cycles,
+        "centesimus": centesimus,
+        "long_now": long_now,
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-D", dest="defines", action="append", metavar="NAME=VALUE", help="override a header #define")
+    ap.add_argument("--start-day", type=int, default=0, help="day to start on (default 0, launch)")
+    ap.add_argument("--days", type=int, default=LONG_NOW_DAYS, help="day rollovers to run (default all the way to the Long Now)")
+    ap.add_argument("--verify-days", type=int, nargs="+", default=[0, 123455],
+                    help="days to step through tick by tick before fast forwarding (default 0 123455)")
+    ap.add_argument("-q", "--quiet", action="store_true", help="no progress messages")
+    args = ap.parse_args()
+
+    def progress(msg):
+        if not args.quiet:
+            print(msg, file=sys.stderr)
+
+    defines = parse_defines(args.defines)
+    start = time.time()
+    delta = verify(defines, args.verify_days, progress)
+    progress("a day is %d ticks, %d cycles, writes %d bytes, and goes %d bytes deep on the stack" % (
+        SECS_PER_DAY - 1, delta.cycles, len(delta.mem), delta.stack_bytes))
+
+    t = fast_forward(defines, delta, args.start_day, args.days, progress)
+
+    print("Days:                    %d (%d to %d)" % (t["days"], args.start_day, args.start_day + t["days"]))
+    print("Ticks:                   %d" % t["ticks"])
+    print("Cycles (asm):            %d (%.1f per tick)" % (t["cycles"], t["cycles"] / max(t["ticks"], 1)))
+    print("Midnight cycles (asm):   %d" % t["midnight_cycles"])
+    print("Centesimus dies:         %d" % t["centesimus"])
+    print("Long Now:                %s" % ("reached" if t["long_now"] else "not reached"))
+    print("All checks passed in %.0f seconds." % (time.time() - start))
+
+
+if __name__ == "__main__":
+    main()
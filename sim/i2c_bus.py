@@ -0,0 +1,519 @@
+#!/usr/bin/env python3
+"""
+i2c_bus.py - Runs the I2C engine in i2c_asm.asm against a model of the RV3032 and checks the bus timing
+
+Assembles `CCS Project/i2c_asm.asm`, calls `i2c_transfer()` on the simulated MSP430 the way the C would,
+and turns every write to P1OUT, P1DIR, and P1REN into SCL and SDA edges with the time they happened (from the cycle
+count at I2C_MCLK_HZ). A model of the RV3032 on the other end of the bus answers like the real one, and every edge is
+checked against the minimums in i2c_asm.h...
+
+  * SCL low and high times (tLOW, tHIGH) and the SCL period (I2C_BUS_HZ)
+  * SDA settled for tSU;DAT before each SCL rise, and only changing while SCL is low
+  * START and STOP setup and hold (tSU;STA, tHD;STA, tSU;STO) and bus free time between them (tBUF)
+  * We never drive SDA high while the RV3032 might be pulling it low. It may start to change SDA as soon as SCL goes
+    low and has until tVD;DAT to finish, so that whole window counts.
+  * We only sample SDA when it has settled. A released SDA takes I2C_T_RISE_NS to get up through the pull-up.
+  * The other P1 pins never change
+
+Then it checks that the bytes ended up where they should in the RV3032 registers and back in the read buffers, and
+that a batch of several ops goes out as one START, a repeated START between each, and one STOP.
+
+    python3 i2c_bus.py                                  # At the default MCLK and bus speed
+    python3 i2c_bus.py -D I2C_MCLK_HZ=16000000          # What if MCLK was 16MHz
+    python3 i2c_bus.py -D I2C_BUS_HZ=100000 --trace     # Standard mode, and print every edge
+"""
+
+import argparse
+import os
+import sys
+
+from asm430 import assemble
+from cpu430 import Cpu, PC, SP, SR
+from msp430fr4133_symbols import SYMBOLS, RAM_END
+from tsl_bench import parse_defines
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PROJECT_DIR = os.path.join(REPO, "CCS Project")
+ASM_PATH = os.path.join(PROJECT_DIR, "i2c_asm.asm")
+
+P1IN = SYMBOLS["P1IN"]
+P1OUT = SYMBOLS["P1OUT"]
+P1DIR = SYMBOLS["P1DIR"]
+P1REN = SYMBOLS["P1REN"]
+
+RV3032_ADDR = 0x51                  # RV_3032_I2C_ADDR
+RV3032_VCC = 1 << 2                 # The other P1 pins that are outputs while we do I2C (RV3032_VCC_B)
+
+# The C calls come back here, where a BIS #CPUOFF,SR stops cpu.run()
+RETURN_ADDRESS = 0xF100
+OPS_ADDRESS = 0x2000                # The i2c_op_t array
+BUFFER_ADDRESS = 0x2040             # The data for the ops, one after another
+I2C_OP_READ = 0x80
+STACK_TOP = RAM_END
+
+
+class BusError(Exception):
+    pass
+
+
+class Rv3032:
+    """The slave end. 256 registers with the address auto incrementing, like the RV3032 does across its register map."""
+
+    def __init__(self):
+        self.regs = bytearray(256)
+        self.ptr = 0
+        self.state = "idle"         # idle, addr, write, read, ignore
+        self.bit = 0                # Bits of the current byte clocked so far, 8 during the ACK clock
+        self.byte = 0
+        self.reg_set = False        # Has this write transfer set the register pointer yet
+        self.acked = False
+        self.out = 1                # What we do to SDA: 0 = pull low, 1 = let go
+        self.transfers = []         # ("W" or "R", register, bytes)
+
+
+class Bus:
+
+    def __init__(self, defines=None, trace=False):
+        self.image = assemble(ASM_PATH, externs={}, defines=defines, include_dirs=[PROJECT_DIR])
+        v = self.image.value
+        self.mclk_hz = v("I2C_MCLK_HZ")
+        self.bus_hz = v("I2C_BUS_HZ")
+        self.scl_mask = v("I2C_SCL")
+        self.sda_mask = v("I2C_SDA")
+        self.t = {name: v("I2C_T_%s_NS" % name) for name in ("LOW", "HIGH", "SU_STA", "HD_STA", "SU_STO", "BUF", "SU_DAT", "VD_DAT", "RISE")}
+        self.period_ns = 1e9 / self.bus_hz
+        self.trace = trace
+
+        self.cpu = cpu = Cpu()
+        self.image.load_into(cpu.mem)
+        cpu.mem[RETURN_ADDRESS:RETURN_ADDRESS + 4] = bytes([0x32, 0xD0, 0x10, 0x00])        # BIS #CPUOFF,SR
+
+        # The pins as i2c_init() leaves them: SCL driven high, SDA on the pull-up, and the RV3032 powered
+        cpu.mem[P1DIR] = self.scl_mask | RV3032_VCC
+        cpu.mem[P1REN] = self.sda_mask
+        cpu.mem[P1OUT] = self.scl_mask | self.sda_mask | RV3032_VCC
+        self.others = cpu.mem[P1OUT] & ~(self.scl_mask | self.sda_mask)
+
+        cpu.watch(P1OUT, P1REN + 1, self._on_write)
+        cpu.input(P1IN, self._on_read)
+
+        self.slave = Rv3032()
+        self.errors = []
+
+        # SCL
+        self.scl = 1
+        self.scl_rise = -1e12       # Times in ns of the last edges
+        self.scl_fall = -1e12
+        self.last_rise_in_transfer = None
+        self.fastest_period = 1e18
+
+        # SDA is whatever the master and slave together make it. `level` is 0, 1, or None when it is changing or floating,
+        # `valid_from` is when it got there (which can be in the future while the pull-up brings it up), and `changed` is
+        # when it last started to move.
+        self.master = "pullup"      # drive0, drive1, pulldown, pullup, float
+        self.slave_window_end = None
+        self.slave_next = None
+        self.level = 1
+        self.valid_from = -1e12
+        self.changed = -1e12
+
+        self.start_time = None
+        self.stop_time = -1e12
+        self.starts = self.stops = 0
+        self.edges = 0
+
+    # ** Time
+
+    def now(self):
+        return self.cpu.cycles * 1e9 / self.mclk_hz
+
+    def _error(self, t, msg):
+        self.errors.append("%10.0f ns: %s" % (t, msg))
+
+    def _log(self, t, msg):
+        if self.trace:
+            print("%10.0f ns  SCL=%d SDA=%s  %s" % (t, self.scl, "-" if self.level is None else self.level, msg))
+
+    # ** SDA
+
+    def _advance(self, t):
+        """Let the RV3032 finish any change it started at the last SCL fall, if that is before `t`."""
+        if self.slave_window_end is not None and self.slave_window_end <= t:
+            end = self.slave_window_end
+            self.slave_window_end = None
+            self.slave.out = self.slave_next
+            self._resolve(end)
+
+    def _resolve(self, t):
+        """Work out SDA from what the master and the RV3032 are doing to it at `t`."""
+        old, old_valid = self.level, self.valid_from
+        slave_moving = self.slave_window_end is not None
+        if self.master == "drive1" and (self.slave.out == 0 or slave_moving):
+            self._error(t, "driving SDA high while the RV3032 may be pulling it low")
+
+        if self.master == "drive0":
+            level, pulled = 0, False
+        elif slave_moving:
+            level, pulled = None, False
+        elif self.slave.out == 0:
+            level, pulled = 0, False
+        elif self.master == "drive1":
+            level, pulled = 1, False
+        elif self.master in ("pullup", "pulldown"):
+            level, pulled = (1 if self.master == "pullup" else 0), True
+        else:
+            level, pulled = None, False
+
+        if level is None:
+            valid = 1e18
+        elif level == old and (old_valid <= t or pulled):
+            valid = old_valid                   # Already there, or already on its way there
+        else:
+            valid = t + self.t["RISE"] if pulled else t
+
+        if (level, valid) != (old, old_valid):
+            self.changed = t
+        self.level, self.valid_from = level, valid
+
+        if self.scl and level != old:
+            if old == 1 and level == 0:
+                self._start(t)
+            elif old == 0 and level == 1:
+                self._stop(t)
+            else:
+                self._error(t, "SDA let go while SCL is high")
+
+    def _sda_settled(self, t, since):
+        """SDA has been at its level since `since` and it is still there at `t` (everything up to `t` has been applied)."""
+        return self.level is not None and self.valid_from <= since and self.changed <= since
+
+    # ** Conditions
+
+    def _start(self, t):
+        if t - self.scl_rise < self.t["SU_STA"]:
+            self._error(t, "START only %.0f ns after SCL high (tSU;STA %d)" % (t - self.scl_rise, self.t["SU_STA"]))
+        if t - self.stop_time < self.t["BUF"]:
+            self._error(t, "START only %.0f ns after STOP (tBUF %d)" % (t - self.stop_time, self.t["BUF"]))
+        self._log(t, "START")
+        self.starts += 1
+        self.start_time = t
+        s = self.slave
+        s.state, s.bit, s.byte = "addr", 0, 0
+
+    def _stop(self, t):
+        if t - self.scl_rise < self.t["SU_STO"]:
+            self._error(t, "STOP only %.0f ns after SCL high (tSU;STO %d)" % (t - self.scl_rise, self.t["SU_STO"]))
+        self._log(t, "STOP")
+        self.stops += 1
+        self.stop_time = t
+        self.last_rise_in_transfer = None
+        self.slave.state = "idle"
+
+    # ** The RV3032
+
+    def _slave_drive(self, t, out):
+        """Start moving SDA to `out` at SCL fall `t`. It might happen any time up to tVD;DAT later."""
+        if out != self.slave.out:
+            self.slave_next = out
+            self.slave_window_end = t + self.t["VD_DAT"]
+            self._resolve(t)
+
+    def _scl_rise(self, t):
+        low = t - self.scl_fall
+        if low < self.t["LOW"]:
+            self._error(t, "SCL low only %.0f ns (tLOW %d)" % (low, self.t["LOW"]))
+        if self.last_rise_in_transfer is not None and t - self.last_rise_in_transfer < self.period_ns:
+            self._error(t, "SCL period %.0f ns is faster than %d Hz" % (t - self.last_rise_in_transfer, self.bus_hz))
+        if self.last_rise_in_transfer is not None:
+            self.fastest_period = min(self.fastest_period, t - self.last_rise_in_transfer)
+        if self.start_time is not None:
+            self.last_rise_in_transfer = t
+
+        s = self.slave
+        if s.state in ("addr", "write", "ignore") and s.bit < 8:
+            # We take the bit on the rise, so it has to have been there for tSU;DAT
+            if not self._sda_settled(t, t - self.t["SU_DAT"]):
+                self._error(t, "SDA not settled for tSU;DAT (%d) before SCL high" % self.t["SU_DAT"])
+            s.byte = (s.byte << 1 | (self.level or 0)) & 0xFF
+            s.bit += 1
+        elif s.state == "read" and s.bit == 8:
+            if not self._sda_settled(t, t - self.t["SU_DAT"]):
+                self._error(t, "our ACK/NACK not settled for tSU;DAT (%d) before SCL high" % self.t["SU_DAT"])
+            s.acked = self.level == 0
+            s.bit = 9
+        elif s.state == "read":
+            s.bit += 1
+        elif s.state in ("addr", "write") and s.bit == 8:
+            s.bit = 9           # The ACK clock
+
+    def _scl_fall(self, t):
+        high = t - self.scl_rise
+        if high < self.t["HIGH"]:
+            self._error(t, "SCL high only %.0f ns (tHIGH %d)" % (high, self.t["HIGH"]))
+        if self.start_time is not None and self.start_time > self.scl_rise:
+            if t - self.start_time < self.t["HD_STA"]:
+                self._error(t, "SCL low only %.0f ns after START (tHD;STA %d)" % (t - self.start_time, self.t["HD_STA"]))
+
+        s = self.slave
+        if s.state in ("addr", "write", "ignore") and s.bit == 8:
+            # Got a whole byte. ACK it if it is for us.
+            if s.state == "addr":
+                s.acked = (s.byte >> 1) == RV3032_ADDR
+                s.rw = s.byte & 1
+                if s.acked and not s.rw:
+                    s.reg_set = False
+                if s.acked and s.rw:
+                    s.transfers.append(["R", s.ptr, bytearray()])
+            elif s.state == "write":
+                if not s.reg_set:
+                    s.ptr, s.reg_set = s.byte, True
+                    s.transfers.append(["W", s.ptr, bytearray()])
+                else:
+                    s.regs[s.ptr] = s.byte
+                    s.transfers[-1][2].append(s.byte)
+                    s.ptr = (s.ptr + 1) & 0xFF
+                s.acked = True
+            else:
+                s.acked = False
+            self._log(t, "%s byte %02x, %s" % (s.state, s.byte, "ACK" if s.acked else "NACK"))
+            if s.acked:
+                self._slave_drive(t, 0)
+        elif s.state in ("addr", "write", "ignore") and s.bit == 9:
+            # End of the ACK clock
+            s.bit, s.byte = 0, 0
+            if s.state == "addr":
+                s.state = ("read" if s.rw else "write") if s.acked else "ignore"
+            if s.state == "read":
+                self._send_bit(t)
+            else:
+                self._slave_drive(t, 1)
+        elif s.state == "read":
+            if s.bit < 8:
+                self._send_bit(t)
+            elif s.bit == 8:
+                self._log(t, "read byte %02x" % s.regs[s.ptr])
+                self._slave_drive(t, 1)         # Let go for our ACK
+            else:
+                s.transfers[-1][2].append(s.regs[s.ptr])
+                s.ptr = (s.ptr + 1) & 0xFF
+                s.bit = 0
+                if s.acked:
+                    self._send_bit(t)
+                else:
+                    s.state = "done"
+
+    def _send_bit(self, t):
+        s = self.slave
+        self._slave_drive(t, (s.regs[s.ptr] >> (7 - s.bit)) & 1)
+
+    # ** The MSP430 side
+
+    def _master_sda(self, out, dirr, ren):
+        if dirr & self.sda_mask:
+            return "drive1" if out & self.sda_mask else "drive0"
+        if ren & self.sda_mask:
+            return "pullup" if out & self.sda_mask else "pulldown"
+        return "float"
+
+    def _on_write(self, addr, v, size):
+        cpu = self.cpu
+        t = self.now()
+        self._advance(t)
+        out, dirr, ren = cpu.mem[P1OUT], cpu.mem[P1DIR], cpu.mem[P1REN]
+        self.edges += 1
+
+        if out & ~(self.scl_mask | self.sda_mask) != self.others:
+            self._error(t, "P1OUT other pins changed to %02x" % out)
+        if not dirr & self.scl_mask:
+            self._error(t, "SCL not driven")
+
+        master = self._master_sda(out, dirr, ren)
+        scl = 1 if out & self.scl_mask else 0
+
+        # Both can not change in one write without it being ambiguous which went first
+        if scl != self.scl and master != self.master and (master, self.master) not in (("pulldown", "drive0"), ("drive0", "pulldown"), ("pullup", "drive1"), ("drive1", "pullup")):
+            self._error(t, "SCL and SDA changed in the same write")
+
+        if master != self.master:
+            self.master = master
+            self._resolve(t)
+            self._log(t, "SDA " + master)
+
+        if scl != self.scl:
+            self.scl = scl
+            if scl:
+                self._scl_rise(t)
+                self.scl_rise = t
+                self._log(t, "SCL rise")
+            else:
+                self._scl_fall(t)
+                self.scl_fall = t
+                self._log(t, "SCL fall")
+
+    def _on_read(self, cpu):
+        start = cpu.insn_start * 1e9 / self.mclk_hz
+        t = self.now()
+        self._advance(t)
+        if not self._sda_settled(t, start):
+            self._error(t, "sampled SDA before it settled")
+        if not self.scl:
+            self._error(t, "sampled SDA with SCL low")
+        v = cpu.mem[P1OUT] & ~self.sda_mask
+        if self.level:
+            v |= self.sda_mask
+        return v
+
+    # ** Calling the asm like the C does
+
+    def call(self, name, *args):
+        cpu = self.cpu
+        saved = list(cpu.r[4:11])
+        for reg, a in zip((12, 13, 14, 15), args):
+            cpu.r[reg] = a & 0xFFFF
+        cpu.r[SP] = STACK_TOP
+        cpu.push(RETURN_ADDRESS)
+        cpu.r[SR] = 0
+        cpu.r[PC] = self.image.symbols[name]
+        start = cpu.cycles
+        cpu.run()
+        cycles = cpu.insn_start - start         # Up to the return, not counting the BIS that stopped us
+        if cpu.r[SP] != STACK_TOP:
+            raise BusError("%s left SP at %04x" % (name, cpu.r[SP]))
+        if cpu.r[4:11] != saved:
+            raise BusError("%s did not put back R4-R10" % name)
+        if self.slave.state != "idle" or not self.scl or self.master != "pullup":
+            raise BusError("%s did not leave the bus idle" % name)
+        return cycles, cpu.r[12] & 0xFF
+
+    def transfer(self, ops, slave=RV3032_ADDR):
+        """Run a batch. `ops` is a list of (reg, bytes) writes and (reg, count) reads, built into i2c_op_t's like the C does.
+        Returns (cycles, nack, [the bytes each read got])."""
+        mem = self.cpu.mem
+        buf = BUFFER_ADDRESS
+        placed = []
+        for i, (reg, x) in enumerate(ops):
+            if isinstance(x, int):
+                count, flag = x, I2C_OP_READ
+                mem[buf:buf + count] = bytes(count)
+            else:
+                count, flag = len(x), 0
+                mem[buf:buf + count] = bytes(x)
+            mem[OPS_ADDRESS + 4 * i:OPS_ADDRESS + 4 * i + 4] = bytes([reg, count | flag, buf & 0xFF, buf >> 8])
+            placed.append((buf, count, flag))
+            buf += count
+        self.starts = self.stops = 0
+        cycles, nack = self.call("i2c_transfer", slave, OPS_ADDRESS, len(ops))
+        reads = [bytes(mem[a:a + count]) for a, count, flag in placed if flag]
+        return cycles, nack, reads
+
+    def write(self, reg, data, slave=RV3032_ADDR):
+        cycles, nack, _ = self.transfer([(reg, data)], slave)
+        return cycles, nack
+
+    def read(self, reg, count, slave=RV3032_ADDR):
+        cycles, nack, reads = self.transfer([(reg, count)], slave)
+        return cycles, nack, reads[0]
+
+
+def _check(cond, msg):
+    if not cond:
+        raise BusError(msg)
+
+
+def _scenarios(bus, rows):
+    regs = bus.slave.regs
+
+    # The same transfers the firmware does. Time block is 7 registers from 0x01.
+    time_block = bytes([0x00, 0x59, 0x23, 0x07, 0x31, 0x12, 0x99])
+    cycles, nack = bus.write(0x01, time_block)
+    _check(nack == 0, "time block write got a NACK")
+    _check(regs[0x01:0x08] == time_block, "time block write put %s in the registers" % regs[0x01:0x08].hex())
+    rows.append(("write time block (7 bytes)", cycles))
+
+    cycles, nack, got = bus.read(0x01, 7)
+    _check(nack == 0, "time block read got a NACK")
+    _check(got == time_block, "time block read got %s" % got.hex())
+    rows.append(("read time block (7 bytes)", cycles))
+
+    regs[0x0D], regs[0x0E] = 0x03, 0x04
+    cycles, nack, got = bus.read(0x0D, 2)
+    _check(nack == 0 and got == bytes([0x03, 0x04]), "status read got %s" % got.hex())
+    rows.append(("read STATUS, TEMP_LSB", cycles))
+
+    cycles, nack = bus.write(0xC3, bytes([0b01100000]))
+    _check(nack == 0 and regs[0xC3] == 0b01100000, "CLKOUT2 write")
+    rows.append(("write one register", cycles))
+
+    for value in (0x00, 0xFF, 0xA5, 0x5A):
+        regs[0x20] = value
+        _, nack, got = bus.read(0x20, 1)
+        _check(nack == 0 and got[0] == value, "read of %02x got %02x" % (value, got[0]))
+        bus.write(0x21, bytes([value]))
+        _check(regs[0x21] == value, "write of %02x left %02x" % (value, regs[0x21]))
+
+    # What rv3032_recover_tsl_time() does, then what the launch does, each in one session
+    regs[0x0D] = 0x00
+    cycles, nack, (status, got) = bus.transfer([(0x0D, 1), (0x01, 7)])
+    _check(nack == 0 and status == b"\x00" and got == time_block, "status and time batch got %s %s" % (status.hex(), got.hex()))
+    _check(bus.starts == 4 and bus.stops == 1, "status and time batch had %d STARTs and %d STOPs" % (bus.starts, bus.stops))
+    rows.append(("batch: read STATUS, time", cycles))
+
+    zero_block = bytes([0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x00])
+    regs[0x0D] = 0x03
+    cycles, nack, (got,) = bus.transfer([(0x01, 7), (0x01, zero_block), (0x0D, b"\x00")])
+    _check(nack == 0 and got == time_block, "launch batch read %s" % got.hex())
+    _check(regs[0x01:0x08] == zero_block and regs[0x0D] == 0, "launch batch left %s %02x" % (regs[0x01:0x08].hex(), regs[0x0D]))
+    _check(bus.starts == 4 and bus.stops == 1, "launch batch had %d STARTs and %d STOPs" % (bus.starts, bus.stops))
+    rows.append(("batch: read time, write time, STATUS", cycles))
+    regs[0x01:0x08] = time_block
+
+    # A read of 0 bytes only sets the register pointer. The next op in the batch still runs.
+    del bus.slave.transfers[:]
+    cycles, nack, (empty, got) = bus.transfer([(0x0D, 0), (0x01, 7)])
+    _check(nack == 0 and empty == b"" and got == time_block, "zero length read batch got %s %s" % (empty.hex(), got.hex()))
+    _check([t[0] for t in bus.slave.transfers] == ["W", "W", "R"], "zero length read did %s" % " ".join("%s%d" % (t[0], len(t[2])) for t in bus.slave.transfers))
+    _check(bus.starts == 3 and bus.stops == 1, "zero length read batch had %d STARTs and %d STOPs" % (bus.starts, bus.stops))
+    rows.append(("batch: read 0 bytes, read time", cycles))
+
+    _, nack, got = bus.read(0x01, 2, slave=0x50)
+    _check(nack == 1, "nobody at 0x50, but the read did not say NACK")
+    _check(got == b"\xff\xff", "read from nobody got %s, not all 0xFF" % got.hex())
+    _, nack = bus.write(0x01, b"\x00", slave=0x50)
+    _check(nack == 1, "nobody at 0x50, but the write did not say NACK")
+    _check(regs[0x01:0x08] == time_block, "write to another address changed the RV3032")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-D", dest="defines", action="append", metavar="NAME=VALUE", help="override a #define in i2c_asm.h")
+    ap.add_argument("--trace", action="store_true", help="print every edge")
+    args = ap.parse_args()
+
+    bus = Bus(parse_defines(args.defines), trace=args.trace)
+    us = lambda cycles: cycles * 1e6 / bus.mclk_hz
+    rows = []
+
+    try:
+        _scenarios(bus, rows)
+    except BusError as e:
+        bus.errors.append(str(e))
+
+    if bus.errors:
+        print("\n".join(bus.errors))
+        print("%d errors" % len(bus.errors))
+        return 1
+
+    print("MCLK %d Hz, SCL at most %d Hz, %s timing, tRISE %d ns" % (bus.mclk_hz, bus.bus_hz,
+          "fast mode" if bus.t["LOW"] < 4700 else "standard mode", bus.t["RISE"]))
+    print()
+    print("%-38s %8s %9s" % ("transfer", "cycles", "us"))
+    print("-" * 57)
+    for name, cycles in rows:
+        print("%-38s %8d %9.1f" % (name, cycles, us(cycles)))
+    print()
+    print("Fastest SCL %.0f Hz. %d edges, all within timing." % (1e9 / bus.fastest_period, bus.edges))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,256 @@
+"""
+lcd_model.py - Host copy of the LCD layout from lcd_display.cpp
+
+These are straight ports of the glyph tables, the digitplace to LPIN map, and the fill_*() functions that build the
+precomputed tables the asm ISRs copy into LCDMEM. There is also a decoder that goes the other way (LCDMEM bytes back
+into the characters a person would see) so we can check what the ISRs actually put on the screen.
+
+If you change the tables in lcd_display.cpp, change them here too.
+"""
+
+COM0_BIT = 0b0001
+COM1_BIT = 0b0010
+COM2_BIT = 0b0100
+COM3_BIT = 0b1000
+
+# Low pins
+SEG_A = COM0_BIT
+SEG_B = COM1_BIT
+SEG_C = COM2_BIT
+SEG_D = COM3_BIT
+
+# High pins
+SEG_E = COM2_BIT
+SEG_F = COM0_BIT
+SEG_G = COM1_BIT
+SEG_S = COM3_BIT
+
+# (nibble_a_thru_d, nibble_e_thru_g)
+GLYPHS = {
+    "0": (SEG_A | SEG_B | SEG_C | SEG_D, SEG_E | SEG_F),
+    "1": (SEG_B | SEG_C, 0),
+    "2": (SEG_A | SEG_B | SEG_D, SEG_E | SEG_G),
+    "3": (SEG_A | SEG_B | SEG_C | SEG_D, SEG_G),
+    "4": (SEG_B | SEG_C, SEG_F | SEG_G),
+    "5": (SEG_A | SEG_C | SEG_D, SEG_F | SEG_G),
+    "6": (SEG_A | SEG_C | SEG_D, SEG_E | SEG_F | SEG_G),
+    "7": (SEG_A | SEG_B | SEG_C, 0),
+    "8": (SEG_A | SEG_B | SEG_C | SEG_D, SEG_E | SEG_F | SEG_G),
+    "9": (SEG_A | SEG_B | SEG_C | SEG_D, SEG_F | SEG_G),
+    "A": (SEG_A | SEG_B | SEG_C, SEG_E | SEG_F | SEG_G),
+    "b": (SEG_C | SEG_D, SEG_E | SEG_F | SEG_G),
+    "C": (SEG_A | SEG_D, SEG_E | SEG_F),
+    "c": (SEG_D, SEG_E | SEG_G),
+    "d": (SEG_B | SEG_C | SEG_D, SEG_E | SEG_G),
+    "E": (SEG_A | SEG_D, SEG_E | SEG_F | SEG_G),
+    "F": (SEG_A, SEG_E | SEG_F | SEG_G),
+    "H": (SEG_B | SEG_C, SEG_E | SEG_F | SEG_G),
+    "i": (SEG_C, 0),
+    "J": (SEG_B | SEG_C | SEG_D, SEG_E),
+    "L": (SEG_D, SEG_E | SEG_F),
+    "n": (SEG_C, SEG_E | SEG_G),
+    "o": (SEG_C | SEG_D, SEG_E | SEG_G),
+    "P": (SEG_A | SEG_B, SEG_E | SEG_F | SEG_G),
+    "r": (0, SEG_E | SEG_G),
+    "t": (SEG_D, SEG_E | SEG_F | SEG_G),
+    "u": (SEG_C | SEG_D, SEG_E),
+    "y": (SEG_B | SEG_C | SEG_D, SEG_F | SEG_G),
+    "-": (0, SEG_G),
+    "[": (SEG_A | SEG_D, SEG_E | SEG_F),
+    " ": (0, 0),
+}
+
+# The digits win when two glyphs look the same (9/g, 0/O, 1/I, 8/X, H/K)
+DECODE = {}
+for _ch, _segs in reversed(list(GLYPHS.items())):
+    DECODE[_segs] = _ch
+
+DIGIT_SEGMENTS = [GLYPHS[c] for c in "0123456789AbCdEF"]
+
+SQUIGGLE_SEGMENTS = [
+    (SEG_A, 0x00),
+    (SEG_B, 0x00),
+    (0x00, SEG_G),
+    (0x00, SEG_E),
+    (SEG_D, 0x00),
+    (SEG_C, 0x00),
+    (0x00, SEG_G),
+    (0x00, SEG_F),
+]
+
+# (lpin_e_thru_g, lpin_a_thru_d) for each digitplace. Digitplace 0 is the rightmost.
+DIGITPLACE_LPINS = [
+    (33, 32),   #  0 - sec   1
+    (35, 34),   #  1 - sec  10
+    (30, 31),   #  2 - min   1
+    (28, 29),   #  3 - min  10
+    (26, 27),   #  4 - hour  1
+    (20, 21),   #  5 - hour 10
+    (18, 19),   #  6 - day 1
+    (16, 17),   #  7
+    (14, 15),   #  8
+    (1, 13),    #  9
+    (3, 2),     # 10
+    (5, 4),     # 11 - day 100000
+]
+
+DIGITPLACE_COUNT = 12
+LCDMEM_BYTES = 32
+
+# Custom glyphs for "centesimus dies" (lcd_display.cpp). Leftmost first.
+CENTESIMUS_DIES_MESSAGE = [
+    (0x09, 0x05),
+    (0x08, 0x06),
+    (0x0f, 0x00),
+    (0x0b, 0x06),
+    (0x0f, 0x05),
+    (0x0b, 0x06),
+    (0x0f, 0x02),
+    (0x00, 0x00),
+    (0x0e, 0x04),
+    (0x0f, 0x05),
+    (0x0d, 0x03),
+    (0x06, 0x07),
+]
+
+SECS_ONES_DIGITPLACE_INDEX = 0
+SECS_TENS_DIGITPLACE_INDEX = 1
+MINS_ONES_DIGITPLACE_INDEX = 2
+MINS_TENS_DIGITPLACE_INDEX = 3
+HOURS_ONES_DIGITPLACE_INDEX = 4
+HOURS_TENS_DIGITPLACE_INDEX = 5
+DAYS_ONES_DIGITPLACE_INDEX = 6
+DAYS_TENS_DIGITPLACE_INDEX = 7
+DAYS_HUNDREDS_DIGITPLACE_INDEX = 8
+DAYS_THOUSANDS_DIGITPLACE_INDEX = 9
+DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX = 10
+DAYS_HUNDRED_THOUSANDS_DIGITPLACE_INDEX = 11
+
+RTL_LCDMEM_WORD_COUNT = 8
+USED_RTL_LCDMEM_BYTES = [0, 2, 6, 8, 10, 12, 14, 16]
+READY_TO_LAUNCH_LCD_FRAME_COUNT = 8
+
+
+def lpin_lcdmem_offset(lpin):
+    return lpin >> 1
+
+
+def lpin_upper(lpin):
+    return bool(lpin & 1)
+
+
+def set_nibble(mem, offset, upper, x):
+    if upper:
+        mem[offset] = (mem[offset] & 0x0F) | (x << 4)
+    else:
+        mem[offset] = (mem[offset] & 0xF0) | x
+
+
+def fill_lcd_words(tens_digit_index, ones_digit_index, max_tens_digit, max_ones_digit):
+    """Port of fill_lcd_words(). Note the +1 offset - [59] = "00", [0] = "01"."""
+    count = max_tens_digit * max_ones_digit
+    words = [0] * count
+    tens = DIGITPLACE_LPINS[tens_digit_index]
+    ones = DIGITPLACE_LPINS[ones_digit_index]
+    for t in range(max_tens_digit):
+        for o in range(max_ones_digit):
+            w = bytearray(2)
+            for lpins, digit in ((tens, t), (ones, o)):
+                e_g, a_d = lpins
+                set_nibble(w, lpin_lcdmem_offset(a_d) & 1, lpin_upper(a_d), DIGIT_SEGMENTS[digit][0])
+                set_nibble(w, lpin_lcdmem_offset(e_g) & 1, lpin_upper(e_g), DIGIT_SEGMENTS[digit][1])
+            words[((t * max_ones_digit) + o + count - 1) % count] = w[0] | (w[1] << 8)
+    return words
+
+
+def fill_lcd_bytes(digit_index):
+    """Port of fill_lcd_bytes(). Not offset like the words tables."""
+    e_g, a_d = DIGITPLACE_LPINS[digit_index]
+    out = []
+    for digit in range(10):
+        a_thru_d, e_thru_g = DIGIT_SEGMENTS[digit]
+        if not lpin_upper(a_d):
+            out.append(a_thru_d | (e_thru_g << 4))
+        else:
+            out.append((a_thru_d << 4) | e_thru_g)
+    return out
+
+
+def fill_lcd_split_bytes(digit_index):
+    """Port of fill_lcd_split_bytes(). Returns (e_thru_g bytes, a_thru_d bytes), each with only that pin's nibble set."""
+    e_g, a_d = DIGITPLACE_LPINS[digit_index]
+    e_g_bytes, a_d_bytes = [], []
+    for digit in range(10):
+        a_thru_d, e_thru_g = DIGIT_SEGMENTS[digit]
+        e_g_bytes.append(e_thru_g << 4 if lpin_upper(e_g) else e_thru_g)
+        a_d_bytes.append(a_thru_d << 4 if lpin_upper(a_d) else a_thru_d)
+    return e_g_bytes, a_d_bytes
+
+
+def fill_lcd_frame_words(glyphs):
+    """Port of lcd_compile_glyphs(). 12 glyphs leftmost first to the 8 used LCDMEM words."""
+    mem = bytearray(LCDMEM_BYTES)
+    show_glyphs(mem, glyphs)
+    return [mem[b] | (mem[b + 1] << 8) for b in USED_RTL_LCDMEM_BYTES]
+
+
+def fill_ready_to_launch_lcd_frames():
+    """Port of fill_ready_to_launch_lcd_frames(). Returns a list of 8 frames of 8 words."""
+    frames = []
+    for frame in range(READY_TO_LAUNCH_LCD_FRAME_COUNT):
+        mem = bytearray(LCDMEM_BYTES)
+        even = SQUIGGLE_SEGMENTS[frame]
+        odd = SQUIGGLE_SEGMENTS[(len(SQUIGGLE_SEGMENTS) - frame) % len(SQUIGGLE_SEGMENTS)]
+        for digit in range(DIGITPLACE_COUNT):
+            segs = odd if digit & 1 else even
+            e_g, a_d = DIGITPLACE_LPINS[digit]
+            set_nibble(mem, lpin_lcdmem_offset(a_d), lpin_upper(a_d), segs[0])
+            set_nibble(mem, lpin_lcdmem_offset(e_g), lpin_upper(e_g), segs[1])
+        frames.append([mem[b] | (mem[b + 1] << 8) for b in USED_RTL_LCDMEM_BYTES])
+    return frames
+
+
+def show_glyph(mem, pos, segs):
+    """Port of lcd_show_f(). `mem` is the 32 LCDMEM bytes."""
+    e_g, a_d = DIGITPLACE_LPINS[pos]
+    set_nibble(mem, lpin_lcdmem_offset(a_d), lpin_upper(a_d), segs[0] & 0x0F)
+    set_nibble(mem, lpin_lcdmem_offset(e_g), lpin_upper(e_g), segs[1] & 0x0F)
+
+
+def show_digit(mem, pos, d):
+    """Port of lcd_show_digit_f()."""
+    show_glyph(mem, pos, DIGIT_SEGMENTS[d])
+
+
+def show_glyphs(mem, glyphs):
+    """Show 12 glyphs, leftmost first like the message arrays in lcd_display.cpp"""
+    assert len(glyphs) == DIGITPLACE_COUNT
+    for i, segs in enumerate(glyphs):
+        show_glyph(mem, DIGITPLACE_COUNT - 1 - i, segs)
+
+
+def show_text(mem, text):
+    """Show a 12 character string, leftmost character first"""
+    show_glyphs(mem, [GLYPHS[ch] for ch in text])
+
+
+def read_glyph(mem, pos):
+    e_g, a_d = DIGITPLACE_LPINS[pos]
+    a_thru_d = (mem[lpin_lcdmem_offset(a_d)] >> (4 if lpin_upper(a_d) else 0)) & 0x0F
+    e_thru_g = (mem[lpin_lcdmem_offset(e_g)] >> (4 if lpin_upper(e_g) else 0)) & 0x0F
+    return a_thru_d, e_thru_g
+
+
+def read_glyphs(mem):
+    """The raw segments of all 12 digitplaces, leftmost first"""
+    return [read_glyph(mem, pos) for pos in reversed(range(DIGITPLACE_COUNT))]
+
+
+def decode(mem):
+    """Returns the 12 characters on the display, leftmost first. Unknown segment patterns show as `?`."""
+    return "".join(DECODE.get(read_glyph(mem, pos), "?") for pos in reversed(range(DIGITPLACE_COUNT)))
+
+
+def tsl_text(days, hours, mins, secs):
+    """What the display should say in time-since-launch mode."""
+    return "%06d%02d%02d%02d" % (days, hours, mins, secs)
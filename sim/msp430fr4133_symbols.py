@@ -0,0 +1,174 @@
+"""
+msp430fr4133_symbols.py - The subset of msp430fr4133.h that the TSL asm code uses.
+
+The TI assembler gets these from `.cdecls C,LIST,"msp430.h"`. We do not have the TI headers on the host,
+so the simulator assembler uses this table whenever it sees that include. Add more here as the asm starts
+using more of the device.
+
+Values come from the MSP430FR4133 datasheet (SLAS865) and the family user guide (SLAU445).
+"""
+
+SYMBOLS = {
+
+    # Status register bits
+    "C":            0x0001,
+    "Z":            0x0002,
+    "N":            0x0004,
+    "GIE":          0x0008,
+    "CPUOFF":       0x0010,
+    "OSCOFF":       0x0020,
+    "SCG0":         0x0040,
+    "SCG1":         0x0080,
+    "V":            0x0100,
+
+    "LPM0":         0x0010,
+    "LPM3":         0x00D0,
+    "LPM4":         0x00F0,
+    "LPM0_bits":    0x0010,
+    "LPM3_bits":    0x00D0,
+    "LPM4_bits":    0x00F0,
+
+    # SYS
+    "SYSCTL":       0x0140,
+    "SYSRIVECT":    0x0001,
+    "SYSCFG0":      0x0160,
+    "SYSCFG0_L":    0x0160,
+    "PFWP":         0x0001,
+    "DFWP":         0x0002,
+
+    # Clock system
+    "CSCTL4":       0x0188,
+    "SELMS__VLOCLK": 0x0001,
+
+    # Watchdog
+    "WDTCTL":       0x01CC,
+    "WDTPW":        0x5A00,
+    "WDTHOLD":      0x0080,
+
+    # CRC
+    "CRCDI":        0x01C0,
+    "CRCDI_L":      0x01C0,
+    "CRCDIRB":      0x01C2,
+    "CRCDIRB_L":    0x01C2,
+    "CRCINIRES":    0x01C4,
+    "CRCRESR":      0x01C6,
+
+    # FRAM controller
+    "FRCTL0":       0x01A0,
+    "FRCTLPW":      0xA500,
+    "GCCTL0":       0x0144,
+    "FRPWR":        0x0004,
+
+    # Port 1 / Port A
+    "PAIN":         0x0200,
+    "PAIN_L":       0x0200,
+    "P1IN":         0x0200,
+    "PAOUT":        0x0202,
+    "PAOUT_L":      0x0202,
+    "P1OUT":        0x0202,
+    "PADIR":        0x0204,
+    "PADIR_L":      0x0204,
+    "P1DIR":        0x0204,
+    "PAREN":        0x0206,
+    "PAREN_L":      0x0206,
+    "P1REN":        0x0206,
+    "P1IV":         0x020E,
+    "PAIES":        0x0218,
+    "PAIES_L":      0x0218,
+    "P1IES":        0x0218,
+    "PAIE":         0x021A,
+    "PAIE_L":       0x021A,
+    "P1IE":         0x021A,
+    "PAIFG":        0x021C,
+    "PAIFG_L":      0x021C,
+    "P1IFG":        0x021C,
+    "PAIFG_H":      0x021D,
+    "P2IFG":        0x021D,
+    "P2IE":         0x021B,
+
+    # LCD_E
+    "LCDCTL0":      0x0600,
+    "LCDCTL1":      0x0602,
+    "LCDBLKCTL":    0x0604,
+    "LCDMEMCTL":    0x0606,
+    "LCDVCTL":      0x0608,
+    "LCDCSSEL0":    0x0614,
+    "LCDIV":        0x061E,
+    "LCDM0":        0x0620,
+    "LCDM0W":       0x0620,
+    "LCDM0W_L":     0x0620,
+    "LCDBM0":       0x0640,
+    "LCDBM0W":      0x0640,
+    "LCDBM0W_L":    0x0640,
+    "LCDDISP":      0x0001,
+    "LCDCLRM":      0x0002,
+    "LCDCLRBM":     0x0004,
+    "LCDBLKMOD_0":  0x0000,
+    "LCDBLKMOD_1":  0x0001,
+    "LCDBLKMOD_2":  0x0002,
+    "LCDBLKMOD_3":  0x0003,
+    "LCDBLKPRE__4":   0x0000,
+    "LCDBLKPRE__8":   0x0004,
+    "LCDBLKPRE__16":  0x0008,
+    "LCDBLKPRE__32":  0x000C,
+    "LCDBLKPRE__64":  0x0010,
+    "LCDBLKPRE__128": 0x0014,
+    "LCDBLKPRE__256": 0x0018,
+    "LCDBLKPRE__512": 0x001C,
+}
+
+# Maps the vector section names we can `.sect` into to the FRAM address of that vector (lnk_msp430fr4133.cmd)
+# msp430fr4133.h defines eg `PORT1_VECTOR` as ".int47" for the assembler.
+
+VECTOR_SECTIONS = {
+    "LCD_E_VECTOR":     0xFFE2,
+    "PORT2_VECTOR":     0xFFE4,
+    "PORT1_VECTOR":     0xFFE6,
+    "ADC_VECTOR":       0xFFE8,
+    "USCI_B0_VECTOR":   0xFFEA,
+    "USCI_A0_VECTOR":   0xFFEC,
+    "WDT_VECTOR":       0xFFEE,
+    "RTC_VECTOR":       0xFFF0,
+    "TIMER1_A1_VECTOR": 0xFFF2,
+    "TIMER1_A0_VECTOR": 0xFFF4,
+    "TIMER0_A1_VECTOR": 0xFFF6,
+    "TIMER0_A0_VECTOR": 0xFFF8,
+    "UNMI_VECTOR":      0xFFFA,
+    "SYSNMI_VECTOR":    0xFFFC,
+    "RESET_VECTOR":     0xFFFE,
+}
+
+for _n in range(0, 64):
+    VECTOR_SECTIONS[".int%02d" % _n] = 0xFF88 + 2 * _n
+
+# The RAM vector table (SYSRIVECT=1) mirrors the FRAM table at the top of RAM (SLAU445I 1.15.1)
+RAM_VECTOR_OFFSET = 0xFFE6 - 0x27E6
+
+RAM_VECTORS = {
+    "ram_vector_LCD_E":     0x27E2,
+    "ram_vector_PORT2":     0x27E4,
+    "ram_vector_PORT1":     0x27E6,
+    "ram_vector_ADC":       0x27E8,
+    "ram_vector_USCI_B0":   0x27EA,
+    "ram_vector_USCI_A0":   0x27EC,
+    "ram_vector_WDT":       0x27EE,
+    "ram_vector_RTC":       0x27F0,
+    "ram_vector_TIMER1_A1": 0x27F2,
+    "ram_vector_TIMER1_A0": 0x27F4,
+    "ram_vector_TIMER0_A1": 0x27F6,
+    "ram_vector_TIMER0_A0": 0x27F8,
+    "ram_vector_UNMI":      0x27FA,
+    "ram_vector_SYSNMI":    0x27FC,
+}
+
+# Memory map (lnk_msp430fr4133.cmd)
+RAM_START   = 0x2000
+RAM_END     = 0x27E0        # First byte of the RAM vector table
+INFO_START  = 0x1800
+INFO_END    = 0x1A00
+FRAM_START  = 0xC400
+FRAM_END    = 0x10000
+LCDMEM_START = 0x0620
+LCDMEM_END   = 0x0640
+LCDBMEM_START = 0x0640
+LCDBMEM_END   = 0x0660
@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+"""
+powerfail.py - Cut the power after every single FRAM store and check that we always come back at the right time
+
+The persistent time since launch is only as good as what main() can make of the info FRAM after the batteries die at
+the worst possible moment. This runs the real minute and day rollovers in `tsl_asm.asm` on the simulated MSP430 and
+records every store they make to the info FRAM. Then for each store, it takes the FRAM as it would be if the power
+went out right after it, and "boots" it with a Python copy of the recovery in main() (the C is not simulated, just like
+in tsl_sim.py). The time that comes back must never be ahead of the real time, and never more than one minute behind it.
+The recovery itself commits to FRAM (the normalization at midnight, the migration from the legacy fields), so we also
+cut the power after each of *those* stores and boot again.
+
+It does this for the tick at the end of every minute of the day, on a handful of days chosen to hit the interesting
+edges (first day, the days long carrying into its high word, the seq wrapping around, both slots), and also for the
+stores that firmware from before the counter slots made to the legacy fields, to check the migration.
+
+    python3 powerfail.py                          # Everything, spread over all cores
+    python3 powerfail.py -j 1 --days 0            # Just day 0, one process
+    python3 powerfail.py -D TSL_RTC_RECOVERY=1    # With a build option
+
+With TSL_RTC_RECOVERY the persistent mins is only an hourly checkpoint (the RTC has the rest), so then it may be up to an
+hour behind.
+"""
+
+import argparse
+import multiprocessing
+import os
+import sys
+import time
+
+from tsl_bench import parse_defines
+from tsl_sim import TslFirmware, INFO_START, PERSISTENT_OFFSETS, PERSISTENT_SIZES, PERSISTENT_SIZE, MINS_PER_DAY, slot_crc
+from msp430fr4133_symbols import INFO_END
+
+DEFAULT_DAYS = (0, 1, 127, 65535, 123456, 999997)
+SEQS = (0x0000, 0xFFFF)         # Where the seq of the slot we start in begins. 0xFFFF wraps at midnight.
+LEGACY_FILLS = (0x00, 0xFF)     # What the bytes past the legacy fields held before the counter slots were ever written
+RECOVERY_CUT_DEPTH = 2          # How many times in a row the power can go out during recovery
+
+
+class PowerCut(Exception):
+    pass
+
+
+class Fram:
+    """The info FRAM as main() sees it after a power cut. `cut_after` stores in, the power goes out."""
+
+    def __init__(self, mem, cut_after=None):
+        self.mem = bytearray(mem)
+        self.cut_after = cut_after
+        self.stores = []
+
+    def read(self, name):
+        off = PERSISTENT_OFFSETS[name]
+        return int.from_bytes(self.mem[off:off + PERSISTENT_SIZES[name]], "little")
+
+    def store16(self, off, v):
+        """A word store, which the FRAM does all or nothing."""
+        if self.cut_after is not None and len(self.stores) == self.cut_after:
+            raise PowerCut()
+        self.mem[off:off + 2] = (v & 0xFFFF).to_bytes(2, "little")
+        self.stores.append((off, v & 0xFFFF))
+
+    def write(self, name, v):
+        """`persistent_data.name = v`. A long is two word stores, low word first."""
+        off = PERSISTENT_OFFSETS[name]
+        for i in range(0, PERSISTENT_SIZES[name], 2):
+            self.store16(off + i, v >> (8 * i))
+
+
+# ** Python copies of the recovery in tsl-calibre-msp.cpp
+
+def newest_slot(fram):
+    """persistent_newest_slot(). Returns the slot number or None."""
+    newest = None
+    for i in range(2):
+        days, seq = fram.read("counter_slots[%d].days" % i), fram.read("counter_slots[%d].seq" % i)
+        if fram.read("counter_slots[%d].crc" % i) == slot_crc(days, seq):
+            if newest is None or 0 < (seq - fram.read("counter_slots[%d].seq" % newest)) & 0xFFFF < 0x8000:
+                newest = i
+    return newest
+
+
+def commit_persistent_time(fram, days, mins):
+    newest = newest_slot(fram)
+    slot, seq = 0, 0
+    if newest is not None:
+        slot, seq = 1 - newest, (fram.read("counter_slots[%d].seq" % newest) + 1) & 0xFFFF
+    crc = slot_crc(days, seq)
+    fram.write("counter_slots[%d].mins" % slot, mins)
+    fram.write("counter_slots[%d].days" % slot, days)
+    fram.write("counter_slots[%d].crc" % slot, crc)
+    fram.write("counter_slots[%d].seq" % slot, seq)
+
+
+def recover(fram, rtc_recovery):
+    """What main() does with the persistent data after a battery change. Returns (days, mins)."""
+    newest = newest_slot(fram)
+    if newest is not None:
+        mins, days = fram.read("counter_slots[%d].mins" % newest), fram.read("counter_slots[%d].days" % newest)
+    else:
+        if fram.read("legacy_update_flag"):
+            mins, days = fram.read("legacy_backup_mins"), fram.read("legacy_backup_days")
+        else:
+            mins, days = fram.read("legacy_mins"), fram.read("legacy_days")
+        commit_persistent_time(fram, days, mins)
+    if mins == MINS_PER_DAY:
+        days, mins = days + 1, 0
+        commit_persistent_time(fram, days, mins)
+    if rtc_recovery:
+        # Without the RTC (PORF or VLF) the checkpoint is all we have. The commit there only ever moves it to the top of the hour.
+        checkpoint = mins - mins % 60
+        newest = newest_slot(fram)
+        if fram.read("counter_slots[%d].days" % newest) != days or fram.read("counter_slots[%d].mins" % newest) != checkpoint:
+            commit_persistent_time(fram, days, checkpoint)
+    return days, mins
+
+
+# ** Checking
+
+class Checker:
+
+    def __init__(self, rtc_recovery):
+        self.rtc_recovery = rtc_recovery
+        self.max_behind = 60 if rtc_recovery else 1
+        self.cuts = 0
+        self.worst = 0
+
+    def boot(self, mem, true_mins, what, depth=0):
+        """Boot from `mem`, and then again after a power cut at each store the recovery makes. Returns the recovered time."""
+        fram = Fram(mem)
+        days, mins = recover(fram, self.rtc_recovery)
+        got = days * MINS_PER_DAY + mins
+        behind = true_mins - got
+        if not 0 <= behind <= self.max_behind:
+            raise AssertionError("%s: recovered day %d %02d:%02d, which is %d minutes %s" % (
+                what, days, mins // 60, mins % 60, abs(behind), "behind" if behind > 0 else "ahead"))
+        self.worst = max(self.worst, behind)
+        if depth < RECOVERY_CUT_DEPTH:
+            for cut in range(len(fram.stores)):
+                self.cuts += 1
+                again = Fram(mem, cut)
+                try:
+                    recover(again, self.rtc_recovery)
+                except PowerCut:
+                    pass
+                self.boot(again.mem, true_mins, "%s, then a cut after recovery store %d" % (what, cut), depth + 1)
+        return got
+
+    def stores(self, before, stores, true_mins, what):
+        """Cut after each of `stores` (offset, word) applied to `before`, including before the first one."""
+        mem = bytearray(before)
+        for i in range(len(stores) + 1):
+            if i:
+                off, v = stores[i - 1]
+                mem[off:off + 2] = v.to_bytes(2, "little")
+            self.cuts += 1
+            self.boot(mem, true_mins, "%s, cut after store %d of %d" % (what, i, len(stores)))
+        return mem
+
+
+# ** Scenarios
+
+_fw = None
+
+
+def _firmware(defines):
+    global _fw
+    if _fw is None:
+        _fw = TslFirmware(defines)
+        _fw.fram_stores = []
+        _fw.cpu.watch(INFO_START, INFO_END, lambda a, v, size: _fw.fram_stores.append((a - INFO_START, v, size)))
+    return _fw
+
+
+def _slot_fields(slot, mins, days, seq):
+    """A committed counter slot, as set_persistent() fields."""
+    return {"counter_slots[%d].mins" % slot: mins, "counter_slots[%d].days" % slot: days,
+            "counter_slots[%d].crc" % slot: slot_crc(days, seq), "counter_slots[%d].seq" % slot: seq}
+
+
+def _start(fw, day, mins, slot, seq):
+    """TSL mode at `mins`:59 on `day`, counting in `slot`, with the other slot holding yesterday like the ISR leaves it."""
+    fw.start_tsl(day, mins // 60, mins % 60, 58)
+    checkpoint = fw.newest_slot()["mins"]
+    other = 1 - slot
+    fields = _slot_fields(slot, checkpoint, day, seq)
+    fields.update(_slot_fields(other, MINS_PER_DAY, day - 1, (seq - 1) & 0xFFFF) if day else
+                  dict.fromkeys(_slot_fields(other, 0, 0, 0), 0))
+    fw.set_persistent(fields)
+    fw.poke16(fw.sym("tsl_counter_slot"), slot)
+    fw.tick()
+
+
+def run_slots(job):
+    """The counter slot firmware. The tick at the end of each minute in `minutes` on `day`."""
+    defines, day, slot, seq, minutes = job
+    fw = _firmware(defines)
+    checker = Checker(fw.image.value("TSL_RTC_RECOVERY"))
+    for m in minutes:
+        _start(fw, day, m, slot, seq)
+        before = bytes(fw.cpu.mem[INFO_START:INFO_START + PERSISTENT_SIZE])
+        fw.fram_stores.clear()
+        fw.tick()
+        if any(size != 2 for _, _, size in fw.fram_stores):
+            raise AssertionError("byte store to the info FRAM at %02d:%02d" % (m // 60, m % 60))
+        stores = [(off, v) for off, v, _ in fw.fram_stores]
+        true_mins = day * MINS_PER_DAY + m + 1          # The tick that got cut is the one that made it m+1 minutes
+        checker.stores(before, stores, true_mins, "day %d slot %d seq %04x, tick into %02d:%02d" % (day, slot, seq, (m + 1) // 60 % 24, (m + 1) % 60))
+    return checker.cuts, checker.worst
+
+
+def run_legacy(job):
+    """Firmware from before the counter slots (the ISR INC of `mins` and then `tsl_new_day()`), then a battery change
+    into this firmware. The tick at the end of each minute in `minutes` on `day`."""
+    defines, day, fill, minutes = job
+    checker = Checker(_firmware(defines).image.value("TSL_RTC_RECOVERY"))
+    for m in minutes:
+        fram = Fram(bytes([fill]) * PERSISTENT_SIZE)
+        fram.write("launched_flag", 1)
+        fram.write("legacy_mins", m)
+        fram.write("legacy_days", day)
+        fram.write("legacy_update_flag", 0)
+        fram.write("legacy_backup_mins", MINS_PER_DAY if day else 0)
+        fram.write("legacy_backup_days", max(day - 1, 0))
+        before = bytes(fram.mem)
+
+        fram.stores = []
+        fram.write("legacy_mins", m + 1)
+        if m + 1 == MINS_PER_DAY:
+            fram.write("legacy_backup_mins", fram.read("legacy_mins"))
+            fram.write("legacy_backup_days", day)
+            fram.write("legacy_update_flag", 1)
+            fram.write("legacy_mins", 0)
+            fram.write("legacy_days", day + 1)
+            fram.write("legacy_update_flag", 0)
+        stores = fram.stores
+        true_mins = day * MINS_PER_DAY + m + 1
+        checker.stores(before, stores, true_mins, "legacy day %d fill %02x, tick into %02d:%02d" % (day, fill, (m + 1) // 60 % 24, (m + 1) % 60))
+    return checker.cuts, checker.worst
+
+
+def _chunks(minutes, n):
+    return [minutes[i:i + n] for i in range(0, len(minutes), n)]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-D", dest="defines", action="append", metavar="NAME=VALUE", help="override a header #define")
+    ap.add_argument("--days", type=int, nargs="+", default=DEFAULT_DAYS, help="days to run every minute of (default %s)" % " ".join(map(str, DEFAULT_DAYS)))
+    ap.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="processes to spread it over (default all cores)")
+    args = ap.parse_args()
+
+    defines = parse_defines(args.defines)
+    minutes = list(range(MINS_PER_DAY))
+    jobs = [(run_slots, (defines, day, slot, seq, chunk)) for day in args.days for slot in range(2) for seq in SEQS for chunk in _chunks(minutes, 120)]
+    jobs += [(run_legacy, (defines, day, fill, chunk)) for day in args.days for fill in LEGACY_FILLS for chunk in _chunks(minutes, 360)]
+
+    start = time.time()
+    cuts = worst = 0
+    with multiprocessing.Pool(args.jobs) as pool:
+        results = [pool.apply_async(fn, (job,)) for fn, job in jobs]
+        for r in results:
+            try:
+                c, w = r.get()
+            except AssertionError as e:
+                print("FAILED: %s" % e, file=sys.stderr)
+                sys.exit(1)
+            cuts, worst = cuts + c, max(worst, w)
+
+    print("Days:                    %s" % " ".join(map(str, args.days)))
+    print("Power cuts:              %d" % cuts)
+    print("Worst:                   %d minute%s behind" % (worst, "" if worst == 1 else "s"))
+    print("All checks passed in %.0f seconds." % (time.time() - start))
+
+
+if __name__ == "__main__":
+    main()
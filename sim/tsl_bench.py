@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+tsl_bench.py - Cycle counts for each kind of tick in tsl_asm.asm
+
+Assembles `CCS Project/tsl_asm.asm`, runs it on the simulated MSP430, and prints how many cycles each kind of CLKOUT
+interrupt costs. Every run also checks that the display shows what it should after each tick.
+
+    python3 tsl_bench.py                        # Print the table
+    python3 tsl_bench.py --json > base.json     # Save the numbers...
+    python3 tsl_bench.py --compare base.json    # ...and compare against them after a change
+    python3 tsl_bench.py -D TSL_SOME_FLAG=1     # Override a #define from the headers the asm includes
+
+Cycles include the 6 cycle interrupt entry. They do not include the time to wake up from LPM4 (DCO startup),
+which is the same for every tick and which the sim can not see anyway.
+"""
+
+import argparse
+import json
+import sys
+
+import lcd_model
+from tsl_sim import TslFirmware, LCDMEM
+from cpu430 import INTERRUPT_CYCLES
+
+DEFAULT_MCLK_HZ = 1000000
+
+
+def _check_display(fw, days, hours, mins, secs):
+    expected = lcd_model.tsl_text(days, hours, mins, secs)
+    actual = fw.display()
+    if actual != expected:
+        raise AssertionError("display shows `%s`, expected `%s`" % (actual, expected))
+
+
+def _tsl_event(defines, start, expected_after):
+    """Start TSL mode at `start` (days, h, m, s), let the first tick (TSL_MODE_BEGIN) run,
+    then measure the second tick. Returns (begin cycles, tick cycles, C cycles). C cycles is None if the tick
+    called into C but the stand-in did not give an estimate."""
+    fw = TslFirmware(defines)
+    fw.start_tsl(*start)
+    days, h, m, s = start
+    begin = fw.tick()
+    # The first tick shows the next second
+    s += 1
+    if s == 60:
+        s, m = 0, m + 1
+    _check_display(fw, days, h, m, s)
+    c_before = fw.cpu.hook_cycles
+    calls_before = fw.cpu.hook_calls
+    cycles = fw.tick()
+    _check_display(fw, *expected_after)
+    c_cycles = fw.cpu.hook_cycles - c_before
+    if fw.cpu.hook_calls != calls_before and not c_cycles:
+        c_cycles = None
+    return begin, cycles, c_cycles
+
+
+def _rtl_event(defines):
+    fw = TslFirmware(defines)
+    frames = lcd_model.fill_ready_to_launch_lcd_frames()
+    fw.start_rtl()
+    begin = fw.tick()
+    cycles = fw.tick()
+    mem = fw.lcdmem()
+    words = [mem[b] | (mem[b + 1] << 8) for b in lcd_model.USED_RTL_LCDMEM_BYTES]
+    if words != frames[1]:
+        raise AssertionError("RTL frame 1 is not on the display")
+    return begin, cycles
+
+
+def run(defines=None):
+    """Returns an ordered dict of event name -> {"cycles", "c_cycles", "description"}"""
+    events = {}
+
+    def add(name, description, cycles, c_cycles=0):
+        events[name] = {"description": description, "cycles": cycles, "c_cycles": c_cycles}
+
+    begin, second, _ = _tsl_event(defines, (0, 0, 0, 10), (0, 0, 0, 12))
+    add("tsl_begin", "TSL_MODE_BEGIN (first tick)", begin)
+    add("tsl_second", "TSL plain second", second)
+
+    _, cycles, _ = _tsl_event(defines, (0, 0, 0, 58), (0, 0, 1, 0))
+    add("tsl_minute", "TSL minute rollover", cycles)
+
+    _, cycles, _ = _tsl_event(defines, (0, 0, 59, 58), (0, 1, 0, 0))
+    add("tsl_hour", "TSL hour rollover (to 01-09)", cycles)
+
+    _, cycles, _ = _tsl_event(defines, (0, 9, 59, 58), (0, 10, 0, 0))
+    add("tsl_hour_10", "TSL hour rollover (to 10-19)", cycles)
+
+    _, cycles, _ = _tsl_event(defines, (0, 19, 59, 58), (0, 20, 0, 0))
+    add("tsl_hour_20", "TSL hour rollover (to 20-23)", cycles)
+
+    _, cycles, c_cycles = _tsl_event(defines, (0, 23, 59, 58), (1, 0, 0, 0))
+    add("tsl_day", "TSL day rollover", cycles, c_cycles)
+
+    _, cycles, c_cycles = _tsl_event(defines, (99999, 23, 59, 58), (100000, 0, 0, 0))
+    add("tsl_day_carry", "TSL day rollover (99999 -> 100000)", cycles, c_cycles)
+
+    begin, frame = _rtl_event(defines)
+    add("rtl_begin", "RTL_MODE_BEGIN (first tick)", begin)
+    add("rtl_frame", "RTL frame", frame)
+
+    return events
+
+
+def print_table(events, mclk_hz, baseline=None, out=sys.stdout):
+    us_per_cycle = 1e6 / mclk_hz
+    header = "%-36s %8s %8s %10s" % ("event", "cycles", "us", "C cycles")
+    if baseline:
+        header += " %8s" % "delta"
+    print(header, file=out)
+    print("-" * len(header), file=out)
+    for name, e in events.items():
+        c = e["c_cycles"]
+        line = "%-36s %8d %8.1f %10s" % (e["description"], e["cycles"], e["cycles"] * us_per_cycle,
+                                        "not sim" if c is None else c if c else "-")
+        if baseline:
+            if name in baseline:
+                line += " %+8d" % (e["cycles"] - baseline[name]["cycles"])
+            else:
+                line += " %8s" % "new"
+        print(line, file=out)
+    print("", file=out)
+    print("Cycles include the %d cycle interrupt entry and the RETI (or going back to sleep). `C cycles` is time spent in C functions called" % INTERRUPT_CYCLES, file=out)
+    print("from the asm, which the sim stands in for (`not sim` means it was called but not counted). MCLK=%d Hz." % mclk_hz, file=out)
+
+
+def parse_defines(items):
+    defines = {}
+    for d in items or []:
+        name, _, value = d.partition("=")
+        defines[name] = value if value else "1"
+    return defines
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-D", dest="defines", action="append", metavar="NAME=VALUE", help="override a header #define")
+    ap.add_argument("--mclk", type=int, default=DEFAULT_MCLK_HZ, help="MCLK in Hz for the us column (default 1MHz)")
+    ap.add_argument("--json", action="store_true", help="print the results as JSON")
+    ap.add_argument("--compare", metavar="FILE", help="JSON from a previous --json run to compare against")
+    args = ap.parse_args()
+
+    defines = parse_defines(args.defines)
+    events = run(defines)
+
+    if args.json:
+        json.dump({"mclk_hz": args.mclk, "defines": defines, "events": events}, sys.stdout, indent=2)
+        print()
+        return
+
+    baseline = None
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)["events"]
+    print_table(events, args.mclk, baseline)
+
+
+if __name__ == "__main__":
+    main()
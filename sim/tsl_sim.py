@@ -0,0 +1,296 @@
+"""
+tsl_sim.py - Runs tsl_asm.asm on the simulated MSP430 with a stand-in for the C side
+
+The C code is not simulated. Instead we put the C globals that the asm uses at fixed addresses, fill the tables with
+the host copy of the lcd_display.cpp code (lcd_model.py), and replace `long_now_mode()` (the only C the asm calls)
+with a Python version. Time spent in C shows up separately in `cpu.hook_cycles` (which is zero unless a hook reports
+an estimate).
+
+Typical use...
+
+    fw = TslFirmware()
+    fw.start_tsl(days=0, hours=0, mins=0, secs=0)
+    cycles = fw.tick()          # One CLKOUT interrupt
+    print(fw.display())         # "000000000001"
+"""
+
+import os
+import sys
+
+import lcd_model
+from asm430 import assemble
+from cpu430 import Cpu, PC, SP, SR, FLAG_GIE, crc_di
+from msp430fr4133_symbols import SYMBOLS, VECTOR_SECTIONS, RAM_VECTORS, RAM_END, INFO_START
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PROJECT_DIR = os.path.join(REPO, "CCS Project")
+ASM_PATH = os.path.join(PROJECT_DIR, "tsl_asm.asm")
+
+LCDMEM = SYMBOLS["LCDM0W_L"]
+LCDBMEM = SYMBOLS["LCDBM0W_L"]
+LCDMEMCTL = SYMBOLS["LCDMEMCTL"]
+LCDBLKCTL = SYMBOLS["LCDBLKCTL"]
+LCDDISP = SYMBOLS["LCDDISP"]
+P1IFG = SYMBOLS["P1IFG"]
+P1IE = SYMBOLS["P1IE"]
+CSCTL4 = SYMBOLS["CSCTL4"]
+SYSCTL = SYMBOLS["SYSCTL"]
+SYSRIVECT = SYMBOLS["SYSRIVECT"]
+PORT1_VECTOR = VECTOR_SECTIONS["PORT1_VECTOR"]
+
+RV3032_CLKOUT_B = 1
+LPM4 = SYMBOLS["LPM4"]
+
+# Where we put the C globals. The real addresses come from the linker and do not matter, except that the RTL
+# frame table must be 128 byte aligned (#pragma DATA_ALIGN in lcd_display.cpp).
+C_GLOBALS = {
+    "ready_to_launch_lcd_frame_words":  0x2000,     # 128 bytes
+    "secs_lcd_words":                   0x2080,     # 60 words
+    "mins_lcd_words":                   0x20F8,     # 60 words
+    "hours_lcd_bytes":                  0x2170,     # 10 bytes
+    "tsl_secs":                         0x217A,
+    "tsl_mins":                         0x217C,
+    "tsl_hours":                        0x217E,
+    "tsl_counter_slot":                 0x2180,
+    "tsl_days_ones_tens":               0x2182,
+    "tsl_days_hundreds_bcd":            0x2184,
+    "days_lcd_words":                   0x2186,     # 100 words
+    "days_high_lcd_bytes":              0x224E,     # 10 bytes
+    "days_thousands_e_thru_g_lcd_bytes": 0x2258,    # 10 bytes
+    "days_thousands_a_thru_d_lcd_bytes": 0x2262,    # 10 bytes
+    "persistent_data":                  INFO_START,
+}
+
+# C functions the asm calls. These get Python hooks instead of code.
+C_FUNCTIONS = {
+    "long_now_mode":                    0xF000,
+}
+
+# Where main() would be sleeping when the ISRs return
+MAIN_SLEEP_ADDRESS = 0xF100
+
+# Initial stack pointer, like the C startup code
+STACK_TOP = RAM_END
+
+# --stack_size from the project linker settings. Anything deeper than this is running over the globals.
+STACK_SIZE = 320
+
+# persistent_data_t comes from the same generated decoder that the tools in /programming use, so it can not drift from persistent.h
+sys.path.insert(0, os.path.join(REPO, "programming"))
+import persistent_layout                                # noqa: E402
+
+PERSISTENT_SIZE = persistent_layout.SIZE
+PERSISTENT_OFFSETS = {name: off for name, (off, _) in persistent_layout.FIELDS.items()}
+PERSISTENT_SIZES = {name: size for name, (_, size) in persistent_layout.FIELDS.items()}
+SLOT_SIZE = persistent_layout.PERSISTENT_COUNTER_SLOT_SIZE
+SLOT_FIELDS = tuple(name for name, _ in persistent_layout.PersistentCounterSlot._fields_)
+SLOT_ADDRESSES = tuple(INFO_START + PERSISTENT_OFFSETS["counter_slots[%d].mins" % i] for i in range(2))
+PERSISTENT_SLOT_CRC_SEED = persistent_layout.PERSISTENT_SLOT_CRC_SEED
+
+
+def slot_crc(days, seq):
+    """persistent_slot_crc() in tsl-calibre-msp.cpp"""
+    crc = PERSISTENT_SLOT_CRC_SEED
+    for w in (days & 0xFFFF, days >> 16, seq):
+        crc = crc_di(crc, w)
+    return crc
+
+
+# Registers that only change at midnight - the days_lcd_words pointer and the pointer to the counter slot the ISR is counting in.
+DAY_REGISTERS = (11, 15)
+
+MINS_PER_DAY = 24 * 60
+LONG_NOW_DAYS = 1000000
+
+
+class LongNow(Exception):
+    """The asm called long_now_mode(), which never returns."""
+    pass
+
+
+class TslFirmware:
+
+    def __init__(self, defines=None, asm_path=ASM_PATH):
+        self.cpu = Cpu()
+        self.symbols = dict(C_GLOBALS)
+        self.symbols.update(C_FUNCTIONS)
+        self.symbols.update(RAM_VECTORS)
+
+        self.image = assemble(asm_path, externs=self.symbols, defines=defines, include_dirs=[PROJECT_DIR])
+        self.image.load_into(self.cpu.mem)
+        self.symbols.update(self.image.symbols)
+
+        self.events = []            # (kind, days, glyphs) for things we might want to check, like centesimus
+        self.stack_low = STACK_TOP  # Deepest SP seen at the end of a tick
+        self.lcddisp = 0            # LCDDISP as the LCD sees it, since writes to it do not stick while blinking
+
+        self.cpu.hook(C_FUNCTIONS["long_now_mode"], self._long_now_mode)
+        self.cpu.watch(LCDMEMCTL, LCDMEMCTL + 2, self._on_lcdmemctl)
+        self._init_tables()
+
+    # ** Memory helpers
+
+    def sym(self, name):
+        return self.symbols[name]
+
+    def poke16(self, addr, v):
+        self.cpu.mem[addr] = v & 0xFF
+        self.cpu.mem[addr + 1] = (v >> 8) & 0xFF
+
+    def peek16(self, addr):
+        return self.cpu.mem[addr] | (self.cpu.mem[addr + 1] << 8)
+
+    def lcdmem(self):
+        return self.cpu.mem[LCDMEM:LCDMEM + lcd_model.LCDMEM_BYTES]
+
+    def lcdbmem(self):
+        return self.cpu.mem[LCDBMEM:LCDBMEM + lcd_model.LCDMEM_BYTES]
+
+    def display(self):
+        return lcd_model.decode(self.lcdmem())
+
+    def persistent(self):
+        """A copy of persistent_data as a persistent_layout.PersistentData"""
+        return persistent_layout.PersistentData.from_buffer_copy(bytes(self.cpu.mem[INFO_START:INFO_START + PERSISTENT_SIZE]))
+
+    def set_persistent(self, fields):
+        """Write `fields`, a dict keyed by persistent_layout.FIELDS names like "counter_slots[1].days"."""
+        for name, v in fields.items():
+            addr = INFO_START + PERSISTENT_OFFSETS[name]
+            size = PERSISTENT_SIZES[name]
+            self.cpu.mem[addr:addr + size] = v.to_bytes(size, "little")
+
+    def counter_slots(self):
+        """Both counter slots as dicts, with a `valid` for whether the crc matches."""
+        p = self.persistent()
+        slots = []
+        for i in range(2):
+            slot = {name: getattr(p.counter_slots[i], name) for name in SLOT_FIELDS}
+            slot["valid"] = slot["crc"] == slot_crc(slot["days"], slot["seq"])
+            slot["address"] = SLOT_ADDRESSES[i]
+            slots.append(slot)
+        return slots
+
+    def newest_slot(self):
+        """persistent_newest_slot() in tsl-calibre-msp.cpp"""
+        newest = None
+        for slot in self.counter_slots():
+            if slot["valid"] and (newest is None or 0 < (slot["seq"] - newest["seq"]) & 0xFFFF < 0x8000):
+                newest = slot
+        return newest
+
+    # ** The C side
+
+    def _init_tables(self):
+        """initLCDPrecomputedWordArrays()"""
+        mem = self.cpu.mem
+        for name, words in (("secs_lcd_words", lcd_model.fill_lcd_words(1, 0, 6, 10)),
+                            ("mins_lcd_words", lcd_model.fill_lcd_words(3, 2, 6, 10))):
+            base = self.sym(name)
+            for i, w in enumerate(words):
+                self.poke16(base + 2 * i, w)
+        base = self.sym("hours_lcd_bytes")
+        for i, b in enumerate(lcd_model.fill_lcd_bytes(lcd_model.HOURS_ONES_DIGITPLACE_INDEX)):
+            mem[base + i] = b
+        base = self.sym("days_lcd_words")
+        for i, w in enumerate(lcd_model.fill_lcd_words(lcd_model.DAYS_TENS_DIGITPLACE_INDEX, lcd_model.DAYS_ONES_DIGITPLACE_INDEX, 10, 10)):
+            self.poke16(base + 2 * i, w)
+        e_g, a_d = lcd_model.fill_lcd_split_bytes(lcd_model.DAYS_THOUSANDS_DIGITPLACE_INDEX)
+        for name, table in (("days_thousands_e_thru_g_lcd_bytes", e_g), ("days_thousands_a_thru_d_lcd_bytes", a_d),
+                            ("days_high_lcd_bytes", lcd_model.fill_lcd_bytes(lcd_model.DAYS_TEN_THOUSANDS_DIGITPLACE_INDEX))):
+            base = self.sym(name)
+            for i, b in enumerate(table):
+                mem[base + i] = b
+        # lcd_overlay_load_centesimus_dies() from initLCD()
+        for b, w in zip(lcd_model.USED_RTL_LCDMEM_BYTES, lcd_model.fill_lcd_frame_words(lcd_model.CENTESIMUS_DIES_MESSAGE)):
+            self.poke16(LCDBMEM + b, w)
+        base = self.sym("ready_to_launch_lcd_frame_words")
+        for f, frame in enumerate(lcd_model.fill_ready_to_launch_lcd_frames()):
+            for i, w in enumerate(frame):
+                self.poke16(base + (f * 8 + i) * 2, w)
+
+    def _show_digit(self, pos, d):
+        mem = self.lcdmem()
+        lcd_model.show_digit(mem, pos, d)
+        self.cpu.mem[LCDMEM:LCDMEM + lcd_model.LCDMEM_BYTES] = mem
+
+    def _on_lcdmemctl(self, a, v, size):
+        """The asm flips the display over to LCDBMEM to show the centesimus dies message, so grab that bank then.
+        Like the real LCD_E, LCDDISP ignores writes unless blinking is off (LCDBLKMOD=00)."""
+        if self.peek16(LCDBLKCTL) & SYMBOLS["LCDBLKMOD_3"]:
+            self.poke16(LCDMEMCTL, (self.peek16(LCDMEMCTL) & ~LCDDISP) | self.lcddisp)
+            return
+        self.lcddisp = self.peek16(LCDMEMCTL) & LCDDISP
+        if v & LCDDISP:
+            self.events.append(("centesimus", self.newest_slot()["days"], lcd_model.read_glyphs(self.lcdbmem())))
+
+    def _long_now_mode(self, cpu):
+        """Python version of long_now_mode() in tsl-calibre-msp.cpp - all 9's forever"""
+        for pos in range(lcd_model.DIGITPLACE_COUNT):
+            self._show_digit(pos, 9)
+        days = self.newest_slot()["days"]
+        self.events.append(("long_now", days, self.display()))
+        raise LongNow(days)
+
+    # ** Modes
+
+    def _sleep_in_main(self):
+        cpu = self.cpu
+        cpu.r[SP] = STACK_TOP
+        cpu.r[PC] = MAIN_SLEEP_ADDRESS
+        cpu.r[SR] = FLAG_GIE | LPM4
+        cpu.mem[P1IE] |= 1 << RV3032_CLKOUT_B
+
+    def start_tsl(self, days=0, hours=0, mins=0, secs=0):
+        """What main() does to get into time-since-launch mode."""
+        # With TSL_RTC_RECOVERY main() commits the top of the hour as the checkpoint
+        checkpoint_mins = hours * 60 + (0 if self.image.value("TSL_RTC_RECOVERY") else mins)
+        # Like a commit_persistent_time() right after launch, so the time is in slot 0 and slot 1 has never been written
+        self.set_persistent({"counter_slots[0].mins": checkpoint_mins, "counter_slots[0].days": days,
+                             "counter_slots[0].crc": slot_crc(days, 0), "counter_slots[0].seq": 0,
+                             "counter_slots[1].mins": 0, "counter_slots[1].days": 0, "counter_slots[1].crc": 0,
+                             "counter_slots[1].seq": 0, "launched_flag": 1})
+        self.poke16(self.sym("tsl_counter_slot"), 0)
+        self.poke16(self.sym("tsl_secs"), secs)
+        self.poke16(self.sym("tsl_mins"), mins)
+        self.poke16(self.sym("tsl_hours"), hours)
+        self.poke16(self.sym("tsl_days_ones_tens"), days % 100)
+        self.poke16(self.sym("tsl_days_hundreds_bcd"), int("%04d" % (days // 100), 16))
+        text = lcd_model.tsl_text(days, hours, mins, secs)
+        mem = self.lcdmem()
+        for pos, ch in enumerate(reversed(text)):
+            lcd_model.show_digit(mem, pos, int(ch))
+        self.cpu.mem[LCDMEM:LCDMEM + lcd_model.LCDMEM_BYTES] = mem
+
+        if self.image.value("TSL_LCD_BLINK"):
+            self.poke16(LCDBLKCTL, self.image.value("TSL_LCD_BLINK_CTL"))     # lcd_tsl_blink_mode()
+        self.poke16(RAM_VECTORS["ram_vector_PORT1"], self.sym("TSL_MODE_BEGIN"))
+        self.cpu.mem[SYSCTL] |= SYSRIVECT
+        self._sleep_in_main()
+
+    def start_rtl(self):
+        """What main() does to get into ready-to-launch mode."""
+        self.poke16(RAM_VECTORS["ram_vector_PORT1"], self.sym("RTL_MODE_BEGIN"))
+        self.cpu.mem[SYSCTL] |= SYSRIVECT
+        self._sleep_in_main()
+
+    def tick(self):
+        """One CLKOUT edge. Returns the cycles from interrupt accepted to back asleep."""
+        cpu = self.cpu
+        cpu.mem[P1IFG] |= 1 << RV3032_CLKOUT_B
+        start = cpu.cycles
+        entries = 0
+        while cpu.mem[P1IFG] & cpu.mem[P1IE] and cpu.r[SR] & FLAG_GIE:
+            entries += 1
+            if entries > 1:
+                raise AssertionError("ISR returned without clearing its interrupt flag")
+            cpu.interrupt(PORT1_VECTOR)
+            cpu.run()
+        self.stack_low = min(self.stack_low, cpu.r[SP])
+        if STACK_TOP - self.stack_low > STACK_SIZE:
+            raise AssertionError("stack overflow, %d bytes deep" % (STACK_TOP - self.stack_low))
+        if cpu.mem[CSCTL4]:
+            raise AssertionError("ISR left MCLK on the VLO")
+        if cpu.violations:
+            raise AssertionError("write to protected FRAM: %s" % ["pc=%04x addr=%04x" % v[:2] for v in cpu.violations])
+        return cpu.cycles - start